@@ -0,0 +1,121 @@
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace memplumber;
+
+// 大页对随机访问吞吐的影响
+//
+// 在 FreeListAllocator 上分配约 256 MiB 的 1-8 KiB 对象并写满，然后在所有
+// 对象上做随机读取。工作集远超 4 KiB 页的 TLB 覆盖范围，2 MiB 页能显著
+// 减少 TLB 缺失。分别使用三种 MemorySource 大页策略运行。
+
+namespace {
+
+constexpr size_t kHeapBytes = 256 * 1024 * 1024;
+constexpr size_t kRegionBytes = 64 * 1024 * 1024;
+constexpr size_t kAccesses = 20 * 1000 * 1000;
+
+struct Result {
+    const char* policy;
+    size_t reserved;
+    size_t huge_bytes;
+    double ns_per_access;
+    uint64_t checksum;
+};
+
+const char* policy_name(MemorySource::HugePagePolicy policy) {
+    switch (policy) {
+        case MemorySource::HugePagePolicy::None:        return "4k_pages";
+        case MemorySource::HugePagePolicy::Transparent: return "transparent_huge";
+        case MemorySource::HugePagePolicy::Explicit:    return "hugetlb_or_thp";
+    }
+    return "unknown";
+}
+
+Result run(MemorySource::HugePagePolicy policy) {
+    MemorySource memory_source(policy);
+    FreeListAllocator allocator(memory_source, kRegionBytes);
+    std::mt19937_64 rng(7);
+
+    struct Object {
+        uint64_t* words;
+        size_t count;
+    };
+    std::vector<Object> objects;
+    std::uniform_int_distribution<size_t> size_dist(1024, 8192);
+    size_t total = 0;
+    while (total < kHeapBytes) {
+        size_t size = size_dist(rng) & ~size_t(7);
+        uint64_t* words = static_cast<uint64_t*>(allocator.allocate(size));
+        for (size_t i = 0; i < size / 8; ++i) {
+            words[i] = i ^ total;
+        }
+        objects.push_back({words, size / 8});
+        total += size;
+    }
+
+    // 预先生成随机下标，计时部分只有访存
+    std::vector<uint32_t> object_index(kAccesses);
+    std::vector<uint16_t> word_index(kAccesses);
+    std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(objects.size() - 1));
+    for (size_t i = 0; i < kAccesses; ++i) {
+        object_index[i] = pick(rng);
+        word_index[i] = static_cast<uint16_t>(rng() % objects[object_index[i]].count);
+    }
+
+    uint64_t checksum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kAccesses; ++i) {
+        const Object& object = objects[object_index[i]];
+        checksum += object.words[word_index[i]];
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    Result result;
+    result.policy = policy_name(policy);
+    result.reserved = allocator.memory_usage().reserved;
+    result.huge_bytes = allocator.huge_page_bytes();
+    result.ns_per_access = std::chrono::duration<double, std::nano>(end - start).count() / kAccesses;
+    result.checksum = checksum;
+
+    for (const Object& object : objects) {
+        allocator.deallocate(object.words);
+    }
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const MemorySource::HugePagePolicy policies[] = {
+        MemorySource::HugePagePolicy::None,
+        MemorySource::HugePagePolicy::Transparent,
+        MemorySource::HugePagePolicy::Explicit,
+    };
+    std::vector<Result> results;
+    for (MemorySource::HugePagePolicy policy : policies) {
+        results.push_back(run(policy));
+    }
+
+    std::printf("=== Huge page random-access benchmark (%zu MiB heap, THP %s) ===\n",
+                kHeapBytes >> 20,
+                MemorySource::transparent_huge_pages_available() ? "available" : "unavailable");
+    std::printf("%18s %14s %14s %10s %14s\n", "policy", "reserved_MiB", "huge_MiB", "huge_%", "ns/access");
+    for (const Result& r : results) {
+        std::printf("%18s %14zu %14zu %9.1f%% %14.2f\n", r.policy, r.reserved >> 20, r.huge_bytes >> 20,
+                    r.reserved != 0 ? 100.0 * r.huge_bytes / r.reserved : 0.0, r.ns_per_access);
+    }
+    // 防止访存被优化掉
+    uint64_t checksum = 0;
+    for (const Result& r : results) {
+        checksum ^= r.checksum;
+    }
+    std::printf("checksum %llx\n", static_cast<unsigned long long>(checksum));
+    return 0;
+}
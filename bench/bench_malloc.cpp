@@ -0,0 +1,171 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <random>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+// C 分配接口：glibc 与 libaxontzz.so 的对比
+//
+// 本程序不链接项目的任何目标文件，只调用 malloc 系列；
+// make bench-malloc 先直接运行，再以 LD_PRELOAD=bin/libaxontzz.so 运行一次。
+// 负载：
+// - fixed_churn：64 字节对象成批分配、释放
+// - random_sizes：16-4096 字节，在 1024 个槽位上随机替换
+// - realloc_growth：缓冲区逐步 realloc 增长到 64KB
+// - calloc_small：calloc 16-512 字节后立即释放
+// - threads_4：4 个线程各自随机替换 16-512 字节对象
+
+namespace {
+
+constexpr size_t kOps = 2000000;
+
+// 防止编译器消除成对的 malloc/free
+volatile unsigned char g_sink;
+
+void touch(void* ptr) {
+    static_cast<volatile unsigned char*>(ptr)[0] = 1;
+}
+
+double fixed_churn() {
+    constexpr size_t kBatch = 256;
+    void* batch[kBatch];
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < kOps / kBatch; ++round) {
+        for (size_t i = 0; i < kBatch; ++i) {
+            batch[i] = std::malloc(64);
+            touch(batch[i]);
+        }
+        for (size_t i = 0; i < kBatch; ++i) {
+            std::free(batch[i]);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(kOps / kBatch * kBatch) / std::chrono::duration<double>(end - start).count();
+}
+
+double random_sizes() {
+    constexpr size_t kSlots = 1024;
+    std::vector<void*> slots(kSlots, nullptr);
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<size_t> size_dist(16, 4096);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kOps; ++i) {
+        size_t index = rng() % kSlots;
+        std::free(slots[index]);
+        slots[index] = std::malloc(size_dist(rng));
+        touch(slots[index]);
+    }
+    auto end = std::chrono::steady_clock::now();
+    for (void* ptr : slots) {
+        std::free(ptr);
+    }
+    return static_cast<double>(kOps) / std::chrono::duration<double>(end - start).count();
+}
+
+double realloc_growth() {
+    constexpr size_t kRounds = 20000;
+    size_t ops = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t round = 0; round < kRounds; ++round) {
+        void* buffer = nullptr;
+        for (size_t size = 16; size <= 64 * 1024; size += size / 2) {
+            buffer = std::realloc(buffer, size);
+            static_cast<volatile unsigned char*>(buffer)[size - 1] = 1;
+            ++ops;
+        }
+        g_sink = static_cast<unsigned char*>(buffer)[0];
+        std::free(buffer);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(ops) / std::chrono::duration<double>(end - start).count();
+}
+
+double calloc_small() {
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<size_t> size_dist(16, 512);
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kOps; ++i) {
+        void* ptr = std::calloc(1, size_dist(rng));
+        g_sink = static_cast<unsigned char*>(ptr)[0];
+        std::free(ptr);
+    }
+    auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(kOps) / std::chrono::duration<double>(end - start).count();
+}
+
+double threads_4() {
+    constexpr size_t kThreads = 4;
+    constexpr size_t kSlots = 64;
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t, &go]() {
+            std::mt19937 rng(static_cast<unsigned>(t + 10));
+            std::uniform_int_distribution<size_t> size_dist(16, 512);
+            void* slots[kSlots] = {};
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < kOps / kThreads; ++i) {
+                size_t index = rng() % kSlots;
+                std::free(slots[index]);
+                slots[index] = std::malloc(size_dist(rng));
+                touch(slots[index]);
+            }
+            for (void* ptr : slots) {
+                std::free(ptr);
+            }
+        });
+    }
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return static_cast<double>(kOps / kThreads * kThreads) / std::chrono::duration<double>(end - start).count();
+}
+
+// malloc 符号所在的库决定了被测分配器
+const char* allocator_name() {
+    Dl_info info;
+    void* symbol = dlsym(RTLD_DEFAULT, "malloc");
+    if (symbol != nullptr && dladdr(symbol, &info) != 0 && info.dli_fname != nullptr &&
+        std::strstr(info.dli_fname, "libaxontzz") != nullptr) {
+        return "libaxontzz";
+    }
+    return "glibc";
+}
+
+} // namespace
+
+int main() {
+    struct Workload {
+        const char* name;
+        double (*run)();
+    };
+    const Workload workloads[] = {
+        {"fixed_churn", fixed_churn},
+        {"random_sizes", random_sizes},
+        {"realloc_growth", realloc_growth},
+        {"calloc_small", calloc_small},
+        {"threads_4", threads_4},
+    };
+
+    const char* name = allocator_name();
+    std::printf("=== malloc benchmark: %s ===\n", name);
+    std::printf("%16s %14s\n", "workload", "Mops/s");
+    for (const Workload& workload : workloads) {
+        std::printf("%16s %14.2f\n", workload.name, workload.run() / 1e6);
+    }
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    std::printf("%16s %11ld KB\n", "peak_rss", usage.ru_maxrss);
+    return 0;
+}
@@ -0,0 +1,181 @@
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include "axontzz/numa.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace memplumber;
+
+// NUMA 放置：按节点选分配区与不分节点的对比
+//
+// 模拟 N 个逻辑节点（默认 2，可由第一个参数指定），每个节点一个分配区：独立的 MemorySource
+// （绑定到真实节点 node % online_nodes）加上一把锁保护的 FreeListAllocator。
+// 2N 个工作线程，线程 t 属于逻辑节点 t % N，反复分配 64-4096 字节的对象、写满、读回后释放，
+// 每个线程保持 kWindow 个存活对象。
+// - interleaved：每次分配轮流使用各节点的分配区（对象所在节点与线程无关，即不感知 NUMA 的现状）
+// - per-node：线程只使用本节点的分配区
+// 报告吞吐量、远程访问比例（读写的字节中对象所在逻辑节点不是线程所在节点的比例；
+// 单节点机器上逻辑节点是模拟的，多节点机器上它对应跨 socket 的访问），
+// 以及 move_pages 查得的各分配区驻留页落在绑定节点上的比例。
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kOpsPerThread = 200000;
+constexpr size_t kWindow = 256;
+
+struct Arena {
+    Arena(int logical_node, int bind_node)
+        : node(logical_node)
+        , source(MemorySource::HugePagePolicy::None, 1024 * 1024 * 1024, bind_node)
+        , allocator(source, 256 * 1024) {}
+
+    int node;
+    std::mutex mutex;
+    MemorySource source;
+    FreeListAllocator allocator;
+};
+
+struct Object {
+    char* ptr;
+    size_t size;
+    int node;
+};
+
+enum class Mode { Interleaved, PerNode };
+
+struct Result {
+    double ops_per_sec;
+    double remote;
+    size_t resident_pages;
+    size_t placed_pages;
+    size_t bind_failures;
+};
+
+Result run(Mode mode, int nodes) {
+    const int real_nodes = numa::online_nodes();
+    std::vector<std::unique_ptr<Arena>> arenas;
+    for (int node = 0; node < nodes; ++node) {
+        arenas.emplace_back(new Arena(node, node % real_nodes));
+    }
+
+    const size_t threads = 2 * static_cast<size_t>(nodes);
+    std::atomic<size_t> remote_bytes{0};
+    std::atomic<size_t> total_bytes{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const int home = static_cast<int>(t % static_cast<size_t>(nodes));
+            std::mt19937 rng(static_cast<unsigned>(t) + 1);
+            std::vector<Object> live(kWindow, Object{nullptr, 0, 0});
+            size_t remote = 0;
+            size_t total = 0;
+            size_t turn = t;
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+
+            for (size_t i = 0; i < kOpsPerThread; ++i) {
+                Object& slot = live[rng() % kWindow];
+                if (slot.ptr != nullptr) {
+                    // 读回并释放
+                    size_t sum = 0;
+                    for (size_t b = 0; b < slot.size; b += 64) {
+                        sum += static_cast<unsigned char>(slot.ptr[b]);
+                    }
+                    if (sum == 0) {
+                        std::fprintf(stderr, "lost contents\n");
+                    }
+                    total += slot.size;
+                    remote += slot.node != home ? slot.size : 0;
+                    Arena& owner = *arenas[static_cast<size_t>(slot.node)];
+                    std::lock_guard<std::mutex> lock(owner.mutex);
+                    owner.allocator.deallocate(slot.ptr, slot.size);
+                }
+
+                const size_t index = mode == Mode::PerNode ? static_cast<size_t>(home) : turn++ % arenas.size();
+                Arena& arena = *arenas[index];
+                slot.size = 64 + rng() % 4033;
+                slot.node = arena.node;
+                {
+                    std::lock_guard<std::mutex> lock(arena.mutex);
+                    slot.ptr = static_cast<char*>(arena.allocator.allocate(slot.size));
+                }
+                std::memset(slot.ptr, static_cast<int>(t + 1), slot.size);
+                total += slot.size;
+                remote += slot.node != home ? slot.size : 0;
+            }
+
+            for (Object& slot : live) {
+                if (slot.ptr != nullptr) {
+                    Arena& owner = *arenas[static_cast<size_t>(slot.node)];
+                    std::lock_guard<std::mutex> lock(owner.mutex);
+                    owner.allocator.deallocate(slot.ptr, slot.size);
+                }
+            }
+            remote_bytes.fetch_add(remote);
+            total_bytes.fetch_add(total);
+        });
+    }
+
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    const auto end = Clock::now();
+
+    Result result{};
+    result.ops_per_sec = static_cast<double>(threads * kOpsPerThread) /
+                         std::chrono::duration<double>(end - start).count();
+    result.remote = static_cast<double>(remote_bytes.load()) / static_cast<double>(total_bytes.load());
+
+    // 各分配区已提交的预留区：驻留页是否在绑定的真实节点上
+    for (const std::unique_ptr<Arena>& arena : arenas) {
+        size_t resident = 0;
+        result.placed_pages += numa::pages_on_node(arena->source.arena_base(), arena->source.arena_frontier(),
+                                                   arena->source.numa_node(), &resident);
+        result.resident_pages += resident;
+        result.bind_failures += arena->source.get_stats().numa_bind_failures;
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const int nodes = argc > 1 ? std::atoi(argv[1]) : 2;
+    if (nodes < 1 || nodes > numa::MAX_NODES) {
+        std::fprintf(stderr, "usage: %s [logical nodes 1-%d]\n", argv[0], numa::MAX_NODES);
+        return 1;
+    }
+    const int real_nodes = numa::online_nodes();
+
+    std::printf("=== NUMA arena placement benchmark (%d logical nodes, %d online, %s) ===\n",
+                nodes, real_nodes, nodes > real_nodes ? "simulated" : "real");
+    std::printf("%12s %8s %10s %10s %12s\n", "arenas", "threads", "Mops/s", "remote", "placed");
+    const Mode modes[] = {Mode::Interleaved, Mode::PerNode};
+    for (Mode mode : modes) {
+        const Result r = run(mode, nodes);
+        char placed[32];
+        if (r.resident_pages == 0 || r.bind_failures != 0) {
+            std::snprintf(placed, sizeof(placed), "n/a");
+        } else {
+            std::snprintf(placed, sizeof(placed), "%.1f%%",
+                          100.0 * static_cast<double>(r.placed_pages) / static_cast<double>(r.resident_pages));
+        }
+        std::printf("%12s %8d %10.2f %9.1f%% %12s\n", mode == Mode::PerNode ? "per-node" : "interleaved",
+                    2 * nodes, r.ops_per_sec / 1e6, r.remote * 100.0, placed);
+    }
+    return 0;
+}
@@ -0,0 +1,69 @@
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace memplumber;
+
+// 每对象元数据开销
+//
+// 在新建的分配器上连续分配 kObjects 个对象（固定大小，或 16-256 字节随机大小），
+// 报告存活对象平均占用的块字节（标记、对齐前缀、尾部余量与负载之和）、
+// 其中超出请求大小的部分，以及内部碎片率。
+
+namespace {
+
+constexpr size_t kObjects = 20000;
+
+struct Row {
+    double block_bytes;
+    double overhead;
+    double internal;
+};
+
+Row run(size_t size, size_t alignment) {
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 4 * 1024 * 1024);
+    std::mt19937 rng(7);
+
+    std::vector<void*> objects;
+    objects.reserve(kObjects);
+    for (size_t i = 0; i < kObjects; ++i) {
+        objects.push_back(allocator.allocate(size != 0 ? size : 16 + rng() % 241, alignment));
+    }
+
+    const FreeListAllocator::Fragmentation frag = allocator.fragmentation();
+    Row row{};
+    row.block_bytes = static_cast<double>(frag.allocated) / kObjects;
+    row.overhead = static_cast<double>(frag.allocated - frag.requested) / kObjects;
+    row.internal = frag.internal;
+
+    for (void* object : objects) {
+        allocator.deallocate(object);
+    }
+    return row;
+}
+
+} // namespace
+
+int main() {
+    const size_t sizes[] = {8, 16, 24, 32, 48, 64, 128, 256, 0};
+    const size_t alignments[] = {8, 16};
+
+    std::printf("=== FreeListAllocator per-object overhead (%zu live objects) ===\n", kObjects);
+    std::printf("%8s %6s %12s %12s %10s\n", "size", "align", "block/obj", "overhead", "internal");
+    for (size_t alignment : alignments) {
+        for (size_t size : sizes) {
+            const Row r = run(size, alignment);
+            if (size != 0) {
+                std::printf("%8zu %6zu %12.1f %12.1f %9.1f%%\n",
+                            size, alignment, r.block_bytes, r.overhead, r.internal * 100.0);
+            } else {
+                std::printf("%8s %6zu %12.1f %12.1f %9.1f%%\n",
+                            "16-256", alignment, r.block_bytes, r.overhead, r.internal * 100.0);
+            }
+        }
+    }
+    return 0;
+}
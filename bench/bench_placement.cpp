@@ -0,0 +1,122 @@
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace memplumber;
+
+// 放置策略对比：碎片与分配延迟
+//
+// 混合大小的随机替换负载（70% 16-256 字节，25% 256-4096，5% 4-32KB），
+// 稳定在约 20000 个存活对象。每种策略在独立的分配器上运行同一请求序列，报告：
+// - p50/p99：每 8 次分配采样一次的单次分配耗时
+// - reserved/live：峰值时向 OS 预留的字节与存活请求字节之比
+// - external：结束时最大自由块之外的自由字节占比
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using Policy = FreeListAllocator::PlacementPolicy;
+
+constexpr size_t kOps = 600000;
+constexpr size_t kSlots = 20000;
+
+struct Result {
+    double ns_p50;
+    double ns_p99;
+    double ops_per_sec;
+    double reserved_per_live;
+    double external;
+    size_t free_blocks;
+};
+
+size_t request_size(std::mt19937& rng) {
+    const unsigned bucket = rng() % 100;
+    if (bucket < 70) {
+        return 16 + rng() % 241;
+    }
+    if (bucket < 95) {
+        return 256 + rng() % 3841;
+    }
+    return 4096 + rng() % 28673;
+}
+
+double percentile(std::vector<double>& samples, double p) {
+    const size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+}
+
+Result run(Policy policy) {
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 1024 * 1024);
+    allocator.set_placement_policy(policy);
+    std::mt19937 rng(2024);
+
+    std::vector<void*> slots(kSlots, nullptr);
+    std::vector<size_t> sizes(kSlots, 0);
+    std::vector<double> samples;
+    samples.reserve(kOps / 8 + 1);
+    size_t live = 0;
+    size_t peak_reserved = 0;
+    size_t live_at_peak = 1;
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < kOps; ++i) {
+        const size_t index = rng() % kSlots;
+        if (slots[index] != nullptr) {
+            allocator.deallocate(slots[index], sizes[index]);
+            live -= sizes[index];
+        }
+        sizes[index] = request_size(rng);
+        if ((i & 7) == 0) {
+            auto before = Clock::now();
+            slots[index] = allocator.allocate(sizes[index]);
+            samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - before).count());
+        } else {
+            slots[index] = allocator.allocate(sizes[index]);
+        }
+        live += sizes[index];
+        if ((i & 1023) == 0) {
+            const size_t reserved = allocator.memory_usage().reserved;
+            if (reserved > peak_reserved) {
+                peak_reserved = reserved;
+                live_at_peak = live;
+            }
+        }
+    }
+    auto end = Clock::now();
+
+    Result result{};
+    result.ns_p50 = percentile(samples, 0.50);
+    result.ns_p99 = percentile(samples, 0.99);
+    result.ops_per_sec = static_cast<double>(kOps) / std::chrono::duration<double>(end - start).count();
+    result.reserved_per_live = static_cast<double>(peak_reserved) / static_cast<double>(live_at_peak);
+    result.external = allocator.fragmentation().external;
+    result.free_blocks = allocator.free_block_count();
+
+    for (size_t i = 0; i < kSlots; ++i) {
+        allocator.deallocate(slots[i], sizes[i]);
+    }
+    return result;
+}
+
+} // namespace
+
+int main() {
+    const Policy policies[] = {Policy::GoodFit, Policy::FirstFit, Policy::NextFit, Policy::BestFit};
+
+    std::printf("=== FreeListAllocator placement policy benchmark ===\n");
+    std::printf("%10s %10s %10s %12s %14s %10s %12s\n",
+                "policy", "p50_ns", "p99_ns", "Mops/s", "reserved/live", "external", "free_blocks");
+    for (Policy policy : policies) {
+        const Result r = run(policy);
+        std::printf("%10s %10.0f %10.0f %12.2f %14.3f %9.1f%% %12zu\n",
+                    FreeListAllocator::placement_policy_name(policy), r.ns_p50, r.ns_p99,
+                    r.ops_per_sec / 1e6, r.reserved_per_live, r.external * 100.0, r.free_blocks);
+    }
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include "axontzz/slab_allocator.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace memplumber;
+
+// 生产者/消费者跨线程释放
+//
+// 每对线程中，生产者分配 64 字节的消息，经无锁单生产者单消费者环形队列交给
+// 消费者，消费者读取后释放。比较三种堆：
+// - shared-lock：所有线程共用一个 ThreadSafeAllocator<FreeListAllocator>
+// - pair-lock：每对线程一个 ThreadSafeAllocator<FreeListAllocator>，生产者与消费者争同一把锁
+// - remote-free：生产者拥有一个 SlabAllocator，消费者的释放进入它的远程释放队列
+// 报告总消息吞吐量，以及相对单对线程的倍数（理想情况下等于线程对数，受 CPU 数限制）。
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kMessageSize = 64;
+constexpr size_t kMessagesPerPair = 400000;
+constexpr size_t kRingSize = 1024;
+
+struct Message {
+    size_t sequence;
+    char payload[kMessageSize - sizeof(size_t)];
+};
+
+// 单生产者单消费者环形队列
+class Channel {
+public:
+    void send(void* message) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        while (tail - head_.load(std::memory_order_acquire) == kRingSize) {
+            std::this_thread::yield();
+        }
+        slots_[tail % kRingSize] = message;
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    void* receive() {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        while (tail_.load(std::memory_order_acquire) == head) {
+            std::this_thread::yield();
+        }
+        void* message = slots_[head % kRingSize];
+        head_.store(head + 1, std::memory_order_release);
+        return message;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    void* slots_[kRingSize];
+};
+
+enum class Mode { SharedLock, PairLock, RemoteFree };
+
+const char* mode_name(Mode mode) {
+    switch (mode) {
+    case Mode::SharedLock: return "shared-lock";
+    case Mode::PairLock: return "pair-lock";
+    case Mode::RemoteFree: return "remote-free";
+    }
+    return "?";
+}
+
+void consume(Channel& channel, AllocatorInterface& heap, std::atomic<size_t>& checksum) {
+    size_t sum = 0;
+    for (size_t i = 0; i < kMessagesPerPair; ++i) {
+        Message* message = static_cast<Message*>(channel.receive());
+        sum += message->sequence;
+        heap.deallocate(message, sizeof(Message));
+    }
+    checksum.fetch_add(sum, std::memory_order_relaxed);
+}
+
+void produce(Channel& channel, AllocatorInterface& heap) {
+    for (size_t i = 0; i < kMessagesPerPair; ++i) {
+        Message* message = static_cast<Message*>(heap.allocate(sizeof(Message)));
+        message->sequence = i;
+        std::memset(message->payload, static_cast<int>(i), sizeof(message->payload));
+        channel.send(message);
+    }
+}
+
+double run(Mode mode, size_t pairs) {
+    MemorySource memory_source;
+    ThreadSafeAllocator<FreeListAllocator> shared(memory_source, 1024 * 1024);
+    std::vector<std::unique_ptr<ThreadSafeAllocator<FreeListAllocator>>> locked;
+    std::vector<std::unique_ptr<Channel>> channels;
+    for (size_t p = 0; p < pairs; ++p) {
+        channels.emplace_back(new Channel());
+        if (mode == Mode::PairLock) {
+            locked.emplace_back(new ThreadSafeAllocator<FreeListAllocator>(memory_source, 1024 * 1024));
+        }
+    }
+
+    // remote-free 的堆由生产者线程创建，因此归它所有；消费者拿到指针后才开始
+    std::vector<std::atomic<SlabAllocator*>> owned(pairs);
+    std::atomic<size_t> checksum{0};
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+
+    for (size_t p = 0; p < pairs; ++p) {
+        threads.emplace_back([&, p] {
+            std::unique_ptr<SlabAllocator> slab;
+            AllocatorInterface* heap = &shared;
+            if (mode == Mode::PairLock) {
+                heap = locked[p].get();
+            } else if (mode == Mode::RemoteFree) {
+                slab.reset(new SlabAllocator(memory_source, sizeof(Message)));
+                heap = slab.get();
+            }
+            owned[p].store(slab.get(), std::memory_order_release);
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            produce(*channels[p], *heap);
+            // 等消费者释放完所有消息再销毁堆
+            while (ready.load() != 0) {
+                std::this_thread::yield();
+            }
+        });
+        threads.emplace_back([&, p] {
+            while (mode == Mode::RemoteFree && owned[p].load(std::memory_order_acquire) == nullptr) {
+                std::this_thread::yield();
+            }
+            AllocatorInterface* heap = &shared;
+            if (mode == Mode::PairLock) {
+                heap = locked[p].get();
+            } else if (mode == Mode::RemoteFree) {
+                heap = owned[p].load(std::memory_order_acquire);
+            }
+            ready.fetch_add(1);
+            while (!go.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            consume(*channels[p], *heap, checksum);
+        });
+    }
+
+    while (ready.load() != 2 * pairs) {
+        std::this_thread::yield();
+    }
+    const auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (size_t i = 1; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+    const auto end = Clock::now();
+    ready.store(0);
+    for (size_t i = 0; i < threads.size(); i += 2) {
+        threads[i].join();
+    }
+
+    const size_t expected = pairs * (kMessagesPerPair * (kMessagesPerPair - 1) / 2);
+    if (checksum.load() != expected) {
+        std::fprintf(stderr, "checksum mismatch in %s\n", mode_name(mode));
+    }
+    return static_cast<double>(pairs * kMessagesPerPair) / std::chrono::duration<double>(end - start).count();
+}
+
+} // namespace
+
+int main() {
+    const Mode modes[] = {Mode::SharedLock, Mode::PairLock, Mode::RemoteFree};
+    const size_t pair_counts[] = {1, 2, 4, 8};
+
+    std::printf("=== Cross-thread free benchmark (%zu-byte messages, %u hardware threads) ===\n",
+                kMessageSize, std::thread::hardware_concurrency());
+    std::printf("%12s %6s %12s %10s\n", "heap", "pairs", "Mmsg/s", "scaling");
+    for (Mode mode : modes) {
+        double base = 0.0;
+        for (size_t pairs : pair_counts) {
+            const double rate = run(mode, pairs);
+            if (pairs == 1) {
+                base = rate;
+            }
+            std::printf("%12s %6zu %12.2f %9.2fx\n", mode_name(mode), pairs, rate / 1e6, rate / base);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace memplumber;
+
+// 分配延迟随自由块数量的变化
+//
+// 先制造 N 个互不相邻的小碎片 (32-128 字节)，再计时分配一批更大的请求
+// (64-512 字节)。单链表首次适配需要逐个跳过这些碎片，分级链表只需查位图。
+
+namespace {
+
+constexpr size_t kTimedAllocations = 4096;
+
+struct Result {
+    size_t free_blocks;
+    double ns_per_alloc;
+};
+
+Result run(size_t fragments) {
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 64 * 1024 * 1024);
+    std::mt19937 rng(42);
+
+    std::vector<void*> blocks(fragments * 2);
+    std::vector<size_t> sizes(fragments * 2);
+    std::uniform_int_distribution<size_t> small(32, 128);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        sizes[i] = small(rng);
+        blocks[i] = allocator.allocate(sizes[i]);
+    }
+    // 释放偶数位置，奇数位置的块把碎片隔开
+    for (size_t i = 0; i < blocks.size(); i += 2) {
+        allocator.deallocate(blocks[i], sizes[i]);
+    }
+    const size_t free_blocks = allocator.free_block_count();
+
+    std::vector<void*> timed(kTimedAllocations);
+    std::vector<size_t> timed_sizes(kTimedAllocations);
+    std::uniform_int_distribution<size_t> large(64, 512);
+    for (size_t i = 0; i < kTimedAllocations; ++i) {
+        timed_sizes[i] = large(rng);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kTimedAllocations; ++i) {
+        timed[i] = allocator.allocate(timed_sizes[i]);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < kTimedAllocations; ++i) {
+        allocator.deallocate(timed[i], timed_sizes[i]);
+    }
+    for (size_t i = 1; i < blocks.size(); i += 2) {
+        allocator.deallocate(blocks[i], sizes[i]);
+    }
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return {free_blocks, ns / kTimedAllocations};
+}
+
+} // namespace
+
+int main() {
+    const size_t fragment_counts[] = {1000, 4000, 16000, 32000};
+    std::vector<Result> results;
+    results.reserve(sizeof(fragment_counts) / sizeof(fragment_counts[0]));
+
+    for (size_t fragments : fragment_counts) {
+        results.push_back(run(fragments));
+    }
+
+    std::printf("=== FreeListAllocator size-class benchmark ===\n");
+    std::printf("%12s %16s\n", "free_blocks", "ns/allocation");
+    for (const Result& r : results) {
+        std::printf("%12zu %16.1f\n", r.free_blocks, r.ns_per_alloc);
+    }
+    return 0;
+}
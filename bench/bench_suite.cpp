@@ -0,0 +1,475 @@
+#include "axontzz/allocator_interface.h"
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include "axontzz/slab_allocator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <new>
+#include <random>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace memplumber;
+
+// 标准负载下的分配器对比
+//
+// 负载：
+// - fixed_churn:        64 字节对象，保持 1024 个存活对象的滑动窗口
+// - random_sizes:       4096 个槽位上随机替换 16-8192 字节的对象
+// - producer_consumer:  2 对线程，生产者分配、消费者释放（跨线程释放）
+// - larson:             4 个线程随机替换，每轮把存活对象交给下一个线程释放
+// - stl_buildup:        std::map / std::vector 逐步构建后整体销毁
+//
+// 分配器：FreeListAllocator（仅单线程负载）、ThreadSafeAllocator<FreeListAllocator>、
+// 全局 operator new/delete、glibc malloc，以及 fixed_churn 上的 SlabAllocator。
+//
+// 每个组合在 fork 出的子进程中运行，峰值 RSS 互不影响。每行输出一个 JSON 对象：
+// ops_per_sec 为含采样开销的吞吐；p50/p99 为每 8 次操作采样一次的单次分配或
+// 释放延迟；peak_rss_kb 来自子进程的 ru_maxrss。
+// 用法：bench_suite [负载名或分配器名的子串 ...]
+
+namespace {
+
+constexpr size_t kSampleMask = 7;
+
+using Clock = std::chrono::steady_clock;
+
+// ---- 分配器适配 ----
+
+struct FreeList {
+    static constexpr const char* kName = "free_list";
+    static constexpr bool kThreadSafe = false;
+    MemorySource source;
+    FreeListAllocator allocator{source, 1024 * 1024};
+    void* allocate(size_t size) { return allocator.allocate(size); }
+    void deallocate(void* ptr, size_t size) { allocator.deallocate(ptr, size); }
+};
+
+struct LockedFreeList {
+    static constexpr const char* kName = "thread_safe_free_list";
+    static constexpr bool kThreadSafe = true;
+    MemorySource source;
+    ThreadSafeAllocator<FreeListAllocator> allocator{source, 1024 * 1024};
+    void* allocate(size_t size) { return allocator.allocate(size); }
+    void deallocate(void* ptr, size_t size) { allocator.deallocate(ptr, size); }
+};
+
+struct GlobalNew {
+    static constexpr const char* kName = "global_new_delete";
+    static constexpr bool kThreadSafe = true;
+    void* allocate(size_t size) { return ::operator new(size); }
+    void deallocate(void* ptr, size_t size) { ::operator delete(ptr, size); }
+};
+
+struct SystemMalloc {
+    static constexpr const char* kName = "glibc_malloc";
+    static constexpr bool kThreadSafe = true;
+    void* allocate(size_t size) { return std::malloc(size); }
+    void deallocate(void* ptr, size_t) { std::free(ptr); }
+};
+
+struct Slab64 {
+    static constexpr const char* kName = "slab";
+    static constexpr bool kThreadSafe = false;
+    MemorySource source;
+    SlabAllocator allocator{source, 64};
+    void* allocate(size_t size) { return allocator.allocate(size); }
+    void deallocate(void* ptr, size_t size) { allocator.deallocate(ptr, size); }
+};
+
+// STL 容器使用的分配器适配
+template <typename T, typename Allocator>
+struct StlAdapter {
+    using value_type = T;
+    Allocator* allocator;
+
+    explicit StlAdapter(Allocator* a) : allocator(a) {}
+    template <typename U>
+    StlAdapter(const StlAdapter<U, Allocator>& other) : allocator(other.allocator) {}
+
+    T* allocate(size_t n) {
+        void* ptr = allocator->allocate(n * sizeof(T));
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(ptr);
+    }
+    void deallocate(T* ptr, size_t n) { allocator->deallocate(ptr, n * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const StlAdapter<U, Allocator>& other) const { return allocator == other.allocator; }
+    template <typename U>
+    bool operator!=(const StlAdapter<U, Allocator>& other) const { return allocator != other.allocator; }
+};
+
+// ---- 测量 ----
+
+struct Sampler {
+    std::vector<uint32_t> samples;
+    size_t ops = 0;
+
+    Sampler() { samples.reserve(1 << 20); }
+
+    template <typename F>
+    void op(F&& f) {
+        if ((ops++ & kSampleMask) == 0) {
+            auto start = Clock::now();
+            f();
+            auto end = Clock::now();
+            samples.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        } else {
+            f();
+        }
+    }
+};
+
+struct Result {
+    char workload[32];
+    char allocator[32];
+    uint32_t threads;
+    uint64_t ops;
+    double seconds;
+    uint32_t p50_ns;
+    uint32_t p99_ns;
+};
+
+uint32_t percentile(std::vector<uint32_t>& samples, double p) {
+    if (samples.empty()) {
+        return 0;
+    }
+    size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>(index), samples.end());
+    return samples[index];
+}
+
+Result finish(const char* workload, const char* allocator, uint32_t threads,
+              std::vector<Sampler>& samplers, Clock::time_point start, Clock::time_point end) {
+    Result result{};
+    std::snprintf(result.workload, sizeof(result.workload), "%s", workload);
+    std::snprintf(result.allocator, sizeof(result.allocator), "%s", allocator);
+    result.threads = threads;
+    std::vector<uint32_t> all;
+    for (Sampler& sampler : samplers) {
+        result.ops += sampler.ops;
+        all.insert(all.end(), sampler.samples.begin(), sampler.samples.end());
+    }
+    result.seconds = std::chrono::duration<double>(end - start).count();
+    result.p50_ns = percentile(all, 0.50);
+    result.p99_ns = percentile(all, 0.99);
+    return result;
+}
+
+// 简单的自旋屏障（C++17 没有 std::barrier）
+class SpinBarrier {
+public:
+    explicit SpinBarrier(size_t count) : count_(count), waiting_(0), generation_(0) {}
+    void wait() {
+        size_t generation = generation_.load(std::memory_order_acquire);
+        if (waiting_.fetch_add(1, std::memory_order_acq_rel) + 1 == count_) {
+            waiting_.store(0, std::memory_order_relaxed);
+            generation_.fetch_add(1, std::memory_order_release);
+        } else {
+            while (generation_.load(std::memory_order_acquire) == generation) {
+                std::this_thread::yield();
+            }
+        }
+    }
+private:
+    const size_t count_;
+    std::atomic<size_t> waiting_;
+    std::atomic<size_t> generation_;
+};
+
+// ---- 负载 ----
+
+template <typename A>
+Result fixed_churn(A& allocator) {
+    constexpr size_t kIterations = 1000000;
+    constexpr size_t kWindow = 1024;
+    std::vector<Sampler> samplers(1);
+    Sampler& s = samplers[0];
+    std::vector<void*> window(kWindow, nullptr);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < kIterations; ++i) {
+        void*& slot = window[i % kWindow];
+        if (slot != nullptr) {
+            s.op([&] { allocator.deallocate(slot, 64); });
+        }
+        s.op([&] { slot = allocator.allocate(64); });
+        static_cast<char*>(slot)[0] = 1;
+    }
+    for (void* ptr : window) {
+        s.op([&] { allocator.deallocate(ptr, 64); });
+    }
+    return finish("fixed_churn", A::kName, 1, samplers, start, Clock::now());
+}
+
+template <typename A>
+Result random_sizes(A& allocator) {
+    constexpr size_t kIterations = 1000000;
+    constexpr size_t kSlots = 4096;
+    std::vector<Sampler> samplers(1);
+    Sampler& s = samplers[0];
+    std::vector<void*> slots(kSlots, nullptr);
+    std::vector<size_t> sizes(kSlots, 0);
+    std::mt19937 rng(1);
+
+    auto start = Clock::now();
+    for (size_t i = 0; i < kIterations; ++i) {
+        size_t index = rng() % kSlots;
+        if (slots[index] != nullptr) {
+            s.op([&] { allocator.deallocate(slots[index], sizes[index]); });
+            slots[index] = nullptr;
+        } else {
+            // 大小按对数均匀分布在 16-8192 之间
+            size_t size = (size_t(16) << (rng() % 9)) + rng() % 16;
+            s.op([&] { slots[index] = allocator.allocate(size); });
+            sizes[index] = size;
+            static_cast<char*>(slots[index])[0] = 1;
+        }
+    }
+    for (size_t i = 0; i < kSlots; ++i) {
+        if (slots[i] != nullptr) {
+            s.op([&] { allocator.deallocate(slots[i], sizes[i]); });
+        }
+    }
+    return finish("random_sizes", A::kName, 1, samplers, start, Clock::now());
+}
+
+template <typename A>
+Result producer_consumer(A& allocator) {
+    constexpr size_t kPairs = 2;
+    constexpr size_t kObjects = 300000;
+    constexpr size_t kRing = 4096;
+
+    struct Channel {
+        std::atomic<size_t> head{0};
+        std::atomic<size_t> tail{0};
+        void* ring[kRing];
+    };
+    std::vector<Channel> channels(kPairs);
+    std::vector<Sampler> samplers(kPairs * 2);
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+
+    for (size_t p = 0; p < kPairs; ++p) {
+        threads.emplace_back([&, p] {
+            Channel& channel = channels[p];
+            Sampler& s = samplers[p * 2];
+            std::mt19937 rng(static_cast<unsigned>(p + 1));
+            while (!go.load(std::memory_order_acquire)) {}
+            for (size_t i = 0; i < kObjects; ++i) {
+                size_t size = 16 + rng() % 497;
+                void* ptr;
+                s.op([&] { ptr = allocator.allocate(size); });
+                *static_cast<size_t*>(ptr) = size;
+                size_t head = channel.head.load(std::memory_order_relaxed);
+                while (head - channel.tail.load(std::memory_order_acquire) == kRing) {
+                    std::this_thread::yield();
+                }
+                channel.ring[head % kRing] = ptr;
+                channel.head.store(head + 1, std::memory_order_release);
+            }
+        });
+        threads.emplace_back([&, p] {
+            Channel& channel = channels[p];
+            Sampler& s = samplers[p * 2 + 1];
+            while (!go.load(std::memory_order_acquire)) {}
+            for (size_t i = 0; i < kObjects; ++i) {
+                size_t tail = channel.tail.load(std::memory_order_relaxed);
+                while (channel.head.load(std::memory_order_acquire) == tail) {
+                    std::this_thread::yield();
+                }
+                void* ptr = channel.ring[tail % kRing];
+                channel.tail.store(tail + 1, std::memory_order_release);
+                size_t size = *static_cast<size_t*>(ptr);
+                s.op([&] { allocator.deallocate(ptr, size); });
+            }
+        });
+    }
+
+    auto start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    return finish("producer_consumer", A::kName, kPairs * 2, samplers, start, Clock::now());
+}
+
+template <typename A>
+Result larson(A& allocator) {
+    constexpr size_t kThreads = 4;
+    constexpr size_t kSlots = 1024;
+    constexpr size_t kRounds = 20;
+    constexpr size_t kOpsPerRound = 10000;
+
+    // 第 r 轮线程 t 使用 arrays[(t + r) % kThreads]：上一轮其他线程分配的对象由本线程释放
+    std::vector<std::vector<void*>> arrays(kThreads, std::vector<void*>(kSlots, nullptr));
+    std::vector<std::vector<size_t>> sizes(kThreads, std::vector<size_t>(kSlots, 0));
+    std::vector<Sampler> samplers(kThreads);
+    SpinBarrier barrier(kThreads + 1);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&, t] {
+            Sampler& s = samplers[t];
+            std::mt19937 rng(static_cast<unsigned>(t + 11));
+            barrier.wait();
+            for (size_t round = 0; round < kRounds; ++round) {
+                std::vector<void*>& slots = arrays[(t + round) % kThreads];
+                std::vector<size_t>& slot_sizes = sizes[(t + round) % kThreads];
+                for (size_t i = 0; i < kOpsPerRound; ++i) {
+                    size_t index = rng() % kSlots;
+                    if (slots[index] != nullptr) {
+                        s.op([&] { allocator.deallocate(slots[index], slot_sizes[index]); });
+                    }
+                    size_t size = 8 + rng() % 505;
+                    s.op([&] { slots[index] = allocator.allocate(size); });
+                    slot_sizes[index] = size;
+                    static_cast<char*>(slots[index])[0] = 1;
+                }
+                barrier.wait();
+            }
+        });
+    }
+
+    barrier.wait();
+    auto start = Clock::now();
+    for (size_t round = 0; round < kRounds; ++round) {
+        barrier.wait();
+    }
+    auto end = Clock::now();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (size_t t = 0; t < kThreads; ++t) {
+        for (size_t i = 0; i < kSlots; ++i) {
+            if (arrays[t][i] != nullptr) {
+                allocator.deallocate(arrays[t][i], sizes[t][i]);
+            }
+        }
+    }
+    return finish("larson", A::kName, kThreads, samplers, start, end);
+}
+
+template <typename A>
+Result stl_buildup(A& allocator) {
+    constexpr int kRepetitions = 5;
+    constexpr int kMapEntries = 100000;
+    constexpr int kVectorEntries = 1000000;
+    std::vector<Sampler> samplers(1);
+    Sampler& s = samplers[0];
+
+    using MapAlloc = StlAdapter<std::pair<const int, int>, A>;
+    using VectorAlloc = StlAdapter<int, A>;
+
+    auto start = Clock::now();
+    for (int rep = 0; rep < kRepetitions; ++rep) {
+        std::map<int, int, std::less<int>, MapAlloc> map{std::less<int>(), MapAlloc(&allocator)};
+        std::vector<int, VectorAlloc> vector{VectorAlloc(&allocator)};
+        for (int i = 0; i < kMapEntries; ++i) {
+            s.op([&] { map.emplace((i * 7919) % kMapEntries, i); });
+        }
+        for (int i = 0; i < kVectorEntries; ++i) {
+            s.op([&] { vector.push_back(i); });
+        }
+    }
+    return finish("stl_buildup", A::kName, 1, samplers, start, Clock::now());
+}
+
+// ---- 驱动 ----
+
+bool selected(int argc, char** argv, const char* workload, const char* allocator) {
+    if (argc <= 1) {
+        return true;
+    }
+    for (int i = 1; i < argc; ++i) {
+        if (std::strstr(workload, argv[i]) != nullptr || std::strstr(allocator, argv[i]) != nullptr) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 在子进程中构造分配器并运行负载，结果通过管道传回
+template <typename A, Result (*Workload)(A&)>
+void run_isolated(int argc, char** argv, const char* workload) {
+    if (!selected(argc, argv, workload, A::kName)) {
+        return;
+    }
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        return;
+    }
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        close(fds[0]);
+        Result result;
+        {
+            A* allocator = new A();
+            result = Workload(*allocator);
+            delete allocator;
+        }
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+    close(fds[1]);
+
+    Result result{};
+    ssize_t got = read(fds[0], &result, sizeof(result));
+    close(fds[0]);
+    int status = 0;
+    struct rusage usage{};
+    wait4(pid, &status, 0, &usage);
+    if (got != static_cast<ssize_t>(sizeof(result)) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        std::printf("{\"workload\":\"%s\",\"allocator\":\"%s\",\"error\":\"child failed\"}\n",
+                    workload, A::kName);
+        return;
+    }
+
+    std::printf("{\"workload\":\"%s\",\"allocator\":\"%s\",\"threads\":%u,\"ops\":%llu,"
+                "\"ops_per_sec\":%.0f,\"p50_ns\":%u,\"p99_ns\":%u,\"peak_rss_kb\":%ld}\n",
+                result.workload, result.allocator, result.threads,
+                static_cast<unsigned long long>(result.ops),
+                static_cast<double>(result.ops) / result.seconds,
+                result.p50_ns, result.p99_ns, usage.ru_maxrss);
+}
+
+template <typename A>
+void run_single_threaded(int argc, char** argv) {
+    run_isolated<A, fixed_churn<A>>(argc, argv, "fixed_churn");
+    run_isolated<A, random_sizes<A>>(argc, argv, "random_sizes");
+    run_isolated<A, stl_buildup<A>>(argc, argv, "stl_buildup");
+}
+
+template <typename A>
+void run_all(int argc, char** argv) {
+    run_single_threaded<A>(argc, argv);
+    run_isolated<A, producer_consumer<A>>(argc, argv, "producer_consumer");
+    run_isolated<A, larson<A>>(argc, argv, "larson");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    run_single_threaded<FreeList>(argc, argv);
+    run_all<LockedFreeList>(argc, argv);
+    run_all<GlobalNew>(argc, argv);
+    run_all<SystemMalloc>(argc, argv);
+    run_isolated<Slab64, fixed_churn<Slab64>>(argc, argv, "fixed_churn");
+    return 0;
+}
@@ -0,0 +1,117 @@
+#include "axontzz/allocator_interface.h"
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace memplumber;
+
+// 多线程小对象分配的可扩展性
+//
+// 每个线程在 64 个槽位上随机地分配/释放 16-512 字节的对象，对比：
+// - 全局 operator new/delete（线程缓存 + 共享堆）
+// - 单把互斥锁保护的 FreeListAllocator（线程缓存之前的全局路径）
+// - glibc malloc/free
+
+namespace {
+
+constexpr size_t kOpsPerThread = 200000;
+constexpr size_t kSlots = 64;
+
+struct GlobalNew {
+    static const char* name() { return "global_new_delete"; }
+    void* allocate(size_t size) { return ::operator new(size); }
+    void deallocate(void* ptr) { ::operator delete(ptr); }
+};
+
+struct SingleMutex {
+    static const char* name() { return "single_mutex_free_list"; }
+    explicit SingleMutex(MemorySource& source) : allocator(source, 1024 * 1024) {}
+    void* allocate(size_t size) { return allocator.allocate(size); }
+    void deallocate(void* ptr) { allocator.deallocate(ptr); }
+    ThreadSafeAllocator<FreeListAllocator> allocator;
+};
+
+struct SystemMalloc {
+    static const char* name() { return "glibc_malloc"; }
+    void* allocate(size_t size) { return std::malloc(size); }
+    void deallocate(void* ptr) { std::free(ptr); }
+};
+
+template <typename Allocator>
+void worker(Allocator& allocator, unsigned seed, const std::atomic<bool>& go) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> size_dist(16, 512);
+    void* slots[kSlots] = {};
+
+    while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    for (size_t i = 0; i < kOpsPerThread; ++i) {
+        size_t index = rng() % kSlots;
+        if (slots[index] != nullptr) {
+            allocator.deallocate(slots[index]);
+            slots[index] = nullptr;
+        } else {
+            slots[index] = allocator.allocate(size_dist(rng));
+            static_cast<char*>(slots[index])[0] = 1;
+        }
+    }
+    for (void* ptr : slots) {
+        if (ptr != nullptr) {
+            allocator.deallocate(ptr);
+        }
+    }
+}
+
+template <typename Allocator>
+double run(Allocator& allocator, size_t num_threads) {
+    std::atomic<bool> go{false};
+    std::vector<std::thread> threads;
+    threads.reserve(num_threads);
+    for (size_t t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&allocator, t, &go]() { worker(allocator, static_cast<unsigned>(t + 1), go); });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    return static_cast<double>(num_threads * kOpsPerThread) / seconds / 1e6;
+}
+
+} // namespace
+
+int main() {
+    const size_t thread_counts[] = {1, 2, 4, 8};
+
+    std::printf("=== Thread cache scalability benchmark (%u hardware threads) ===\n",
+                std::thread::hardware_concurrency());
+    std::printf("%8s %24s %24s %24s\n", "threads",
+                GlobalNew::name(), SingleMutex::name(), SystemMalloc::name());
+
+    for (size_t threads : thread_counts) {
+        GlobalNew global_new;
+        MemorySource memory_source;
+        SingleMutex single_mutex(memory_source);
+        SystemMalloc system_malloc;
+
+        double global_mops = run(global_new, threads);
+        double mutex_mops = run(single_mutex, threads);
+        double malloc_mops = run(system_malloc, threads);
+        std::printf("%8zu %19.2f Mops %19.2f Mops %19.2f Mops\n",
+                    threads, global_mops, mutex_mops, malloc_mops);
+    }
+    return 0;
+}
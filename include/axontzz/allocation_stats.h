@@ -0,0 +1,138 @@
+#pragma once
+
+#include "allocator_interface.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace memplumber {
+
+/**
+ * Size classes used for statistics
+ *
+ * Class 0 counts requests up to 16 bytes, class k requests in
+ * (16 << (k - 1), 16 << k]; the last class also takes everything larger.
+ * These are reporting buckets only and are independent of the bins or
+ * caches of any allocator.
+ */
+constexpr size_t STATS_SIZE_CLASS_COUNT = 24;
+
+inline size_t stats_size_class(size_t size) {
+    if (size <= 16) {
+        return 0;
+    }
+    size_t cls = static_cast<size_t>(64 - __builtin_clzll(static_cast<unsigned long long>(size - 1))) - 4;
+    return cls < STATS_SIZE_CLASS_COUNT ? cls : STATS_SIZE_CLASS_COUNT - 1;
+}
+
+/**
+ * Counters of one statistics size class
+ */
+struct SizeClassStats {
+    size_t max_size = 0;            // Largest request in this class (SIZE_MAX for the last)
+    size_t allocation_count = 0;
+    size_t deallocation_count = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_deallocated = 0;
+};
+
+using SizeClassTable = std::array<SizeClassStats, STATS_SIZE_CLASS_COUNT>;
+
+/**
+ * One cache line aligned set of relaxed atomic counters
+ *
+ * Statistics are split into shards that each have a single writer at a
+ * time and are summed on read, so no reader ever needs the writer's lock:
+ * - FreeListAllocator and SlabAllocator own one shard each; their
+ *   mutating calls are already serialized (by the caller or by
+ *   ThreadSafeAllocator), so updates are plain relaxed load + store
+ * - The global operator new keeps one shard per thread cache
+ *
+ * record_local_*() are those single-writer updates (no locked
+ * instructions); record_*() use atomic read-modify-write for shards
+ * shared by unsynchronized writers. Readers may load at any time and see
+ * values at most a few operations stale.
+ *
+ * Trivially constructible: zero-initialized in static/thread_local
+ * storage, value-initialize (`StatsShard{}`) elsewhere.
+ */
+struct alignas(64) StatsShard {
+    std::atomic<size_t> allocation_count;
+    std::atomic<size_t> deallocation_count;
+    std::atomic<size_t> bytes_allocated;
+    std::atomic<size_t> bytes_deallocated;
+    std::atomic<size_t> failed_allocations;
+    std::atomic<size_t> class_allocations[STATS_SIZE_CLASS_COUNT];
+    std::atomic<size_t> class_deallocations[STATS_SIZE_CLASS_COUNT];
+    std::atomic<size_t> class_bytes_allocated[STATS_SIZE_CLASS_COUNT];
+    std::atomic<size_t> class_bytes_deallocated[STATS_SIZE_CLASS_COUNT];
+
+    void record_allocation(size_t size) {
+        size_t cls = stats_size_class(size);
+        add(allocation_count, 1);
+        add(bytes_allocated, size);
+        add(class_allocations[cls], 1);
+        add(class_bytes_allocated[cls], size);
+    }
+
+    void record_deallocation(size_t size) {
+        size_t cls = stats_size_class(size);
+        add(deallocation_count, 1);
+        add(bytes_deallocated, size);
+        add(class_deallocations[cls], 1);
+        add(class_bytes_deallocated[cls], size);
+    }
+
+    void record_failure() { add(failed_allocations, 1); }
+
+    void record_local_allocation(size_t size) {
+        size_t cls = stats_size_class(size);
+        bump(allocation_count, 1);
+        bump(bytes_allocated, size);
+        bump(class_allocations[cls], 1);
+        bump(class_bytes_allocated[cls], size);
+    }
+
+    void record_local_deallocation(size_t size) {
+        size_t cls = stats_size_class(size);
+        bump(deallocation_count, 1);
+        bump(bytes_deallocated, size);
+        bump(class_deallocations[cls], 1);
+        bump(class_bytes_deallocated[cls], size);
+    }
+
+    void record_local_failure() { bump(failed_allocations, 1); }
+
+    // Atomically add all counters of other (a shard being retired) to this one
+    void merge(const StatsShard& other);
+
+    // Accumulate into a snapshot (current_usage is left to the caller)
+    void add_to(AllocatorInterface::AllocatorStats& stats) const;
+    void add_to(SizeClassTable& table) const;
+
+    // This shard alone
+    AllocatorInterface::AllocatorStats snapshot() const;
+    SizeClassTable size_classes() const;
+
+    void clear();
+
+private:
+    static void add(std::atomic<size_t>& counter, size_t amount) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+    static void bump(std::atomic<size_t>& counter, size_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+};
+
+// Empty table with max_size filled in for every class
+SizeClassTable make_size_class_table();
+
+// current_usage from the byte totals, clamped against racing readers
+inline size_t usage_from(const AllocatorInterface::AllocatorStats& stats) {
+    return stats.total_allocated > stats.total_deallocated
+        ? stats.total_allocated - stats.total_deallocated : 0;
+}
+
+} // namespace memplumber
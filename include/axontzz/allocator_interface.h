@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <mutex>
 
 namespace memplumber {
@@ -31,6 +33,50 @@ public:
      */
     virtual void deallocate(void* ptr, size_t size = 0) = 0;
     
+    /**
+     * Allocate memory whose first size bytes are zero
+     * 
+     * The default allocates and clears with memset; allocators that know a
+     * block still holds untouched zero pages from the kernel skip the memset.
+     */
+    virtual void* allocate_zeroed(size_t size, size_t alignment = sizeof(void*)) {
+        void* ptr = allocate(size, alignment);
+        if (ptr != nullptr) {
+            std::memset(ptr, 0, size);
+        }
+        return ptr;
+    }
+    
+    /**
+     * Resize an allocation, keeping its contents
+     * @param ptr: Pointer from allocate() (nullptr behaves like allocate)
+     * @param old_size: Size the block was allocated (or last resized) with
+     * @param new_size: New size in bytes (0 deallocates and returns nullptr)
+     * @param alignment: Alignment the block was allocated with
+     * @return: The resized block, which may be ptr itself, or nullptr on
+     *          failure, in which case ptr is still valid and unchanged
+     * 
+     * The default allocates a new block, copies min(old_size, new_size)
+     * bytes and deallocates ptr; allocators override it to resize in place.
+     */
+    virtual void* reallocate(void* ptr, size_t old_size, size_t new_size,
+                             size_t alignment = sizeof(void*)) {
+        if (ptr == nullptr) {
+            return allocate(new_size, alignment);
+        }
+        if (new_size == 0) {
+            deallocate(ptr, old_size);
+            return nullptr;
+        }
+        void* fresh = allocate(new_size, alignment);
+        if (fresh == nullptr) {
+            return nullptr;
+        }
+        std::memcpy(fresh, ptr, std::min(old_size, new_size));
+        deallocate(ptr, old_size);
+        return fresh;
+    }
+    
     /**
      * Check if this allocator owns the given pointer
      * @param ptr: Pointer to check
@@ -68,7 +114,10 @@ protected:
  * Thread-safe wrapper for any allocator
  * 
  * This class wraps any allocator implementation and makes it thread-safe
- * by adding mutex protection around all operations.
+ * by adding mutex protection around all operations except statistics:
+ * AllocatorType::get_stats() must be safe to call concurrently with
+ * allocation (the built-in allocators keep relaxed atomic counters), so
+ * monitoring never contends with the allocation path.
  */
 template<typename AllocatorType>
 class ThreadSafeAllocator : public AllocatorInterface {
@@ -87,16 +136,31 @@ public:
         allocator_.deallocate(ptr, size);
     }
     
+    void* allocate_zeroed(size_t size, size_t alignment = sizeof(void*)) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return allocator_.allocate_zeroed(size, alignment);
+    }
+    
+    void* reallocate(void* ptr, size_t old_size, size_t new_size,
+                     size_t alignment = sizeof(void*)) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return allocator_.reallocate(ptr, old_size, new_size, alignment);
+    }
+    
     bool owns(void* ptr) const override {
         std::lock_guard<std::mutex> lock(mutex_);
         return allocator_.owns(ptr);
     }
     
     AllocatorStats get_stats() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
         return allocator_.get_stats();
     }
     
+    // Per-size-class counters, also read without the lock
+    auto size_class_stats() const {
+        return allocator_.size_class_stats();
+    }
+    
     void reset_stats() override {
         std::lock_guard<std::mutex> lock(mutex_);
         allocator_.reset_stats();
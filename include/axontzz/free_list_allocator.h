@@ -1,9 +1,13 @@
 #pragma once
 
 #include "allocator_interface.h"
+#include "allocation_stats.h"
 #include "memory_source.h"
+#include "page_map.h"
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <iosfwd>
 
 namespace memplumber {
 
@@ -15,75 +19,366 @@ namespace memplumber {
  * principles before moving to more sophisticated strategies.
  * 
  * Key Features:
- * - Segregated free lists for different size classes
- * - Basic coalescing of adjacent free blocks
- * - First-fit allocation strategy
+ * - Segregated free lists for different size classes (two-level bins + bitmaps)
+ * - Boundary tags: constant-time coalescing with both physical neighbours
+ * - Good-fit allocation strategy (first non-empty bin that is large enough)
  * - Metadata stored in-band (within free blocks)
  * 
+ * Size classes:
+ * - Blocks smaller than SMALL_BLOCK_SIZE get one exact bin per 8-byte step
+ * - Larger blocks are binned by power of two (first level) and split into
+ *   SL_INDEX_COUNT linear sub-bins (second level)
+ * - A bitmap per level records which bins are non-empty, so the search for
+ *   a fitting bin is a couple of bit scans instead of a list walk
+ * 
+ * Placement policy (set_placement_policy()):
+ * - GoodFit (default): the bins above, O(1)
+ * - BestFit, FirstFit, NextFit: free blocks of at least SMALL_BLOCK_SIZE
+ *   move into an intrusive red-black tree stored in the blocks themselves,
+ *   keyed by (size, address) for best fit and by address for first/next
+ *   fit; every node records the largest block in its subtree, so the
+ *   lowest-address fit (from the start, or from the end of the previous
+ *   allocation for next fit) is also an O(log n) descent
+ * - Smaller blocks stay in their exact-size bins under every policy and
+ *   are tried first for requests that small
+ * 
+ * Block layout (boundary tags):
+ * - Every block starts with a tag word: block size | IN_USE | PREV_IN_USE
+ * - The tag of an allocated block is its only header: the payload follows
+ *   it directly, and the tag also packs the slack (bytes between the end
+ *   of the payload and the end of the block), so the requested size is
+ *   recovered from the block size without a separate header
+ * - A payload aligned past the tag gets an alignment prefix and the ALIGNED
+ *   tag bit; every prefix word holds the payload's offset from the block
+ *   start, so both the payload and a physical walk find the tag
+ * - Free blocks repeat their size in a footer (last word of the block), so
+ *   the following block can find the start of a free predecessor
+ * - Allocated blocks keep PREV_IN_USE instead of a footer
+ * - Each region ends with an in-use fencepost tag, so the "next block" of
+ *   the last real block is always readable and never merged
+ * - Every page of every region is registered in a radix PageMap, so owns()
+ *   and pointer-to-region lookup are O(1) regardless of the region count
+ * 
+ * Large objects:
+ * - Requests of at least large_object_threshold bytes bypass the bins and
+ *   get a span mapped directly from the MemorySource, laid out as
+ *   [MemoryRegion][tag | LARGE][prefix][user data]; the span descriptor
+ *   records the requested size
+ * - Freed spans go to a small MRU cache (at most max_cached_spans spans and
+ *   LARGE_CACHE_MAX_BYTES bytes); a later large request reuses a cached span
+ *   that is big enough but less than twice the needed size, the least
+ *   recently freed span is unmapped when the cache overflows
+ * 
+ * Reallocation:
+ * - reallocate() shrinks in place by splitting the tail off as a free
+ *   block, and grows in place by absorbing the following free block
+ * - Large spans grow or shrink with mremap; a span that cannot grow where
+ *   it is has its pages moved to a new mapping, so no bytes are copied
+ * - Anything else (including crossing the large-object threshold) falls
+ *   back to allocate + copy + deallocate
+ * 
+ * Zeroed allocation:
+ * - Heap regions and large spans come from the kernel zero-filled; free
+ *   blocks carved from that memory carry a ZEROED tag bit until their
+ *   payload is handed out, splits inherit it and merges keep it only when
+ *   both sides have it (the merged tags and links are cleared)
+ * - allocate_zeroed() skips the memset for such blocks and for freshly
+ *   mapped spans, and clears recycled memory as usual
+ * 
+ * Returning memory to the OS:
+ * - A free block of at least decommit_threshold bytes (after coalescing)
+ *   has the whole pages between its header and footer decommitted
+ *   (madvise); the block stays on its bin and is recommitted on reuse
+ * - trim() releases idle memory on demand: cached large spans first, then
+ *   regions that are entirely free, then decommits free blocks largest
+ *   first, until at most `retain` idle bytes remain committed (empty
+ *   regions that are already decommitted are always unmapped)
+ * - memory_usage() reports reserved vs committed bytes
+ * 
+ * Fragmentation:
+ * - Payload and block bytes of live allocations are maintained on every
+ *   allocate/deallocate, so internal fragmentation (get_stats()
+ *   fragmentation_ratio) is O(1) and lock-free to read
+ * - External fragmentation compares the largest free block with total
+ *   free bytes; the largest block is found in the highest non-empty bin
+ *   (or at the placement tree root)
+ * - export_heap_map() writes every region, block and span as JSON
+ * 
+ * Address space arena:
+ * - When the MemorySource has a reserved arena, the heap grows by
+ *   committing the next arena chunk; a chunk adjacent to the current arena
+ *   region extends that region in place (old fencepost becomes a free
+ *   block that coalesces with the region's trailing free block), so free
+ *   memory merges across what used to be region boundaries
+ * - owns() for the grown region is a single range check
+ * 
  * Performance Characteristics:
- * - Allocation: O(n) in worst case (linear search)
- * - Deallocation: O(1) insertion + O(n) coalescing
- * - Space overhead: ~8-16 bytes per free block for metadata
+ * - Allocation: O(1) for typical requests (bitmap search), falls back to
+ *   scanning a single bin when only that bin may hold a fitting block;
+ *   O(log n) free blocks under the tree placement policies
+ * - Deallocation: O(1) insertion + O(1) coalescing via boundary tags
+ * - Space overhead: 8 bytes per allocated block (16 when an alignment
+ *   prefix is needed), 32 bytes minimum per block
  */
 class FreeListAllocator : public AllocatorInterface {
 public:
+    // Where new allocations are placed (see class comment)
+    enum class PlacementPolicy { GoodFit, FirstFit, NextFit, BestFit };
+    
     /**
      * Constructor
      * @param memory_source: Source for obtaining large memory blocks from OS
      * @param initial_block_size: Size of initial memory block to request
+     * @param large_object_threshold: Requests of at least this many bytes are
+     *        mapped directly (0 disables the large-object path)
+     * @param max_cached_spans: Freed large spans kept for reuse before unmapping
      */
     explicit FreeListAllocator(MemorySource& memory_source, 
-                              size_t initial_block_size = 1024 * 1024); // 1MB default
+                              size_t initial_block_size = 1024 * 1024, // 1MB default
+                              size_t large_object_threshold = 256 * 1024,
+                              size_t max_cached_spans = 4);
     
     ~FreeListAllocator() override;
     
     // AllocatorInterface implementation
     void* allocate(size_t size, size_t alignment = sizeof(void*)) override;
     void deallocate(void* ptr, size_t size = 0) override;
+    
+    /**
+     * Resize in place where the heap layout allows it (see class comment)
+     * 
+     * The current size is read from the allocation header, old_size is
+     * only used for the nullptr/0 cases. Counted as one deallocation of the
+     * old size plus one allocation of the new size.
+     */
+    void* reallocate(void* ptr, size_t old_size, size_t new_size,
+                     size_t alignment = sizeof(void*)) override;
+    void* allocate_zeroed(size_t size, size_t alignment = sizeof(void*)) override;
     bool owns(void* ptr) const override;
     AllocatorStats get_stats() const override;
     void reset_stats() override;
     const char* get_name() const override { return "FreeListAllocator"; }
     
+    /**
+     * Per-size-class allocation counts and bytes
+     * 
+     * Like get_stats(), only loads relaxed atomic counters and is safe to
+     * call from any thread while allocation is in progress.
+     */
+    SizeClassTable size_class_stats() const { return stats_.size_classes(); }
+    
+    /**
+     * Payload size recorded for a live allocation
+     * @param ptr: Pointer returned by allocate() and not yet deallocated
+     * @return: The size passed to allocate()
+     * 
+     * Reads the block's tag (and the span descriptor of a large object)
+     * without taking any lock. The tag also carries PREV_IN_USE, which a
+     * locked free or split of the preceding block flips; both sides access
+     * the word atomically (load_tag / set_prev_in_use), so calling this
+     * concurrently with operations on other allocations is race-free.
+     */
+    size_t allocation_size(void* ptr) const {
+        const char* user_ptr = static_cast<const char*>(ptr);
+        return requested_size(block_of_payload(user_ptr), user_ptr);
+    }
+    
 private:
-    // Per-allocation header placed immediately before the user pointer
-    struct AllocationHeader {
-        size_t span;         // Total bytes consumed from the original free block
-        size_t requested;    // Payload size requested by caller
-        size_t prefix_size;  // Bytes before header absorbed from the original block
-    };
+    // Boundary tag word at the start of every block (size | flags)
+    static constexpr size_t TAG_SIZE = sizeof(size_t);
+    static constexpr size_t TAG_IN_USE = 1;        // This block is allocated
+    static constexpr size_t TAG_PREV_IN_USE = 2;   // Physically preceding block is not free
+    static constexpr size_t TAG_LARGE = 4;         // Block is a directly mapped large span
+    static constexpr size_t TAG_DECOMMITTED = 4;   // Free block's interior pages are decommitted
+                                                   // (shares the bit: LARGE is only set on in-use blocks)
+    static constexpr size_t TAG_ZEROED = size_t(1) << 63; // Free block's payload is still kernel zero pages
+    static constexpr size_t TAG_ALIGNED = size_t(1) << 62; // In-use block's payload follows an alignment prefix
+    
+    // In-use heap blocks keep their slack (block end - payload end) in the
+    // tag's high bits; it never exceeds a split remainder plus the minimum
+    // payload, and block sizes stay below 2^TAG_SLACK_SHIFT
+    static constexpr size_t TAG_SLACK_SHIFT = 48;
+    static constexpr size_t TAG_SLACK_MAX = 0xff;
+    static constexpr size_t TAG_SLACK_MASK = TAG_SLACK_MAX << TAG_SLACK_SHIFT;
 
     // Free block header - stored at the beginning of each free block
     struct FreeBlock {
-        size_t size;           // Size of this free block (including header)
+        size_t tag;            // Size of this free block (including header) | flags
         FreeBlock* next;       // Next block in free list
         FreeBlock* prev;       // Previous block in free list (for fast removal)
     };
     
-    // Minimum allocation size must accommodate the free block header
-    static constexpr size_t MIN_BLOCK_SIZE = sizeof(FreeBlock);
+    // Free block indexed by the placement tree; the node colour is the
+    // low bit of parent_color
+    struct TreeBlock : FreeBlock {
+        TreeBlock* left;
+        TreeBlock* right;
+        uintptr_t parent_color;
+        size_t max_size;       // Largest block size in this subtree
+    };
+    
+    // Minimum block size must accommodate the free block header and footer
+    static constexpr size_t MIN_BLOCK_SIZE = sizeof(FreeBlock) + TAG_SIZE;
+    
+    // All block sizes and block addresses are kept at this granularity
+    static constexpr size_t MIN_ALIGNMENT = sizeof(void*);
+    static constexpr size_t TAG_FLAGS = MIN_ALIGNMENT - 1;
+    static constexpr size_t TAG_SIZE_MASK = ((size_t(1) << TAG_SLACK_SHIFT) - 1) & ~TAG_FLAGS;
+    
+    // Smallest payload span, so that every block can later hold a free block
+    static constexpr size_t MIN_PAYLOAD = MIN_BLOCK_SIZE - TAG_SIZE;
+    
+    // Size-class layout: SL_INDEX_COUNT sub-bins per power of two,
+    // sizes below SMALL_BLOCK_SIZE map linearly onto the first level
+    static constexpr size_t SL_INDEX_COUNT_LOG2 = 4;
+    static constexpr size_t SL_INDEX_COUNT = size_t(1) << SL_INDEX_COUNT_LOG2;
+    static constexpr size_t FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + 3;
+    static constexpr size_t SMALL_BLOCK_SIZE = size_t(1) << FL_INDEX_SHIFT;
+    static constexpr size_t FL_INDEX_COUNT = 64 - FL_INDEX_SHIFT + 1;
+    static_assert(sizeof(TreeBlock) + TAG_SIZE <= SMALL_BLOCK_SIZE,
+                  "blocks that enter the placement tree must hold a tree node");
     
     // Memory region descriptor - tracks OS allocations
     struct MemoryRegion {
         void* start;           // Start of memory region
         size_t size;           // Size of region
         MemoryRegion* next;    // Next region in list
+        MemoryRegion* prev;    // Previous region in list (for fast removal)
+        size_t requested;      // Large spans: payload size requested by caller
     };
     
+    // Free blocks at least this large are decommitted when freed
+    static constexpr size_t DEFAULT_DECOMMIT_THRESHOLD = 1024 * 1024;
+    
+    // Upper bound on the bytes held by the large span cache
+    static constexpr size_t LARGE_CACHE_MAX_BYTES = 64 * 1024 * 1024;
+    
     MemorySource& memory_source_;
-    FreeBlock* free_list_head_;    // Head of free block list
+    PageMap page_map_;                      // Page -> owning MemoryRegion
+    FreeBlock* bins_[FL_INDEX_COUNT][SL_INDEX_COUNT]; // Segregated free lists
+    uint64_t fl_bitmap_;                    // Bit i set: some bins_[i][*] non-empty
+    uint32_t sl_bitmap_[FL_INDEX_COUNT];    // Bit j set: bins_[i][j] non-empty
+    size_t free_block_count_;               // Blocks currently on all free lists
+    PlacementPolicy policy_;
+    TreeBlock* tree_root_;                  // Placement tree (non-GoodFit policies)
+    uintptr_t rover_;                       // End of the last allocation (NextFit)
     MemoryRegion* regions_head_;   // Head of memory regions list
-    AllocatorStats stats_;
+    StatsShard stats_;                      // Single-writer counters, readable from any thread
     size_t default_block_size_;
+    size_t large_object_threshold_;
+    size_t max_cached_spans_;
+    MemoryRegion* large_spans_;    // Live large spans
+    MemoryRegion* span_cache_;     // Freed large spans, most recently freed first
+    size_t large_span_count_;
+    size_t cached_span_count_;
+    size_t cached_span_bytes_;
+    size_t reserved_bytes_;        // Bytes mapped for regions and large spans
+    size_t free_bytes_;            // Bytes in blocks on the free lists
+    size_t decommitted_bytes_;     // Bytes decommitted inside free blocks
+    size_t reclaimable_bytes_;     // Committed whole pages inside free blocks
+    size_t decommit_threshold_;
+    MemoryRegion* arena_region_;   // Region grown in place at the arena frontier
+    std::atomic<size_t> live_requested_bytes_; // Payload of live allocations (single writer)
+    std::atomic<size_t> live_block_bytes_;     // Block bytes of live allocations (single writer)
     
     // Internal helper methods
-    void* allocate_from_free_list(size_t size, size_t alignment);
+    void* allocate_block(size_t size, size_t alignment, bool zero);
+    void* allocate_from_free_list(size_t size, size_t alignment, bool zero = false);
     void add_to_free_list(FreeBlock* block);
+    void insert_into_bin(FreeBlock* block);
+    void remove_from_bin(FreeBlock* block);
     void remove_from_free_list(FreeBlock* block);
     FreeBlock* find_suitable_block(size_t size, size_t alignment);
-    void split_block(FreeBlock* block, size_t needed_size);
-    void coalesce_free_blocks();
+    bool block_fits(const FreeBlock* block, size_t size, size_t alignment) const;
+    FreeBlock* coalesce_block(char* block_start, size_t size, bool zeroed = false);
+    bool resize_in_place(char* block_start, char* user_ptr, size_t new_size);
     bool expand_heap(size_t min_size);
+    bool extend_region(MemoryRegion* region, char* chunk, size_t size);
+    
+    // Large-object path
+    void* allocate_large(size_t size, size_t alignment, bool zero);
+    void deallocate_large(MemoryRegion* span);
+    char* reallocate_large(MemoryRegion* span, char* user_ptr, size_t new_size, size_t alignment);
+    void set_span_size(MemoryRegion* span, size_t size);
+    MemoryRegion* take_cached_span(size_t min_size);
+    void release_span(MemoryRegion* span);
+    
+    // Returning pages to the OS
+    bool decommit_block(FreeBlock* block);
+    void decommit_range(const FreeBlock* block, char*& begin, char*& end) const;
+    size_t decommit_length(const FreeBlock* block) const;
+    bool release_region_if_empty(MemoryRegion* region);
+    bool map_range(void* start, size_t size, MemoryRegion* region);
+    void unmap_range(void* start, size_t size);
+    static void list_push(MemoryRegion*& head, MemoryRegion* region);
+    static void list_remove(MemoryRegion*& head, MemoryRegion* region);
+    
+    // Boundary tag helpers
+    static size_t& tag_at(char* block_start) { return *reinterpret_cast<size_t*>(block_start); }
+    // Unlocked readers of an in-use tag (allocation_size) race only with the
+    // PREV_IN_USE update of set_prev_in_use(); both use relaxed atomics
+    static size_t load_tag(const void* word) {
+        return __atomic_load_n(static_cast<const size_t*>(word), __ATOMIC_RELAXED);
+    }
+    static size_t block_size(const void* block_start) {
+        return *static_cast<const size_t*>(block_start) & TAG_SIZE_MASK;
+    }
+    static FreeBlock* make_free_block(char* block_start, size_t size);
+    static void set_payload(char* block_start, char* user_ptr, size_t requested);
+    static void set_requested(char* block_start, const char* user_ptr, size_t requested);
+    static size_t payload_span(size_t size);
+    
+    // The word before a payload is either the block's tag (IN_USE set) or
+    // the last prefix word, which holds the payload offset (a multiple of 8)
+    static char* block_of_payload(const char* user_ptr) {
+        const size_t word = load_tag(user_ptr - TAG_SIZE);
+        return const_cast<char*>(user_ptr - ((word & TAG_IN_USE) != 0 ? TAG_SIZE : word));
+    }
+    static char* payload_of_block(const char* block_start) {
+        const size_t* words = reinterpret_cast<const size_t*>(block_start);
+        return const_cast<char*>(block_start + ((load_tag(words) & TAG_ALIGNED) != 0 ? words[1] : TAG_SIZE));
+    }
+    static size_t requested_size(const char* block_start, const char* user_ptr) {
+        const size_t tag = load_tag(block_start);
+        if ((tag & TAG_LARGE) != 0) {
+            return reinterpret_cast<const MemoryRegion*>(block_start - sizeof(MemoryRegion))->requested;
+        }
+        return static_cast<size_t>(block_start + (tag & TAG_SIZE_MASK) - user_ptr) -
+               ((tag & TAG_SLACK_MASK) >> TAG_SLACK_SHIFT);
+    }
+    static void set_prev_in_use(char* block_start, bool in_use);
+    
+    // Size-class mapping
+    static void mapping_insert(size_t size, size_t& fl, size_t& sl);
+    static void mapping_search(size_t size, size_t& fl, size_t& sl);
+    FreeBlock* search_bins(size_t& fl, size_t& sl) const;
+    
+    // Placement tree (intrusive red-black tree augmented with max_size)
+    bool uses_tree(size_t size) const { return policy_ != PlacementPolicy::GoodFit && size >= SMALL_BLOCK_SIZE; }
+    FreeBlock* find_placement(size_t size, size_t alignment, size_t needed);
+    bool tree_less(const TreeBlock* a, const TreeBlock* b) const;
+    void tree_insert(TreeBlock* block);
+    void tree_remove(TreeBlock* block);
+    void tree_remove_fixup(TreeBlock* node, TreeBlock* parent);
+    void tree_rotate(TreeBlock* node, bool left);
+    void tree_replace_child(TreeBlock* parent, TreeBlock* old_child, TreeBlock* new_child);
+    TreeBlock* tree_best_fit(size_t size, size_t alignment) const;
+    static TreeBlock* tree_first_fit(TreeBlock* node, size_t needed, uintptr_t from);
+    static TreeBlock* tree_leftmost(TreeBlock* node);
+    static TreeBlock* tree_successor(TreeBlock* node);
+    static TreeBlock* tree_parent(const TreeBlock* node) {
+        return reinterpret_cast<TreeBlock*>(node->parent_color & ~uintptr_t(1));
+    }
+    static bool tree_red(const TreeBlock* node) { return node != nullptr && (node->parent_color & 1) != 0; }
+    static void tree_set_parent(TreeBlock* node, TreeBlock* parent) {
+        node->parent_color = reinterpret_cast<uintptr_t>(parent) | (node->parent_color & 1);
+    }
+    static void tree_set_red(TreeBlock* node, bool red) {
+        node->parent_color = (node->parent_color & ~uintptr_t(1)) | (red ? 1 : 0);
+    }
+    static void tree_update(TreeBlock* node);
+    static void tree_update_path(TreeBlock* node);
+    bool validate_tree(const TreeBlock* node, const TreeBlock* parent, size_t& black_height, size_t& count) const;
     
     // Alignment and size utilities
     static size_t align_size(size_t size, size_t alignment);
@@ -94,8 +389,110 @@ public:
     // Validation and debugging (public for testing)
     bool validate_free_list() const;
     void dump_free_list() const;
+    size_t free_block_count() const { return free_block_count_; }
+    size_t region_count() const;
+    size_t largest_free_block() const;
+    size_t page_map_overhead() const { return page_map_.memory_overhead(); }
+    size_t large_object_threshold() const { return large_object_threshold_; }
+    size_t large_span_count() const { return large_span_count_; }
+    size_t cached_span_count() const { return cached_span_count_; }
+    size_t cached_span_bytes() const { return cached_span_bytes_; }
+    
+    /**
+     * Unmap every cached large span
+     */
+    void release_cached_spans();
+    
+    // Reserved vs committed memory owned by this allocator
+    struct MemoryUsage {
+        size_t reserved = 0;       // Bytes mapped (regions, live and cached spans)
+        size_t committed = 0;      // Reserved bytes not decommitted
+        size_t free = 0;           // Bytes in free blocks
+        size_t decommitted = 0;    // Bytes decommitted inside free blocks
+        size_t cached_spans = 0;   // Bytes in cached large spans
+    };
+    MemoryUsage memory_usage() const;
+    
+    // Internal and external fragmentation of the heap
+    struct Fragmentation {
+        size_t requested = 0;        // Payload bytes of live allocations
+        size_t allocated = 0;        // Block bytes they occupy (tag, header, padding, payload)
+        double internal = 0.0;       // 1 - requested / allocated
+        size_t free = 0;             // Bytes in free blocks
+        size_t largest_free = 0;     // Largest single free block
+        double external = 0.0;       // 1 - largest_free / free
+    };
+    Fragmentation fragmentation() const;
+    
+    // How allocate_zeroed() requests were satisfied
+    struct ZeroFillStats {
+        size_t pristine = 0;       // Served from untouched kernel pages, no memset
+        size_t cleared = 0;        // Recycled memory cleared with memset
+        size_t cleared_bytes = 0;  // Bytes cleared by those memsets
+    };
+    const ZeroFillStats& zero_fill_stats() const { return zero_fill_; }
+    
+    /**
+     * Write the heap layout as one JSON object: a summary, then every region
+     * with its blocks in address order (offset, size, used/free, requested
+     * bytes or decommitted flag), live large spans and cached spans
+     */
+    void export_heap_map(std::ostream& out) const;
+    
+    /**
+     * Bytes of heap regions and large spans backed by huge pages
+     * (see MemorySource::huge_page_bytes; reads /proc, not for hot paths)
+     */
+    size_t huge_page_bytes() const;
+    
+    /**
+     * Committed memory trim() could return to the OS (whole pages inside
+     * free blocks that are not yet decommitted, plus cached large spans)
+     */
+    size_t idle_bytes() const;
+    
+    /**
+     * Return idle memory to the OS until at most `retain` idle bytes remain
+     * @return: Bytes unmapped or decommitted
+     */
+    size_t trim(size_t retain = 0);
+    
+    /**
+     * Choose where new allocations are placed (see class comment)
+     * 
+     * Re-indexes every free block, O(heap blocks); live allocations and
+     * the decommitted state of free blocks are unaffected.
+     */
+    void set_placement_policy(PlacementPolicy policy);
+    PlacementPolicy placement_policy() const { return policy_; }
+    static const char* placement_policy_name(PlacementPolicy policy);
+    
+    /**
+     * Free blocks of at least this many bytes are decommitted on deallocate
+     * (0 disables eager decommit; trim() still works)
+     */
+    void set_decommit_threshold(size_t bytes) { decommit_threshold_ = bytes; }
+    size_t decommit_threshold() const { return decommit_threshold_; }
+    
+    /**
+     * Report every address range this allocator maps or unmaps (heap
+     * regions, arena growth, large spans), so that several allocators
+     * can tell their memory apart: hook(context, start, size, true) after
+     * a range is mapped, hook(context, start, size, false) before its
+     * addresses are given back to the OS
+     * 
+     * A mapping the hook rejects (returns false) is treated like a failed
+     * mmap. Ranges mapped before the call are reported at once; the return
+     * value says whether the hook accepted all of them. The hook runs on
+     * the allocating thread, inside whatever lock guards this allocator.
+     */
+    using RangeHook = bool (*)(void* context, void* start, size_t size, bool mapped);
+    bool set_range_hook(RangeHook hook, void* context);
 
 private:
+    ZeroFillStats zero_fill_;
+    RangeHook range_hook_;
+    void* range_hook_context_;
     
     // Disable copying
     FreeListAllocator(const FreeListAllocator&) = delete;
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "allocator_interface.h"
+#include <cstddef>
+#include <memory_resource>
+#include <new>
+
+namespace memplumber {
+
+/**
+ * std::pmr::memory_resource over any AllocatorInterface
+ *
+ * Lets std::pmr containers allocate from a runtime-selected allocator.
+ * The size and alignment the container passes to deallocate are forwarded
+ * unchanged, so allocators that can use the size do not need to look it up.
+ * Allocation failure throws std::bad_alloc as memory_resource requires.
+ *
+ * The resource does not own the allocator, which must outlive it and every
+ * container using it. Two resources compare equal when they forward to the
+ * same allocator, so memory from one may be freed through the other.
+ */
+class AllocatorResource : public std::pmr::memory_resource {
+public:
+    explicit AllocatorResource(AllocatorInterface& allocator) : allocator_(allocator) {}
+
+    AllocatorInterface& allocator() const { return allocator_; }
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        // memory_resource 允许 0 字节请求，返回的指针仍须唯一
+        void* ptr = allocator_.allocate(bytes != 0 ? bytes : 1, alignment);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t) override {
+        allocator_.deallocate(ptr, bytes != 0 ? bytes : 1);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        if (this == &other) {
+            return true;
+        }
+        const auto* resource = dynamic_cast<const AllocatorResource*>(&other);
+        return resource != nullptr && &resource->allocator_ == &allocator_;
+    }
+
+private:
+    AllocatorInterface& allocator_;
+};
+
+/**
+ * std::pmr::memory_resource over a concrete allocator type
+ *
+ * Same contract as AllocatorResource, but the allocator calls are
+ * qualified with the concrete type, so the only indirection left is the
+ * memory_resource dispatch itself: allocate and deallocate are
+ * devirtualized and can be inlined into do_allocate/do_deallocate.
+ * AllocatorType needs allocate(size, alignment) and deallocate(ptr, size).
+ */
+template<typename AllocatorType>
+class TypedAllocatorResource final : public std::pmr::memory_resource {
+public:
+    explicit TypedAllocatorResource(AllocatorType& allocator) : allocator_(allocator) {}
+
+    AllocatorType& allocator() const { return allocator_; }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        void* ptr = allocator_.AllocatorType::allocate(bytes != 0 ? bytes : 1, alignment);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+        return ptr;
+    }
+
+    void do_deallocate(void* ptr, size_t bytes, size_t) override {
+        allocator_.AllocatorType::deallocate(ptr, bytes != 0 ? bytes : 1);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        if (this == &other) {
+            return true;
+        }
+        const auto* resource = dynamic_cast<const TypedAllocatorResource*>(&other);
+        return resource != nullptr && &resource->allocator_ == &allocator_;
+    }
+
+    AllocatorType& allocator_;
+};
+
+} // namespace memplumber
@@ -1,10 +1,12 @@
 #pragma once
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <stdexcept>
+#include "axontzz/numa.h"
 
 namespace memplumber {
 
@@ -20,14 +22,62 @@ namespace memplumber {
  * - Minimal metadata overhead
  * - Direct system call interface
  * - Exception-safe RAII management
+ * 
+ * Huge pages:
+ * - With a HugePagePolicy other than None, blocks of at least
+ *   HUGE_PAGE_SIZE are rounded up to whole huge pages and placed on
+ *   HUGE_PAGE_SIZE boundaries, so the kernel can back them with 2 MiB pages
+ * - Transparent: madvise(MADV_HUGEPAGE) on the block
+ * - Explicit: MAP_HUGETLB from the reserved hugetlbfs pool, falling back
+ *   to Transparent when the pool is empty or unsupported
+ * - Smaller blocks keep 4 KiB granularity; the policy is fixed at
+ *   construction so deallocate_block() rounds sizes the same way
+ * 
+ * Address space arena:
+ * - reserve_arena() maps one contiguous PROT_NONE range up front; nothing
+ *   is committed and no swap is reserved (MAP_NORESERVE)
+ * - commit_arena() makes the next chunk above the committed frontier
+ *   readable/writable with mprotect, so successive chunks are adjacent
+ * - deallocate_block() on an arena chunk drops its pages and protection
+ *   again; chunks at the top of the arena lower the frontier for reuse
+ * - Ownership of arena memory is a range check (in_arena())
+ * 
+ * Concurrency:
+ * - One source may be shared by allocators on different threads: the
+ *   statistics are relaxed atomic counters, and the arena frontier is
+ *   advanced with compare-and-swap, so no call takes a lock
+ * - Configuration (set_block_cache(), set_decommit_mode(), reserve_arena())
+ *   must happen before the source is shared
+ * 
+ * Block cache:
+ * - set_block_cache() keeps up to BLOCK_CACHE_SLOTS freed blocks of one
+ *   size instead of unmapping them; allocate_block() of that size pops one
+ * - Cached blocks are emptied with MADV_DONTNEED, so they read as zero like
+ *   a fresh mapping and hold no physical memory, and reuse avoids the
+ *   munmap/mmap pair that serializes threads on the process's mmap lock
+ * - The cache is a lock-free stack over a fixed slot array; the links live
+ *   in the slots, never in the cached blocks, so a stale reader cannot
+ *   touch memory another thread has since unmapped
+ * 
+ * NUMA placement:
+ * - With a node set (constructor or set_numa_node()), every new mapping
+ *   and every committed arena chunk gets an mbind policy for that node, so
+ *   its pages are faulted in on the node that will use them
+ * - Placement is advisory: a rejected policy is counted in
+ *   numa_bind_failures and the block is still returned
  */
 class MemorySource {
 public:
     // Default page size for most x86_64 systems
     static constexpr size_t DEFAULT_PAGE_SIZE = 4096;
+    static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+    
+    enum class HugePagePolicy { None, Transparent, Explicit };
     
     MemorySource();
-    ~MemorySource() = default;
+    explicit MemorySource(HugePagePolicy huge_page_policy, size_t arena_reserve = 0,
+                          int numa_node = numa::NO_NODE);
+    ~MemorySource();
     
     /**
      * Allocate a large block of memory from the OS
@@ -36,13 +86,136 @@ public:
      */
     void* allocate_block(size_t size);
     
+    /**
+     * Allocate a block whose start address is a multiple of alignment
+     * @param size: Requested size in bytes (will be rounded up to page boundaries)
+     * @param alignment: Power of two, at least the page size
+     * @return: Pointer to allocated memory, or nullptr on failure
+     * 
+     * Over-reserves by alignment and unmaps the unused head and tail, so the
+     * result can be released with deallocate_block(ptr, size) as usual.
+     */
+    void* allocate_aligned_block(size_t size, size_t alignment);
+    
+    /**
+     * Reserve a contiguous range of address space for commit_arena()
+     * @param size: Bytes to reserve (rounded up to pages; to huge pages
+     *              under a huge page policy)
+     * @return: false if an arena already exists or the reservation failed
+     */
+    bool reserve_arena(size_t size);
+    
+    /**
+     * Commit the next chunk of the arena
+     * @param size: Requested size in bytes (rounded like allocate_block)
+     * @return: Start of the chunk, directly after the previously committed
+     *          chunk, or nullptr if there is no arena or it is exhausted
+     * 
+     * Release the chunk with deallocate_block(ptr, size).
+     */
+    void* commit_arena(size_t size);
+    
+    bool has_arena() const { return arena_base_ != nullptr; }
+    bool in_arena(const void* ptr) const {
+        return static_cast<const char*>(ptr) >= arena_base_ &&
+               static_cast<const char*>(ptr) < arena_base_ + arena_size_;
+    }
+    void* arena_base() const { return arena_base_; }
+    size_t arena_reserved() const { return arena_size_; }
+    size_t arena_frontier() const {  // Bytes below the committed frontier
+        return arena_top_.load(std::memory_order_relaxed);
+    }
+    
     /**
      * Return memory block to the OS
-     * @param ptr: Pointer to memory block (must be from allocate_block)
+     * @param ptr: Pointer to memory block (from allocate_block or commit_arena)
      * @param size: Size of the block (must match original allocation)
      */
     void deallocate_block(void* ptr, size_t size);
     
+    /**
+     * Grow or shrink a block from allocate_block() without moving it (mremap)
+     * @param ptr: Start of the block
+     * @param old_size: Current size of the block
+     * @param new_size: Desired size (rounded like allocate_block)
+     * @return: false if the pages above the block are taken (growing), or
+     *          the block cannot be remapped (arena chunk, huge page block)
+     * 
+     * Shrinking always succeeds for blocks that can be remapped.
+     */
+    bool resize_block(void* ptr, size_t old_size, size_t new_size);
+    
+    /**
+     * Whether resize_block()/move_block() can handle this block at all
+     */
+    bool can_remap(const void* ptr, size_t old_size, size_t new_size) const;
+    
+    /**
+     * Move the pages of a block onto another block (mremap MREMAP_FIXED)
+     * @param from: Block to move, old_size bytes; released by the move
+     * @param old_size: Size of from
+     * @param to: Block from allocate_block(new_size) whose mapping is replaced
+     * @param new_size: Size of to, at least old_size
+     * @return: false if the move failed (both blocks are left as they were)
+     * 
+     * Only page table entries move: no data is copied, and the bytes past
+     * old_size read as zero. The destination is mapped by the caller first,
+     * so it can prepare its metadata before the pages change hands.
+     */
+    bool move_block(void* from, size_t old_size, void* to, size_t new_size);
+    
+    /**
+     * How decommit() hands pages back to the kernel
+     * - DontNeed: MADV_DONTNEED, RSS drops immediately, next touch faults in a zero page
+     * - Free: MADV_FREE, the kernel reclaims lazily under memory pressure
+     *   (falls back to DontNeed where unsupported)
+     */
+    enum class DecommitMode { DontNeed, Free };
+    
+    /**
+     * Release the physical pages behind a range while keeping it mapped
+     * @param ptr: Page-aligned start of the range
+     * @param size: Length in bytes (multiple of the page size)
+     * @return: false if madvise failed
+     * 
+     * The range stays readable and writable; its contents become undefined.
+     */
+    bool decommit(void* ptr, size_t size);
+    
+    /**
+     * Mark a previously decommitted range as committed again
+     * (pages are faulted back in on first touch; this only updates stats)
+     */
+    void recommit(void* ptr, size_t size);
+    
+    void set_decommit_mode(DecommitMode mode) { decommit_mode_ = mode; }
+    DecommitMode get_decommit_mode() const { return decommit_mode_; }
+    
+    static constexpr size_t BLOCK_CACHE_SLOTS = 64;
+    
+    /**
+     * Cache freed blocks of one size for reuse by allocate_block()
+     * @param block_size: Block size to cache (rounded like allocate_block);
+     *                    0 disables the cache
+     * @param max_blocks: Cache capacity, at most BLOCK_CACHE_SLOTS
+     * @return: false for sizes that take huge pages (never cached)
+     * 
+     * Blocks already cached are unmapped. Call before sharing the source.
+     */
+    bool set_block_cache(size_t block_size, size_t max_blocks = BLOCK_CACHE_SLOTS);
+    size_t block_cache_size() const { return block_cache_size_; }
+    
+    /**
+     * Place memory mapped from now on on a NUMA node
+     * @param node: Node id, or numa::NO_NODE for the process default
+     * @return: false if the node is out of range (setting unchanged)
+     * 
+     * Call before sharing the source.
+     */
+    bool set_numa_node(int node, numa::Policy policy = numa::Policy::Preferred);
+    int numa_node() const { return numa_node_; }
+    numa::Policy numa_policy() const { return numa_policy_; }
+    
     /**
      * Get system page size
      * @return: Page size in bytes
@@ -56,6 +229,30 @@ public:
      */
     size_t align_to_page(size_t size) const;
     
+    /**
+     * Number of bytes allocate_block(size) actually maps
+     * (page-rounded, or huge-page-rounded for big blocks under a huge page policy)
+     */
+    size_t block_size_for(size_t size) const;
+    
+    HugePagePolicy get_huge_page_policy() const { return huge_page_policy_; }
+    
+    /**
+     * Bytes of [ptr, ptr + size) currently backed by huge pages
+     * 
+     * Read from /proc/self/smaps (AnonHugePages, or Rss of hugetlb
+     * mappings). When the kernel merged the range into a larger mapping,
+     * the mapping's huge bytes are attributed up to the size of the overlap.
+     * Returns 0 if smaps is unavailable.
+     */
+    static size_t huge_page_bytes(const void* ptr, size_t size);
+    
+    /**
+     * Whether transparent huge pages can be requested with MADV_HUGEPAGE
+     * (THP mode "always" or "madvise")
+     */
+    static bool transparent_huge_pages_available();
+    
     // Statistics for monitoring and debugging
     struct Stats {
         size_t total_allocated = 0;    // Total bytes allocated from OS
@@ -63,14 +260,79 @@ public:
         size_t current_usage = 0;      // Current memory usage
         size_t allocation_count = 0;   // Number of mmap calls
         size_t deallocation_count = 0; // Number of munmap calls
+        size_t current_decommitted = 0; // Mapped bytes whose pages were decommitted
+        size_t decommit_count = 0;     // Number of madvise calls
+        size_t hugetlb_blocks = 0;     // Blocks mapped with MAP_HUGETLB
+        size_t hugepage_advised_blocks = 0; // Blocks advised with MADV_HUGEPAGE
+        size_t hugetlb_fallbacks = 0;  // MAP_HUGETLB attempts that fell back
+        size_t remap_count = 0;        // Number of mremap calls that resized or moved a block
+        size_t current_cached = 0;     // Bytes held by the block cache (not in current_usage)
+        size_t cache_hits = 0;         // allocate_block() calls served from the block cache
+        size_t numa_bound_blocks = 0;  // Mappings given a node policy with mbind
+        size_t numa_bind_failures = 0; // mbind calls the kernel rejected
+        
+        // Mapped bytes that may be backed by physical pages
+        size_t committed() const { return current_usage - current_decommitted; }
     };
     
-    const Stats& get_stats() const { return stats_; }
-    void reset_stats() { stats_ = Stats{}; }
+    /**
+     * Snapshot of the counters; under concurrent use each field is exact
+     * but the fields are not read at one instant
+     */
+    Stats get_stats() const;
+    void reset_stats();
     
 private:
+    // Live counters behind Stats (same meaning, updated with relaxed atomics)
+    struct Counters {
+        std::atomic<size_t> total_allocated{0};
+        std::atomic<size_t> total_deallocated{0};
+        std::atomic<size_t> current_usage{0};
+        std::atomic<size_t> allocation_count{0};
+        std::atomic<size_t> deallocation_count{0};
+        std::atomic<size_t> current_decommitted{0};
+        std::atomic<size_t> decommit_count{0};
+        std::atomic<size_t> hugetlb_blocks{0};
+        std::atomic<size_t> hugepage_advised_blocks{0};
+        std::atomic<size_t> hugetlb_fallbacks{0};
+        std::atomic<size_t> remap_count{0};
+        std::atomic<size_t> current_cached{0};
+        std::atomic<size_t> cache_hits{0};
+        std::atomic<size_t> numa_bound_blocks{0};
+        std::atomic<size_t> numa_bind_failures{0};
+    };
+    
+    // Block cache slot: links are slot indices, heads pack (ABA tag << 32 | index)
+    struct CacheSlot {
+        void* block;
+        std::atomic<uint32_t> next;
+    };
+    static constexpr uint32_t NO_SLOT = 0xffffffffu;
+    
     size_t page_size_;
-    Stats stats_;
+    HugePagePolicy huge_page_policy_;
+    DecommitMode decommit_mode_;
+    int numa_node_;
+    numa::Policy numa_policy_;
+    char* arena_base_;
+    size_t arena_size_;
+    std::atomic<size_t> arena_top_;
+    Counters stats_;
+    size_t block_cache_size_;
+    std::atomic<uint64_t> cached_head_;  // Slots holding a cached block
+    std::atomic<uint64_t> spare_head_;   // Empty slots
+    CacheSlot cache_slots_[BLOCK_CACHE_SLOTS];
+    
+    bool wants_huge_pages(size_t size) const;
+    void* map_aligned(size_t aligned_size, size_t alignment, int prot = PROT_READ | PROT_WRITE);
+    void release_arena_chunk(void* ptr, size_t size);
+    void* map_huge_block(size_t size);
+    void place_on_node(void* ptr, size_t size);
+    uint32_t pop_slot(std::atomic<uint64_t>& head);
+    void push_slot(std::atomic<uint64_t>& head, uint32_t index);
+    void* take_cached_block();
+    bool cache_block(void* ptr);
+    void release_cached_blocks();
     
     // Disable copying - this manages OS resources
     MemorySource(const MemorySource&) = delete;
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "allocator_interface.h"
+#include "allocation_stats.h"
+#include "memory_source.h"
+#include "page_map.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace memplumber {
+
+/**
+ * Monotonic (bump) arena for memory that dies all at once
+ *
+ * Allocation advances a cursor through blocks obtained from the
+ * MemorySource; there are no per-object headers, free lists or
+ * coalescing. deallocate() is a no-op: memory comes back only in bulk,
+ * through reset() or by rolling back to a checkpoint.
+ *
+ * Key Features:
+ * - Blocks grow geometrically from initial_block_size up to
+ *   max_block_size; a larger request gets a block of its own
+ * - reset() rewinds to the first block and keeps every block, so a
+ *   request-scoped arena stops touching the OS after warming up
+ * - checkpoint()/rollback() mark and restore the cursor and nest like a
+ *   stack; Scope does the rollback on destruction
+ * - The most recent allocation can be grown or shrunk in place
+ * - Blocks are registered in a radix PageMap, so owns() is O(1)
+ *
+ * Performance Characteristics:
+ * - Allocation: O(1) (a compare and an add on the fast path)
+ * - Deallocation: no-op
+ * - reset()/rollback(): O(1), blocks are not returned to the OS
+ *
+ * Not thread-safe; wrap in ThreadSafeAllocator or use one arena per thread.
+ */
+class MonotonicArena : public AllocatorInterface {
+private:
+    struct Block;
+
+public:
+    /**
+     * Position of the cursor, restored by rollback()
+     *
+     * Checkpoints must be rolled back in LIFO order: rolling back to one
+     * invalidates every checkpoint taken after it, and reset() or
+     * release() invalidates all of them.
+     */
+    struct Checkpoint {
+        Block* block = nullptr;    // Block holding the cursor (nullptr: before any block)
+        char* cursor = nullptr;
+        size_t used_bytes = 0;
+        size_t used_blocks = 0;
+    };
+
+    /**
+     * Rolls the arena back to where it was when the scope was opened
+     */
+    class Scope {
+    public:
+        explicit Scope(MonotonicArena& arena) : arena_(arena), checkpoint_(arena.checkpoint()) {}
+        ~Scope() { arena_.rollback(checkpoint_); }
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        MonotonicArena& arena_;
+        Checkpoint checkpoint_;
+    };
+
+    /**
+     * Constructor
+     * @param memory_source: Source for obtaining blocks from OS
+     * @param initial_block_size: Size of the first block (rounded to pages)
+     * @param max_block_size: Geometric growth stops at this block size
+     */
+    explicit MonotonicArena(MemorySource& memory_source,
+                            size_t initial_block_size = 64 * 1024,
+                            size_t max_block_size = 4 * 1024 * 1024);
+
+    ~MonotonicArena() override;
+
+    // AllocatorInterface implementation
+    void* allocate(size_t size, size_t alignment = sizeof(void*)) override;
+    void deallocate(void* ptr, size_t size = 0) override;
+    void* reallocate(void* ptr, size_t old_size, size_t new_size,
+                     size_t alignment = sizeof(void*)) override;
+    bool owns(void* ptr) const override;
+    AllocatorStats get_stats() const override;
+    void reset_stats() override;
+    const char* get_name() const override { return "MonotonicArena"; }
+    SizeClassTable size_class_stats() const { return stats_.size_classes(); }
+
+    /**
+     * Mark the current cursor position
+     */
+    Checkpoint checkpoint() const {
+        return Checkpoint{current_, cursor_, used_bytes(), used_blocks_};
+    }
+
+    /**
+     * Discard everything allocated since the checkpoint was taken
+     */
+    void rollback(const Checkpoint& checkpoint);
+
+    /**
+     * Discard every allocation; all blocks are kept for reuse
+     */
+    void reset();
+
+    /**
+     * Discard every allocation and return all blocks to the OS
+     */
+    void release();
+
+    // Monitoring
+    size_t used_bytes() const { return used_bytes_.load(std::memory_order_relaxed); } // Requested bytes since reset
+    size_t reserved_bytes() const { return reserved_bytes_; } // Bytes in all blocks
+    size_t block_count() const { return block_count_; }
+    size_t used_block_count() const { return used_blocks_; }  // Blocks up to the cursor
+    size_t page_map_overhead() const { return page_map_.memory_overhead(); }
+
+private:
+    void set_used_bytes(size_t bytes) { used_bytes_.store(bytes, std::memory_order_relaxed); }
+
+    // Block header - stored at the start of each block
+    struct Block {
+        Block* next;   // Next block in allocation order (spare blocks follow the cursor)
+        size_t size;   // Bytes in the block, header included
+    };
+
+    MemorySource& memory_source_;
+    PageMap page_map_;     // Page -> owning Block
+    size_t initial_block_size_;
+    size_t max_block_size_;
+    size_t next_block_size_;
+    Block* head_;          // First block
+    Block* current_;       // Block holding the cursor
+    char* cursor_;         // Next free byte in current_
+    char* limit_;          // End of current_
+    char* last_;           // Most recent allocation (for in-place reallocate)
+    // Single writer; relaxed so get_stats() may read it without the writer's lock
+    std::atomic<size_t> used_bytes_;
+    size_t used_blocks_;
+    size_t block_count_;
+    size_t reserved_bytes_;
+    StatsShard stats_;
+
+    void* allocate_slow(size_t size, size_t alignment);
+    Block* create_block(size_t min_size);
+    void enter_block(Block* block);
+    static char* block_begin(Block* block) { return reinterpret_cast<char*>(block + 1); }
+    static char* block_end(Block* block) { return reinterpret_cast<char*>(block) + block->size; }
+
+    // Disable copying
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+};
+
+} // namespace memplumber
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * NUMA placement through raw system calls
+ *
+ * Thin wrappers over mbind(2), set_mempolicy(2) and move_pages(2) invoked
+ * with syscall(), so there is no libnuma dependency. Topology is read from
+ * sysfs with open/read/access only: nothing here allocates, so it is safe
+ * to call while the global allocator is being constructed.
+ *
+ * On kernels without NUMA support every call fails softly: binding returns
+ * false and queries report node 0 or NO_NODE.
+ */
+namespace memplumber {
+namespace numa {
+
+constexpr int MAX_NODES = 64;  // Node masks are one unsigned long
+constexpr int NO_NODE = -1;
+
+/**
+ * How strictly memory follows the requested node
+ * - Preferred: allocate there, fall back to other nodes under pressure
+ * - Bind: allocate only there (the process may be OOM-killed instead)
+ */
+enum class Policy { Preferred, Bind };
+
+/**
+ * Number of node ids in use (highest online node + 1); 1 if unknown
+ */
+int online_nodes();
+
+/**
+ * Node of a CPU according to sysfs; 0 if unknown
+ */
+int node_of_cpu(int cpu);
+
+/**
+ * Node of every CPU below cpus, reading each node's cpulist once
+ * @param nodes: Node ids to scan, normally online_nodes()
+ * @param table: Receives the node of CPU i at index i; 0 if unknown
+ * 
+ * Costs one sysfs read per node instead of node_of_cpu()'s probes per CPU.
+ */
+void cpu_nodes(int nodes, unsigned char* table, size_t cpus);
+
+/**
+ * Apply a memory policy to a mapped range (mbind)
+ * @param ptr: Page-aligned start of the range
+ * @param size: Length in bytes
+ * @param node: Node in [0, MAX_NODES)
+ * @return: false if the kernel rejected the policy
+ * 
+ * Only pages faulted in afterwards are placed by the policy; resident
+ * pages stay where they are.
+ */
+bool bind_range(void* ptr, size_t size, int node, Policy policy);
+
+/**
+ * Set the calling thread's default policy for new pages (set_mempolicy)
+ * @param node: Node to use, or NO_NODE to restore the system default
+ */
+bool set_thread_policy(int node, Policy policy);
+
+/**
+ * Node holding the page that contains ptr (move_pages query)
+ * @return: NO_NODE if the page is not resident or the call is unsupported
+ */
+int page_node(const void* ptr);
+
+/**
+ * Count the resident pages of [ptr, ptr + size) and those on a node
+ * @param resident: Receives the number of resident pages (may be null)
+ * @return: Resident pages on node; 0 with *resident == 0 when
+ *          move_pages is unavailable
+ */
+size_t pages_on_node(const void* ptr, size_t size, int node, size_t* resident = nullptr);
+
+} // namespace numa
+} // namespace memplumber
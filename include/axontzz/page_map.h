@@ -0,0 +1,106 @@
+#pragma once
+
+#include "memory_source.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace memplumber {
+
+/**
+ * PageMap: three-level radix tree from address to metadata
+ *
+ * Maps every 4 KiB page of the 48-bit user address space to one pointer of
+ * metadata (a region descriptor, a slab header, ...). Each level consumes
+ * 12 bits of the page number, so a lookup is three dependent loads and
+ * never walks a list.
+ *
+ * Key Design Principles:
+ * - Nodes come straight from MemorySource (mmap), never from operator new,
+ *   so the map can back the global allocator itself
+ * - Nodes are created on first use and zero-filled by the kernel; only the
+ *   pages of a node that are actually written become resident
+ * - lookup() is lock-free and may run concurrently with set_range() /
+ *   clear_range() on other ranges; writers must be serialized by the caller
+ *
+ * Memory overhead: 32 KiB reserved per node; one leaf covers 16 MiB of
+ * address space, one interior node covers 64 GiB.
+ */
+class PageMap {
+public:
+    static constexpr size_t PAGE_SHIFT = 12;
+    static constexpr size_t ADDRESS_BITS = 48;
+    static constexpr size_t LEVEL_BITS = 12;
+    static constexpr size_t NODE_ENTRIES = size_t(1) << LEVEL_BITS;
+
+    explicit PageMap(MemorySource& memory_source);
+    ~PageMap();
+
+    /**
+     * Associate every page overlapping [start, start + size) with value
+     * @return: false if a node could not be allocated or the range is
+     *          outside the 48-bit address space
+     */
+    bool set_range(void* start, size_t size, void* value);
+
+    /**
+     * Forget the pages overlapping [start, start + size); nodes are kept
+     */
+    void clear_range(void* start, size_t size);
+
+    /**
+     * Metadata for the page containing ptr, or nullptr if none
+     */
+    void* lookup(const void* ptr) const {
+        uintptr_t page = reinterpret_cast<uintptr_t>(ptr) >> PAGE_SHIFT;
+        if (page >> (3 * LEVEL_BITS) != 0) {
+            return nullptr;
+        }
+        Interior* root = root_.load(std::memory_order_acquire);
+        if (root == nullptr) {
+            return nullptr;
+        }
+        Interior* middle = root->children[page >> (2 * LEVEL_BITS)].load(std::memory_order_acquire);
+        if (middle == nullptr) {
+            return nullptr;
+        }
+        Leaf* leaf = reinterpret_cast<Leaf*>(
+            middle->children[(page >> LEVEL_BITS) & (NODE_ENTRIES - 1)].load(std::memory_order_acquire));
+        if (leaf == nullptr) {
+            return nullptr;
+        }
+        return leaf->values[page & (NODE_ENTRIES - 1)].load(std::memory_order_acquire);
+    }
+
+    /**
+     * Bytes reserved from the MemorySource for radix nodes
+     */
+    size_t memory_overhead() const { return node_count_ * NODE_BYTES; }
+    size_t node_count() const { return node_count_; }
+
+private:
+    struct Interior {
+        std::atomic<Interior*> children[NODE_ENTRIES];
+    };
+
+    struct Leaf {
+        std::atomic<void*> values[NODE_ENTRIES];
+    };
+
+    static constexpr size_t NODE_BYTES = sizeof(Interior);
+    static_assert(sizeof(Leaf) == NODE_BYTES, "radix nodes must share one size");
+
+    MemorySource& memory_source_;
+    std::atomic<Interior*> root_;
+    size_t node_count_;
+
+    void* allocate_node();
+    Leaf* leaf_for(uintptr_t page, bool create);
+    void release_nodes();
+
+    // Disable copying
+    PageMap(const PageMap&) = delete;
+    PageMap& operator=(const PageMap&) = delete;
+};
+
+} // namespace memplumber
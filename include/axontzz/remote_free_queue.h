@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace memplumber {
+
+/**
+ * RemoteFreeQueue: lock-free multi-producer, single-consumer list of freed objects
+ *
+ * Threads that free an object owned by another thread's heap push it here
+ * instead of taking the heap's lock; the owning thread detaches the whole
+ * list with one exchange and frees the objects in a batch. The link is
+ * written into the freed object itself, so nothing is allocated.
+ *
+ * Key Design Principles:
+ * - push() is a CAS loop on the head; take_all() swaps the head with
+ *   nullptr, so the consumer never reads a node another thread may still
+ *   be linking and the stack has no ABA hazard
+ * - Objects come back in LIFO order; the consumer must not care
+ * - The head sits on its own cache line, away from the owner's hot fields
+ */
+class RemoteFreeQueue {
+public:
+    // Link overlaid on a freed object (objects must hold at least a pointer)
+    struct Node {
+        Node* next;
+    };
+
+    RemoteFreeQueue() : head_(nullptr) {}
+
+    /**
+     * Push a freed object (any thread)
+     */
+    void push(void* ptr) {
+        Node* node = static_cast<Node*>(ptr);
+        Node* head = head_.load(std::memory_order_relaxed);
+        do {
+            node->next = head;
+        } while (!head_.compare_exchange_weak(head, node,
+                                              std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    /**
+     * Detach every queued object (owner only)
+     * @return: Head of the detached list, linked through Node::next
+     */
+    Node* take_all() {
+        if (head_.load(std::memory_order_relaxed) == nullptr) {
+            return nullptr;
+        }
+        return head_.exchange(nullptr, std::memory_order_acquire);
+    }
+
+    bool empty() const { return head_.load(std::memory_order_relaxed) == nullptr; }
+
+private:
+    alignas(64) std::atomic<Node*> head_;
+
+    // Disable copying
+    RemoteFreeQueue(const RemoteFreeQueue&) = delete;
+    RemoteFreeQueue& operator=(const RemoteFreeQueue&) = delete;
+};
+
+} // namespace memplumber
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace memplumber {
+
+/**
+ * Scavenger: background thread that trims idle allocator memory
+ *
+ * Every interval the scavenger asks how many idle bytes (committed but not
+ * holding live allocations) the allocator has. When that exceeds
+ * idle_threshold it calls the trim callback, which should return memory to
+ * the OS until only `retain` idle bytes remain.
+ *
+ * The callbacks run on the scavenger thread, so they must take whatever
+ * lock guards the allocator, e.g.
+ *
+ *   Scavenger scavenger(
+ *       [&] { std::lock_guard<std::mutex> l(m); return heap.idle_bytes(); },
+ *       [&](size_t retain) { std::lock_guard<std::mutex> l(m); return heap.trim(retain); });
+ */
+class Scavenger {
+public:
+    struct Policy {
+        std::chrono::milliseconds interval{1000};   // Time between idle checks
+        size_t idle_threshold = 4 * 1024 * 1024;    // Trim only above this many idle bytes
+        size_t retain = 1024 * 1024;                // Idle bytes left committed by a trim
+    };
+
+    using IdleFunction = std::function<size_t()>;
+    using TrimFunction = std::function<size_t(size_t retain)>;
+
+    Scavenger(IdleFunction idle, TrimFunction trim, Policy policy);
+    Scavenger(IdleFunction idle, TrimFunction trim)
+        : Scavenger(std::move(idle), std::move(trim), Policy{}) {}
+
+    ~Scavenger();
+
+    /**
+     * Run a check now instead of waiting for the interval
+     */
+    void wake();
+
+    /**
+     * Stop and join the background thread (idempotent)
+     */
+    void stop();
+
+    size_t passes() const;          // Completed idle checks
+    size_t trims() const;           // Checks that called trim
+    size_t released_bytes() const;  // Sum of bytes reported by trim
+
+private:
+    IdleFunction idle_;
+    TrimFunction trim_;
+    Policy policy_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wakeup_;
+    bool stopping_;
+    bool woken_;
+    size_t passes_;
+    size_t trims_;
+    size_t released_bytes_;
+    std::thread thread_;
+
+    void run();
+
+    // Disable copying
+    Scavenger(const Scavenger&) = delete;
+    Scavenger& operator=(const Scavenger&) = delete;
+};
+
+} // namespace memplumber
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "allocator_interface.h"
+#include "allocation_stats.h"
+#include "memory_source.h"
+#include "page_map.h"
+#include "remote_free_queue.h"
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+namespace memplumber {
+
+/**
+ * Slab Allocator Implementation
+ *
+ * Serves objects of a single fixed size. Memory is obtained from the
+ * MemorySource in slabs (slab_size bytes, aligned to slab_size), and each
+ * slab is carved into equal slots. Because slabs are size-aligned, the slab
+ * header of any object is found by masking the object address.
+ *
+ * Key Features:
+ * - Intrusive free list of returned slots inside each slab (no side tables)
+ * - Never-used slots are handed out with a bump pointer, so a fresh slab
+ *   only touches the pages it actually serves
+ * - Slabs live on one of three lists: partial (preferred), empty, full
+ * - Empty slabs beyond max_empty_slabs are returned to the OS
+ * - Slabs are registered in a radix PageMap, so owns() is O(1)
+ *
+ * Cross-thread frees:
+ * - The allocator belongs to the thread that constructed it (see
+ *   set_owner_thread()); only that thread may allocate
+ * - deallocate() from any other thread pushes the object onto a lock-free
+ *   RemoteFreeQueue and touches no slab state, so a producer thread that
+ *   allocates and a consumer thread that frees never share a lock
+ * - The owner drains the queue in one batch at its next allocate() (or in
+ *   drain_remote_frees()); remotely freed objects stay counted as live
+ *   until then
+ *
+ * Performance Characteristics:
+ * - Allocation: O(1)
+ * - Deallocation: O(1), one CAS when freed by another thread
+ * - Space overhead: one slab header per slab, no per-object header
+ */
+class SlabAllocator : public AllocatorInterface {
+public:
+    /**
+     * Constructor
+     * @param memory_source: Source for obtaining slabs from OS
+     * @param object_size: Size of every object served by this allocator
+     * @param slab_size: Bytes per slab (rounded up to a power-of-two number of pages)
+     * @param max_empty_slabs: Empty slabs kept cached before returning them to the OS
+     */
+    SlabAllocator(MemorySource& memory_source,
+                  size_t object_size,
+                  size_t slab_size = 64 * 1024,
+                  size_t max_empty_slabs = 2);
+
+    ~SlabAllocator() override;
+
+    // AllocatorInterface implementation
+    void* allocate(size_t size, size_t alignment = sizeof(void*)) override;
+    void deallocate(void* ptr, size_t size = 0) override;
+    bool owns(void* ptr) const override;
+    AllocatorStats get_stats() const override;
+    void reset_stats() override;
+    const char* get_name() const override { return "SlabAllocator"; }
+    SizeClassTable size_class_stats() const { return stats_.size_classes(); }
+
+    // Geometry
+    size_t object_size() const { return object_size_; }
+    size_t slot_size() const { return slot_size_; }
+    size_t slot_alignment() const { return slot_alignment_; }
+    size_t slab_size() const { return slab_size_; }
+    size_t objects_per_slab() const { return objects_per_slab_; }
+
+    // Slab list sizes (for monitoring and testing)
+    size_t partial_slab_count() const { return partial_.count; }
+    size_t full_slab_count() const { return full_.count; }
+    size_t empty_slab_count() const { return empty_.count; }
+    size_t page_map_overhead() const { return page_map_.memory_overhead(); }
+
+    /**
+     * Return every cached empty slab to the OS
+     */
+    void release_empty_slabs();
+    
+    /**
+     * Hand the allocator to another thread
+     * 
+     * Only valid while no other thread is allocating or freeing; objects
+     * still on the remote-free queue are drained by the new owner.
+     */
+    void set_owner_thread(std::thread::id owner = std::this_thread::get_id()) { owner_thread_ = owner; }
+    std::thread::id owner_thread() const { return owner_thread_; }
+    
+    /**
+     * Free every object other threads have queued (owner only)
+     * @return: Objects freed
+     */
+    size_t drain_remote_frees();
+    bool has_remote_frees() const { return !remote_frees_.empty(); }
+    size_t remote_free_count() const { return remote_free_count_; } // Objects drained so far
+
+private:
+    // Slot on the intrusive free list (overlays a free object)
+    struct FreeSlot {
+        FreeSlot* next;
+    };
+
+    struct SlabList;
+
+    // Slab header - stored at the start of each slab
+    struct Slab {
+        SlabAllocator* owner;  // Allocator that carved this slab
+        Slab* next;            // Next slab in the same list
+        Slab* prev;            // Previous slab in the same list
+        SlabList* list;        // List the slab currently lives on
+        FreeSlot* free_slots;  // Returned slots
+        char* bump;            // First never-used slot
+        size_t used;           // Live objects in this slab
+    };
+
+    struct SlabList {
+        Slab* head = nullptr;
+        size_t count = 0;
+    };
+
+    MemorySource& memory_source_;
+    PageMap page_map_;   // Page -> owning Slab
+    size_t object_size_;
+    size_t slot_size_;
+    size_t slot_alignment_;
+    size_t slab_size_;
+    size_t first_slot_offset_;
+    size_t objects_per_slab_;
+    size_t max_empty_slabs_;
+    SlabList partial_;   // Some slots used, some free
+    SlabList full_;      // No free slots
+    SlabList empty_;     // No live objects
+    StatsShard stats_;
+    std::thread::id owner_thread_;
+    size_t remote_free_count_;
+    RemoteFreeQueue remote_frees_; // Objects freed by other threads
+
+    Slab* create_slab();
+    void destroy_slab(Slab* slab);
+    Slab* slab_of(void* ptr) const;
+    void free_slot(Slab* slab, void* ptr);
+    void move_to(Slab* slab, SlabList& list);
+    static void list_push(SlabList& list, Slab* slab);
+    static void list_remove(SlabList& list, Slab* slab);
+
+    // Disable copying
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+};
+
+} // namespace memplumber
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Allocator tracing
+ *
+ * Two independent, compile-time selected facilities:
+ *
+ * 1. Text trace (MP_TRACE_WARN / MP_TRACE_INFO / MP_TRACE_DEBUG)
+ *    printf-style lines written straight to stderr with write(2). Lines above
+ *    MEMPLUMBER_TRACE_LEVEL are discarded at compile time, so a release build
+ *    with level 0 contains no tracing code at all. Formatting goes through a
+ *    stack buffer, never through iostream, so tracing cannot re-enter the
+ *    global operator new.
+ *
+ * 2. Binary event ring (MP_TRACE_EVENT)
+ *    With MEMPLUMBER_TRACE_RING=1 each event is stored unformatted (type,
+ *    timestamp, thread, three integer arguments) in a fixed-size global ring
+ *    buffer. The newest RING_CAPACITY events can be copied out with
+ *    snapshot() or written to a file descriptor with dump_ring() for
+ *    post-mortem analysis.
+ *
+ * Build flags: make TRACE_LEVEL=3 TRACE_RING=1
+ */
+
+#define MEMPLUMBER_TRACE_OFF   0  // No text output
+#define MEMPLUMBER_TRACE_WARN  1  // Misuse and OS failures
+#define MEMPLUMBER_TRACE_INFO  2  // Allocator lifecycle and heap growth
+#define MEMPLUMBER_TRACE_DEBUG 3  // Every allocation, free and list operation
+
+#ifndef MEMPLUMBER_TRACE_LEVEL
+#define MEMPLUMBER_TRACE_LEVEL MEMPLUMBER_TRACE_WARN
+#endif
+
+#ifndef MEMPLUMBER_TRACE_RING
+#define MEMPLUMBER_TRACE_RING 0
+#endif
+
+namespace memplumber {
+namespace trace {
+
+/**
+ * Format one line into a stack buffer and write it to stderr
+ * (long lines are truncated)
+ */
+void write_line(const char* format, ...) __attribute__((format(printf, 1, 2)));
+
+// Binary trace event types
+enum class EventType : uint32_t {
+    Allocate,        // args: user pointer, requested size, alignment
+    AllocateFailed,  // args: requested size, alignment, 0
+    Deallocate,      // args: user pointer, requested size, block size
+    Coalesce,        // args: merged block, merged size, neighbours merged
+    ExpandHeap,      // args: region start, region size, 0
+    ReleaseSpan,     // args: span start, span size, 0
+    Reallocate,      // args: new user pointer, new requested size, old user pointer
+};
+
+struct Event {
+    uint64_t sequence;      // Global event number, increases by one per event
+    uint64_t timestamp_ns;  // CLOCK_MONOTONIC
+    EventType type;
+    uint32_t thread;        // Small per-thread id assigned on first event
+    uintptr_t args[3];
+};
+
+constexpr size_t RING_CAPACITY = 4096; // Must be a power of two
+
+/**
+ * Append an event to the ring, overwriting the oldest one when full
+ * Lock-free and allocation-free; safe to call from any thread
+ */
+void record(EventType type, uintptr_t arg0, uintptr_t arg1, uintptr_t arg2);
+
+/**
+ * Copy the retained events, oldest first
+ * @param out: Destination array
+ * @param max_events: Capacity of out
+ * @return: Number of events copied (slots being written concurrently are skipped)
+ */
+size_t snapshot(Event* out, size_t max_events);
+
+/**
+ * Number of events recorded since start (or last clear), including overwritten ones
+ */
+uint64_t recorded_events();
+
+/**
+ * Forget all events; not safe against concurrent record()
+ */
+void clear_ring();
+
+/**
+ * Write the retained events as text, one per line
+ * @param fd: Destination file descriptor
+ */
+void dump_ring(int fd);
+
+const char* event_name(EventType type);
+
+} // namespace trace
+} // namespace memplumber
+
+#define MP_TRACE(level, ...)                                   \
+    do {                                                       \
+        if constexpr ((level) <= MEMPLUMBER_TRACE_LEVEL) {     \
+            ::memplumber::trace::write_line(__VA_ARGS__);      \
+        }                                                      \
+    } while (0)
+
+#define MP_TRACE_WARN(...)  MP_TRACE(MEMPLUMBER_TRACE_WARN, __VA_ARGS__)
+#define MP_TRACE_INFO(...)  MP_TRACE(MEMPLUMBER_TRACE_INFO, __VA_ARGS__)
+#define MP_TRACE_DEBUG(...) MP_TRACE(MEMPLUMBER_TRACE_DEBUG, __VA_ARGS__)
+
+#define MP_TRACE_EVENT(type, arg0, arg1, arg2)                                      \
+    do {                                                                            \
+        if constexpr (MEMPLUMBER_TRACE_RING != 0) {                                 \
+            ::memplumber::trace::record(::memplumber::trace::EventType::type,       \
+                                        (uintptr_t)(arg0), (uintptr_t)(arg1),       \
+                                        (uintptr_t)(arg2));                         \
+        }                                                                           \
+    } while (0)
@@ -0,0 +1,79 @@
+#include "axontzz/allocation_stats.h"
+#include <cstdint>
+
+namespace memplumber {
+
+namespace {
+    size_t load(const std::atomic<size_t>& counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+}
+
+void StatsShard::merge(const StatsShard& other) {
+    add(allocation_count, load(other.allocation_count));
+    add(deallocation_count, load(other.deallocation_count));
+    add(bytes_allocated, load(other.bytes_allocated));
+    add(bytes_deallocated, load(other.bytes_deallocated));
+    add(failed_allocations, load(other.failed_allocations));
+    for (size_t cls = 0; cls < STATS_SIZE_CLASS_COUNT; ++cls) {
+        add(class_allocations[cls], load(other.class_allocations[cls]));
+        add(class_deallocations[cls], load(other.class_deallocations[cls]));
+        add(class_bytes_allocated[cls], load(other.class_bytes_allocated[cls]));
+        add(class_bytes_deallocated[cls], load(other.class_bytes_deallocated[cls]));
+    }
+}
+
+void StatsShard::add_to(AllocatorInterface::AllocatorStats& stats) const {
+    stats.allocation_count += load(allocation_count);
+    stats.deallocation_count += load(deallocation_count);
+    stats.total_allocated += load(bytes_allocated);
+    stats.total_deallocated += load(bytes_deallocated);
+    stats.failed_allocations += load(failed_allocations);
+}
+
+void StatsShard::add_to(SizeClassTable& table) const {
+    for (size_t cls = 0; cls < STATS_SIZE_CLASS_COUNT; ++cls) {
+        table[cls].allocation_count += load(class_allocations[cls]);
+        table[cls].deallocation_count += load(class_deallocations[cls]);
+        table[cls].bytes_allocated += load(class_bytes_allocated[cls]);
+        table[cls].bytes_deallocated += load(class_bytes_deallocated[cls]);
+    }
+}
+
+void StatsShard::clear() {
+    allocation_count.store(0, std::memory_order_relaxed);
+    deallocation_count.store(0, std::memory_order_relaxed);
+    bytes_allocated.store(0, std::memory_order_relaxed);
+    bytes_deallocated.store(0, std::memory_order_relaxed);
+    failed_allocations.store(0, std::memory_order_relaxed);
+    for (size_t cls = 0; cls < STATS_SIZE_CLASS_COUNT; ++cls) {
+        class_allocations[cls].store(0, std::memory_order_relaxed);
+        class_deallocations[cls].store(0, std::memory_order_relaxed);
+        class_bytes_allocated[cls].store(0, std::memory_order_relaxed);
+        class_bytes_deallocated[cls].store(0, std::memory_order_relaxed);
+    }
+}
+
+AllocatorInterface::AllocatorStats StatsShard::snapshot() const {
+    AllocatorInterface::AllocatorStats stats;
+    add_to(stats);
+    stats.current_usage = usage_from(stats);
+    return stats;
+}
+
+SizeClassTable StatsShard::size_classes() const {
+    SizeClassTable table = make_size_class_table();
+    add_to(table);
+    return table;
+}
+
+SizeClassTable make_size_class_table() {
+    SizeClassTable table{};
+    for (size_t cls = 0; cls < STATS_SIZE_CLASS_COUNT; ++cls) {
+        table[cls].max_size = size_t(16) << cls;
+    }
+    table[STATS_SIZE_CLASS_COUNT - 1].max_size = SIZE_MAX;
+    return table;
+}
+
+} // namespace memplumber
@@ -1,18 +1,62 @@
 #include "axontzz/free_list_allocator.h"
+#include "axontzz/trace.h"
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <algorithm>
 
 namespace memplumber {
 
-FreeListAllocator::FreeListAllocator(MemorySource& memory_source, size_t initial_block_size)
+namespace {
+    // 单写者计数：修改已由调用方串行化，读者无需加锁
+    void counter_add(std::atomic<size_t>& counter, size_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void counter_sub(std::atomic<size_t>& counter, size_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) - amount, std::memory_order_relaxed);
+    }
+
+    double ratio_lost(size_t part, size_t whole) {
+        return whole == 0 || part >= whole ? 0.0 : 1.0 - static_cast<double>(part) / static_cast<double>(whole);
+    }
+}
+
+FreeListAllocator::FreeListAllocator(MemorySource& memory_source,
+                                     size_t initial_block_size,
+                                     size_t large_object_threshold,
+                                     size_t max_cached_spans)
     : memory_source_(memory_source)
-    , free_list_head_(nullptr)
+    , page_map_(memory_source)
+    , bins_{}
+    , fl_bitmap_(0)
+    , sl_bitmap_{}
+    , free_block_count_(0)
+    , policy_(PlacementPolicy::GoodFit)
+    , tree_root_(nullptr)
+    , rover_(0)
     , regions_head_(nullptr)
-    , stats_{}
-    , default_block_size_(initial_block_size) {
+    , stats_()
+    , default_block_size_(initial_block_size)
+    , large_object_threshold_(large_object_threshold)
+    , max_cached_spans_(max_cached_spans)
+    , large_spans_(nullptr)
+    , span_cache_(nullptr)
+    , large_span_count_(0)
+    , cached_span_count_(0)
+    , cached_span_bytes_(0)
+    , reserved_bytes_(0)
+    , free_bytes_(0)
+    , decommitted_bytes_(0)
+    , reclaimable_bytes_(0)
+    , decommit_threshold_(DEFAULT_DECOMMIT_THRESHOLD)
+    , arena_region_(nullptr)
+    , live_requested_bytes_(0)
+    , live_block_bytes_(0)
+    , range_hook_(nullptr)
+    , range_hook_context_(nullptr) {
     
-    std::cout << "FreeListAllocator created with block size: " << initial_block_size << std::endl;
+    MP_TRACE_INFO("FreeListAllocator created with block size: %zu", initial_block_size);
     
     // 确保默认块大小足够大
     default_block_size_ = std::max(default_block_size_, 
@@ -23,16 +67,49 @@ FreeListAllocator::FreeListAllocator(MemorySource& memory_source, size_t initial
         throw std::bad_alloc();
     }
     
-    std::cout << "FreeListAllocator initialization complete" << std::endl;
+    MP_TRACE_INFO("FreeListAllocator initialization complete");
 }
 
 FreeListAllocator::~FreeListAllocator() {
-    std::cout << "FreeListAllocator destroyed" << std::endl;
+    // 归还所有大对象跨度与堆区域（包括仍有存活对象的区域）
+    while (large_spans_ != nullptr) {
+        MemoryRegion* span = large_spans_;
+        list_remove(large_spans_, span);
+        release_span(span);
+    }
+    release_cached_spans();
+    
+    // 先清空分级链表，让已退还页面的统计回到 MemorySource
+    for (size_t fl = 0; fl < FL_INDEX_COUNT; ++fl) {
+        for (size_t sl = 0; sl < SL_INDEX_COUNT; ++sl) {
+            while (bins_[fl][sl] != nullptr) {
+                remove_from_free_list(bins_[fl][sl]);
+            }
+        }
+    }
+    while (tree_root_ != nullptr) {
+        remove_from_free_list(tree_root_);
+    }
+    
+    while (regions_head_ != nullptr) {
+        MemoryRegion* region = regions_head_;
+        list_remove(regions_head_, region);
+        unmap_range(region->start, region->size);
+        memory_source_.deallocate_block(region->start, region->size);
+    }
     
-    // TODO: 在后续版本中释放所有内存区域
+    MP_TRACE_INFO("FreeListAllocator destroyed");
 }
 
 void* FreeListAllocator::allocate(size_t size, size_t alignment) {
+    return allocate_block(size, alignment, false);
+}
+
+void* FreeListAllocator::allocate_zeroed(size_t size, size_t alignment) {
+    return allocate_block(size, alignment, true);
+}
+
+void* FreeListAllocator::allocate_block(size_t size, size_t alignment, bool zero) {
     if (size == 0) {
         return nullptr;
     }
@@ -42,34 +119,50 @@ void* FreeListAllocator::allocate(size_t size, size_t alignment) {
         alignment = sizeof(void*);
     }
     
-    std::cout << "Allocating " << size << " bytes (alignment: " << alignment << ")" << std::endl;
+    // 负载加对齐填充必须可表示，否则后面计算所需块大小与扩展大小时会回绕
+    if (alignment > SIZE_MAX / 2 || size > SIZE_MAX / 2 - alignment) {
+        MP_TRACE_WARN("Allocation of %zu bytes (alignment %zu) exceeds the address space", size, alignment);
+        MP_TRACE_EVENT(AllocateFailed, size, alignment, 0);
+        stats_.record_local_failure();
+        return nullptr;
+    }
     
-    // 首先尝试从自由列表分配
-    void* ptr = allocate_from_free_list(size, alignment);
+    MP_TRACE_DEBUG("Allocating %zu bytes (alignment: %zu)", size, alignment);
     
-    if (ptr == nullptr) {
-        // 自由列表中没有合适的块，需要扩展堆
-        std::cout << "No suitable block in free list, expanding heap" << std::endl;
+    void* ptr;
+    if (large_object_threshold_ != 0 && size >= large_object_threshold_) {
+        // 大对象：绕过分级链表，直接映射独立的跨度
+        ptr = allocate_large(size, alignment, zero);
+    } else {
+        // 首先尝试从自由列表分配
+        ptr = allocate_from_free_list(size, alignment, zero);
         
-        size_t expand_size = std::max(size + alignment, default_block_size_);
-        if (!expand_heap(expand_size)) {
-            std::cout << "Failed to expand heap" << std::endl;
-            stats_.failed_allocations++;
-            return nullptr;
+        if (ptr == nullptr) {
+            // 自由列表中没有合适的块，需要扩展堆
+            MP_TRACE_DEBUG("No suitable block in free list, expanding heap");
+            
+            size_t expand_size = std::max(size + alignment, default_block_size_);
+            if (!expand_heap(expand_size)) {
+                MP_TRACE_WARN("Failed to expand heap for %zu bytes", size);
+                MP_TRACE_EVENT(AllocateFailed, size, alignment, 0);
+                stats_.record_local_failure();
+                return nullptr;
+            }
+            
+            // 扩展后再次尝试分配
+            ptr = allocate_from_free_list(size, alignment, zero);
         }
-        
-        // 扩展后再次尝试分配
-        ptr = allocate_from_free_list(size, alignment);
     }
     
     if (ptr != nullptr) {
-        stats_.total_allocated += size;
-        stats_.current_usage += size;
-        stats_.allocation_count++;
-        std::cout << "Successfully allocated " << size << " bytes at " << ptr << std::endl;
+        stats_.record_local_allocation(size);
+        counter_add(live_requested_bytes_, size);
+        MP_TRACE_DEBUG("Successfully allocated %zu bytes at %p", size, ptr);
+        MP_TRACE_EVENT(Allocate, ptr, size, alignment);
     } else {
-        stats_.failed_allocations++;
-        std::cout << "Allocation failed for " << size << " bytes" << std::endl;
+        stats_.record_local_failure();
+        MP_TRACE_WARN("Allocation failed for %zu bytes", size);
+        MP_TRACE_EVENT(AllocateFailed, size, alignment, 0);
     }
     
     return ptr;
@@ -80,47 +173,154 @@ void FreeListAllocator::deallocate(void* ptr, size_t size) {
         return;
     }
     
-    std::cout << "Deallocating " << size << " bytes at " << ptr << std::endl;
+    MP_TRACE_DEBUG("Deallocating %zu bytes at %p", size, ptr);
     
     // 验证这个指针确实属于我们
     if (!owns(ptr)) {
-        std::cout << "Warning: Attempt to deallocate pointer not owned by this allocator" << std::endl;
+        MP_TRACE_WARN("Warning: Attempt to deallocate pointer %p not owned by this allocator", ptr);
         return;
     }
-    // 读取分配头部来恢复真实的分配跨度
-    const size_t header_size = sizeof(AllocationHeader);
+    // 由负载前的字定位块起始处的边界标记；先读出请求大小，构造自由块时标记会被改写
     char* user_ptr = static_cast<char*>(ptr);
-    AllocationHeader* header = reinterpret_cast<AllocationHeader*>(user_ptr - header_size);
+    char* block_start = block_of_payload(user_ptr);
+    size_t payload = requested_size(block_start, user_ptr);
+    size_t free_size = block_size(block_start);
 
-    // 先保存头部数据，避免在构造自由块时覆盖
-    size_t payload = header->requested;
-    size_t free_size = header->span;
-    size_t saved_prefix = header->prefix_size;
-    char* free_start = reinterpret_cast<char*>(header) - saved_prefix;
-
-    // 构造自由块并回收到自由列表
-    FreeBlock* block = reinterpret_cast<FreeBlock*>(free_start);
-    block->size = free_size;
-    block->next = nullptr;
-    block->prev = nullptr;
+    if ((tag_at(block_start) & TAG_LARGE) != 0) {
+        // 大对象跨度：描述符紧挨在块之前
+        MP_TRACE_EVENT(Deallocate, ptr, payload, free_size);
+        deallocate_large(reinterpret_cast<MemoryRegion*>(block_start - sizeof(MemoryRegion)));
+        stats_.record_local_deallocation(payload);
+        counter_sub(live_requested_bytes_, payload);
+        counter_sub(live_block_bytes_, free_size);
+        return;
+    }
 
-    std::cout << "Converting allocated span back to free block at " << (void*)free_start
-              << " with size " << free_size << std::endl;
+    MP_TRACE_DEBUG("Converting allocated block at %p with size %zu back to free block",
+                   static_cast<void*>(block_start), free_size);
+    MP_TRACE_EVENT(Deallocate, ptr, payload, free_size);
 
+    // 借助边界标记与前后邻居合并，再按合并后的大小放入对应的分级链表
+    FreeBlock* block = coalesce_block(block_start, free_size);
     add_to_free_list(block);
-
-    // 尝试合并相邻的自由块
-    coalesce_free_blocks();
+    
+    // 合并出的大块：把中间的整页还给OS，块本身留在链表里
+    if (decommit_threshold_ != 0 && block_size(block) >= decommit_threshold_) {
+        decommit_block(block);
+    }
 
     // 使用真实请求大小更新统计信息
-    std::cout << "Stats before dealloc: current_usage=" << stats_.current_usage
-              << ", payload=" << payload << std::endl;
-    stats_.total_deallocated += payload;
-    stats_.current_usage -= payload;
-    stats_.deallocation_count++;
-    std::cout << "Stats after dealloc: current_usage=" << stats_.current_usage << std::endl;
+    stats_.record_local_deallocation(payload);
+    counter_sub(live_requested_bytes_, payload);
+    counter_sub(live_block_bytes_, free_size);
+    MP_TRACE_DEBUG("Returned block of %zu bytes to free list", block_size(block));
+}
 
-    std::cout << "Successfully returned block to free list" << std::endl;
+void* FreeListAllocator::reallocate(void* ptr, size_t old_size, size_t new_size, size_t alignment) {
+    if (ptr == nullptr) {
+        return allocate(new_size, alignment);
+    }
+    if (!owns(ptr)) {
+        MP_TRACE_WARN("Warning: Attempt to reallocate pointer %p not owned by this allocator", ptr);
+        return nullptr;
+    }
+    if (new_size == 0) {
+        deallocate(ptr, old_size);
+        return nullptr;
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        alignment = sizeof(void*);
+    }
+    
+    char* user_ptr = static_cast<char*>(ptr);
+    char* block_start = block_of_payload(user_ptr);
+    const size_t payload = requested_size(block_start, user_ptr);
+    const bool is_large = (tag_at(block_start) & TAG_LARGE) != 0;
+    const bool wants_large = large_object_threshold_ != 0 && new_size >= large_object_threshold_;
+    
+    // 块的种类不变且原地址满足对齐时尝试原地调整：堆内的块拆分/吸收邻居，大对象跨度用 mremap
+    char* result = nullptr;
+    if (!is_aligned(user_ptr, alignment)) {
+        // 要求更强的对齐，只能搬到新块
+    } else if (is_large && wants_large) {
+        result = reallocate_large(reinterpret_cast<MemoryRegion*>(block_start - sizeof(MemoryRegion)),
+                                  user_ptr, new_size, alignment);
+    } else if (!is_large && !wants_large && resize_in_place(block_start, user_ptr, new_size)) {
+        result = user_ptr;
+    }
+    
+    if (result != nullptr) {
+        // 跨度可能被搬走，标记按新地址重新定位
+        set_requested(block_of_payload(result), result, new_size);
+        stats_.record_local_deallocation(payload);
+        stats_.record_local_allocation(new_size);
+        counter_sub(live_requested_bytes_, payload);
+        counter_add(live_requested_bytes_, new_size);
+        MP_TRACE_DEBUG("Reallocated %p (%zu bytes) to %p (%zu bytes) without copying",
+                       ptr, payload, static_cast<void*>(result), new_size);
+        MP_TRACE_EVENT(Reallocate, result, new_size, ptr);
+        return result;
+    }
+    
+    // 无法原地调整：分配新块并复制
+    void* fresh = allocate(new_size, alignment);
+    if (fresh == nullptr) {
+        return nullptr;
+    }
+    std::memcpy(fresh, ptr, std::min(payload, new_size));
+    deallocate(ptr, payload);
+    MP_TRACE_EVENT(Reallocate, fresh, new_size, ptr);
+    return fresh;
+}
+
+bool FreeListAllocator::resize_in_place(char* block_start, char* user_ptr, size_t new_size) {
+    const size_t old_span = block_size(block_start);
+    char* block_end = block_start + old_span;
+    char* used_end = user_ptr + payload_span(new_size);
+    size_t new_span;
+    
+    if (used_end <= block_end) {
+        // 缩小（或块内余量已足够）：尾部够大时分裂成自由块，并与后继自由块合并
+        const size_t tail = static_cast<size_t>(block_end - used_end);
+        if (tail < MIN_BLOCK_SIZE) {
+            return true;
+        }
+        new_span = static_cast<size_t>(used_end - block_start);
+        tag_at(used_end) = tail | TAG_PREV_IN_USE; // 前驱是本块，只会向后合并
+        FreeBlock* block = coalesce_block(used_end, tail);
+        add_to_free_list(block);
+        if (decommit_threshold_ != 0 && block_size(block) >= decommit_threshold_) {
+            decommit_block(block);
+        }
+    } else {
+        // 增长：只有后继是足够大的自由块时才能原地完成
+        if ((tag_at(block_end) & TAG_IN_USE) != 0) {
+            return false;
+        }
+        FreeBlock* next = reinterpret_cast<FreeBlock*>(block_end);
+        char* next_end = block_end + block_size(next);
+        if (next_end < used_end) {
+            return false;
+        }
+        const size_t zeroed = next->tag & TAG_ZEROED;
+        remove_from_free_list(next);
+        const size_t rest = static_cast<size_t>(next_end - used_end);
+        if (rest >= MIN_BLOCK_SIZE) {
+            // next 的链表指针落在增长部分或被新块的头覆盖，剩余部分仍是零页
+            FreeBlock* rest_block = make_free_block(used_end, rest);
+            rest_block->tag |= zeroed;
+            add_to_free_list(rest_block);
+            new_span = static_cast<size_t>(used_end - block_start);
+        } else {
+            new_span = static_cast<size_t>(next_end - block_start);
+            set_prev_in_use(next_end, true);
+        }
+    }
+    
+    tag_at(block_start) = new_span | (tag_at(block_start) & (TAG_FLAGS | TAG_ALIGNED));
+    counter_sub(live_block_bytes_, old_span);
+    counter_add(live_block_bytes_, new_span);
+    return true;
 }
 
 bool FreeListAllocator::owns(void* ptr) const {
@@ -128,67 +328,76 @@ bool FreeListAllocator::owns(void* ptr) const {
         return false;
     }
     
-    // 检查指针是否在我们管理的任何内存区域内
-    MemoryRegion* current = regions_head_;
-    while (current != nullptr) {
-        char* region_start = static_cast<char*>(current->start);
-        char* region_end = region_start + current->size;
-        char* check_ptr = static_cast<char*>(ptr);
-        
-        if (check_ptr >= region_start && check_ptr < region_end) {
-            std::cout << "Pointer " << ptr << " is owned (in region " 
-                      << current->start << "-" << (void*)region_end << ")" << std::endl;
+    // 预留区中原地增长的区域：一次范围比较
+    if (arena_region_ != nullptr) {
+        const char* start = static_cast<const char*>(arena_region_->start);
+        if (static_cast<const char*>(ptr) >= start && static_cast<const char*>(ptr) < start + arena_region_->size) {
             return true;
         }
-        current = current->next;
     }
     
-    std::cout << "Pointer " << ptr << " is NOT owned by this allocator" << std::endl;
+    // 通过页映射直接找到指针所在的内存区域
+    const MemoryRegion* region = static_cast<const MemoryRegion*>(page_map_.lookup(ptr));
+    if (region != nullptr) {
+        MP_TRACE_DEBUG("Pointer %p is owned (in region %p-%p)",
+                       ptr, region->start, static_cast<void*>(static_cast<char*>(region->start) + region->size));
+        return true;
+    }
+    
+    MP_TRACE_DEBUG("Pointer %p is NOT owned by this allocator", ptr);
     return false;
 }
 
 FreeListAllocator::AllocatorStats FreeListAllocator::get_stats() const {
-    return stats_;
+    AllocatorStats stats = stats_.snapshot();
+    stats.fragmentation_ratio = ratio_lost(live_requested_bytes_.load(std::memory_order_relaxed),
+                                           live_block_bytes_.load(std::memory_order_relaxed));
+    return stats;
 }
 
 void FreeListAllocator::reset_stats() {
-    stats_ = AllocatorStats{};
+    stats_.clear();
 }
 
-// TODO: 在后续版本中实现这些私有方法
-void* FreeListAllocator::allocate_from_free_list(size_t size, size_t alignment) {
-    std::cout << "Trying to allocate " << size << " bytes from free list" << std::endl;
+void* FreeListAllocator::allocate_from_free_list(size_t size, size_t alignment, bool zero) {
+    MP_TRACE_DEBUG("Trying to allocate %zu bytes from free list", size);
 
     // 查找考虑头部与对齐后的合适块
     FreeBlock* block = find_suitable_block(size, alignment);
     if (block == nullptr) {
-        std::cout << "No suitable block found in free list" << std::endl;
+        MP_TRACE_DEBUG("No suitable block found in free list");
         return nullptr;
     }
 
-    // 从自由列表移除选中的块
+    // 从自由列表移除选中的块；分裂出的前缀与尾部继承零页标记
+    const size_t zeroed = block->tag & TAG_ZEROED;
     remove_from_free_list(block);
 
-    const size_t header_size = sizeof(AllocationHeader);
     char* block_start = reinterpret_cast<char*>(block);
-    char* block_end = block_start + block->size;
+    char* block_end = block_start + block_size(block);
+    if (zero && zeroed != 0) {
+        // 零页块开头的树节点字可能延伸进用户区，先清掉（之后写入的都是新块的元数据）
+        char* node_end = std::min(block_start + sizeof(TreeBlock), block_end - TAG_SIZE);
+        std::memset(block_start + sizeof(FreeBlock), 0, static_cast<size_t>(node_end - block_start) - sizeof(FreeBlock));
+    }
 
-    // 计算用户指针与头部位置
-    char* user_ptr = reinterpret_cast<char*>(align_pointer(block_start + header_size, alignment));
-    char* header_addr = user_ptr - header_size;
+    // 计算用户指针：[标记][对齐前缀][用户数据]
+    char* user_ptr = reinterpret_cast<char*>(align_pointer(block_start + TAG_SIZE, alignment));
 
-    size_t prefix_size = static_cast<size_t>(header_addr - block_start);
-    char* used_end = user_ptr + size;
+    size_t prefix_size = static_cast<size_t>(user_ptr - (block_start + TAG_SIZE));
+    char* used_end = user_ptr + payload_span(size); // 保持后续块按字长对齐，且释放后放得下自由块
     size_t suffix_size = static_cast<size_t>(block_end - used_end);
 
+    // 自由块之间不会相邻，所以选中块的前一个物理块一定不是自由块
+    bool prev_in_use = true;
+
     // 如果前缀足够大，作为自由块回收
     if (prefix_size >= MIN_BLOCK_SIZE) {
-        FreeBlock* prefix = reinterpret_cast<FreeBlock*>(block_start);
-        prefix->size = prefix_size;
-        prefix->next = prefix->prev = nullptr;
-        add_to_free_list(prefix);
-        block_start = header_addr; // 分配从头部开始
-        prefix_size = 0;
+        FreeBlock* prefix_block = make_free_block(block_start, prefix_size);
+        prefix_block->tag |= zeroed;
+        add_to_free_list(prefix_block);
+        block_start += prefix_size; // 分配从前缀之后的标记开始
+        prev_in_use = false;
     }
 
     // 默认 span 覆盖 [block_start, used_end)
@@ -196,65 +405,130 @@ void* FreeListAllocator::allocate_from_free_list(size_t size, size_t alignment)
 
     // 如果尾部足够大，分裂成自由块；否则并入此次分配
     if (suffix_size >= MIN_BLOCK_SIZE) {
-        FreeBlock* suffix = reinterpret_cast<FreeBlock*>(used_end);
-        suffix->size = suffix_size;
-        suffix->next = suffix->prev = nullptr;
-        add_to_free_list(suffix);
+        FreeBlock* suffix_block = make_free_block(used_end, suffix_size);
+        suffix_block->tag |= zeroed;
+        add_to_free_list(suffix_block);
     } else {
         span = static_cast<size_t>(block_end - block_start);
     }
 
-    // 写入分配头部
-    AllocationHeader* header = reinterpret_cast<AllocationHeader*>(header_addr);
-    header->span = span;
-    header->requested = size;
-    header->prefix_size = prefix_size;
+    // 写入边界标记（含对齐前缀与尾部余量），并告知后继块其前驱已被占用
+    tag_at(block_start) = span | TAG_IN_USE | (prev_in_use ? TAG_PREV_IN_USE : 0);
+    set_payload(block_start, user_ptr, size);
+    set_prev_in_use(block_start + span, true);
+    counter_add(live_block_bytes_, span);
+    rover_ = reinterpret_cast<uintptr_t>(block_start + span);
+    
+    if (zero) {
+        if (zeroed != 0) {
+            // 零页块的用户区里只剩原块的脚部可能非零，
+            // 它只有尾部并入本次分配时才会落在用户区内
+            char* footer = block_end - TAG_SIZE;
+            if (footer < user_ptr + size) {
+                *reinterpret_cast<size_t*>(footer) = 0;
+            }
+            zero_fill_.pristine++;
+        } else {
+            std::memset(user_ptr, 0, size);
+            zero_fill_.cleared++;
+            zero_fill_.cleared_bytes += size;
+        }
+    }
 
-    std::cout << "Write header at " << (void*)header_addr
-              << " {span=" << header->span
-              << ", requested=" << header->requested
-              << ", prefix=" << header->prefix_size << "}" << std::endl;
+    MP_TRACE_DEBUG("Write tag at %p {span=%zu, requested=%zu, prefix=%zu}",
+                   static_cast<void*>(block_start), span, size,
+                   static_cast<size_t>(user_ptr - block_start) - TAG_SIZE);
 
-    std::cout << "Allocated span=" << span << " at " << (void*)user_ptr
-              << " (requested " << size << ")" << std::endl;
+    MP_TRACE_DEBUG("Allocated span=%zu at %p (requested %zu)",
+                   span, static_cast<void*>(user_ptr), size);
     return static_cast<void*>(user_ptr);
 }
 
 void FreeListAllocator::add_to_free_list(FreeBlock* block) {
     if (block == nullptr) {
-        std::cout << "Warning: Attempted to add null block to free list" << std::endl;
+        MP_TRACE_WARN("Warning: Attempted to add null block to free list");
         return;
     }
     
-    std::cout << "Adding block " << block << " (size: " << block->size << ") to free list" << std::endl;
+    if (uses_tree(block_size(block))) {
+        tree_insert(static_cast<TreeBlock*>(block));
+    } else {
+        insert_into_bin(block);
+    }
+    
+    free_block_count_++;
+    free_bytes_ += block_size(block);
+    if ((block->tag & TAG_DECOMMITTED) == 0) {
+        reclaimable_bytes_ += decommit_length(block);
+    }
+}
+
+void FreeListAllocator::insert_into_bin(FreeBlock* block) {
+    size_t fl, sl;
+    mapping_insert(block_size(block), fl, sl);
+    
+    MP_TRACE_DEBUG("Adding block %p (size: %zu) to bin [%zu][%zu]",
+                   static_cast<void*>(block), block_size(block), fl, sl);
     
-    // 简单的头部插入策略
-    block->next = free_list_head_;
+    // 在对应分级链表头部插入
+    FreeBlock*& head = bins_[fl][sl];
+    block->next = head;
     block->prev = nullptr;
     
-    if (free_list_head_ != nullptr) {
-        free_list_head_->prev = block;
+    if (head != nullptr) {
+        head->prev = block;
     }
     
-    free_list_head_ = block;
+    head = block;
     
-    std::cout << "Free list head now: " << free_list_head_ << std::endl;
+    // 标记该分级非空
+    fl_bitmap_ |= uint64_t(1) << fl;
+    sl_bitmap_[fl] |= uint32_t(1) << sl;
 }
 
 void FreeListAllocator::remove_from_free_list(FreeBlock* block) {
     if (block == nullptr) {
-        std::cout << "Warning: Attempted to remove null block from free list" << std::endl;
+        MP_TRACE_WARN("Warning: Attempted to remove null block from free list");
         return;
     }
     
-    std::cout << "Removing block " << block << " from free list" << std::endl;
+    if (uses_tree(block_size(block))) {
+        tree_remove(static_cast<TreeBlock*>(block));
+    } else {
+        remove_from_bin(block);
+    }
+    
+    // 清理被移除块的指针
+    block->next = nullptr;
+    block->prev = nullptr;
+    free_block_count_--;
+    free_bytes_ -= block_size(block);
+    
+    // 块即将被使用或合并：已退还的页面重新计为已提交（首次访问时补页）
+    if ((block->tag & TAG_DECOMMITTED) != 0) {
+        char* begin;
+        char* end;
+        decommit_range(block, begin, end);
+        memory_source_.recommit(begin, static_cast<size_t>(end - begin));
+        decommitted_bytes_ -= static_cast<size_t>(end - begin);
+        block->tag &= ~TAG_DECOMMITTED;
+    } else {
+        reclaimable_bytes_ -= decommit_length(block);
+    }
+}
+
+void FreeListAllocator::remove_from_bin(FreeBlock* block) {
+    size_t fl, sl;
+    mapping_insert(block_size(block), fl, sl);
+    
+    MP_TRACE_DEBUG("Removing block %p from bin [%zu][%zu]", static_cast<void*>(block), fl, sl);
     
     // 更新前驱节点的next指针
     if (block->prev != nullptr) {
         block->prev->next = block->next;
     } else {
         // 这是头节点
-        free_list_head_ = block->next;
+        bins_[fl][sl] = block->next;
     }
     
     // 更新后继节点的prev指针
@@ -262,188 +536,620 @@ void FreeListAllocator::remove_from_free_list(FreeBlock* block) {
         block->next->prev = block->prev;
     }
     
-    // 清理被移除块的指针
-    block->next = nullptr;
-    block->prev = nullptr;
-    
-    std::cout << "Block removed, new head: " << free_list_head_ << std::endl;
+    // 链表清空时同步清除位图
+    if (bins_[fl][sl] == nullptr) {
+        sl_bitmap_[fl] &= ~(uint32_t(1) << sl);
+        if (sl_bitmap_[fl] == 0) {
+            fl_bitmap_ &= ~(uint64_t(1) << fl);
+        }
+    }
 }
 
 FreeListAllocator::FreeBlock* FreeListAllocator::find_suitable_block(size_t size, size_t alignment) {
-    std::cout << "Looking for block of size " << size << " with alignment " << alignment << std::endl;
+    MP_TRACE_DEBUG("Looking for block of size %zu with alignment %zu", size, alignment);
 
-    const size_t header_size = sizeof(AllocationHeader);
-    FreeBlock* current = free_list_head_;
-    while (current != nullptr) {
-        std::cout << "  Checking block at " << current << " with size " << current->size << std::endl;
+    // 最坏情况下需要的块大小：标记 + 对齐后的负载 + 对齐填充
+    const size_t padding = alignment > MIN_ALIGNMENT ? alignment - MIN_ALIGNMENT : 0;
+    const size_t needed = TAG_SIZE + payload_span(size) + padding;
+    if (policy_ != PlacementPolicy::GoodFit) {
+        return find_placement(size, alignment, needed);
+    }
 
-        char* block_start = reinterpret_cast<char*>(current);
-        char* block_end = block_start + current->size;
+    // 向上取整到分级边界：命中分级中的任意块都一定放得下
+    size_t fl, sl;
+    mapping_search(needed, fl, sl);
+    if (fl < FL_INDEX_COUNT) {
+        FreeBlock* block = search_bins(fl, sl);
+        if (block != nullptr) {
+            MP_TRACE_DEBUG("  Found block %p (size %zu) in bin [%zu][%zu]",
+                           static_cast<void*>(block), block_size(block), fl, sl);
+            return block;
+        }
+    }
 
-        char* user_ptr = reinterpret_cast<char*>(align_pointer(block_start + header_size, alignment));
-        if (user_ptr < block_end && user_ptr + size <= block_end) {
-            std::cout << "  Found suitable block at " << current << std::endl;
+    // 更大的分级都为空：只在 needed 所属的分级里逐个检查
+    mapping_insert(needed, fl, sl);
+    for (FreeBlock* current = bins_[fl][sl]; current != nullptr; current = current->next) {
+        if (block_fits(current, size, alignment)) {
+            MP_TRACE_DEBUG("  Found fitting block %p in home bin", static_cast<void*>(current));
             return current;
         }
-
-        current = current->next;
     }
 
-    std::cout << "  No suitable block found" << std::endl;
+    MP_TRACE_DEBUG("  No suitable block found");
     return nullptr;
 }
 
-void FreeListAllocator::split_block(FreeBlock* block, size_t needed_size) {
-    if (block == nullptr || needed_size == 0) {
-        std::cout << "Warning: split_block called with invalid parameters" << std::endl;
-        return;
+bool FreeListAllocator::block_fits(const FreeBlock* block, size_t size, size_t alignment) const {
+    const char* block_start = reinterpret_cast<const char*>(block);
+    const char* block_end = block_start + block_size(block);
+    const char* user_ptr = static_cast<const char*>(
+        align_pointer(const_cast<char*>(block_start) + TAG_SIZE, alignment));
+    return user_ptr < block_end &&
+           static_cast<size_t>(block_end - user_ptr) >= payload_span(size);
+}
+
+void FreeListAllocator::mapping_insert(size_t size, size_t& fl, size_t& sl) {
+    if (size < SMALL_BLOCK_SIZE) {
+        // 小块：每 8 字节一个分级
+        fl = 0;
+        sl = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+    } else {
+        const size_t msb = 63 - static_cast<size_t>(__builtin_clzll(size));
+        fl = msb - FL_INDEX_SHIFT + 1;
+        sl = (size >> (msb - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
     }
-    
-    std::cout << "Splitting block " << block << " (size " << block->size 
-              << ") to needed size " << needed_size << std::endl;
-    
-    // 检查是否值得分裂
-    if (block->size <= needed_size + MIN_BLOCK_SIZE) {
-        std::cout << "Block too small to split, keeping as is" << std::endl;
-        return;
+}
+
+void FreeListAllocator::mapping_search(size_t size, size_t& fl, size_t& sl) {
+    if (size >= SMALL_BLOCK_SIZE) {
+        const size_t msb = 63 - static_cast<size_t>(__builtin_clzll(size));
+        const size_t round = (size_t(1) << (msb - SL_INDEX_COUNT_LOG2)) - 1;
+        if (size > SIZE_MAX - round) {
+            fl = FL_INDEX_COUNT; // 超出可表示范围
+            sl = 0;
+            return;
+        }
+        size += round;
+    }
+    mapping_insert(size, fl, sl);
+}
+
+FreeListAllocator::FreeBlock* FreeListAllocator::search_bins(size_t& fl, size_t& sl) const {
+    // 先在同一一级分级中找不小于 sl 的二级分级
+    uint32_t sl_map = sl < SL_INDEX_COUNT ? sl_bitmap_[fl] & (~uint32_t(0) << sl) : 0;
+    if (sl_map == 0) {
+        // 再找更大的一级分级
+        const uint64_t fl_map = fl + 1 < 64 ? fl_bitmap_ & (~uint64_t(0) << (fl + 1)) : 0;
+        if (fl_map == 0) {
+            return nullptr;
+        }
+        fl = static_cast<size_t>(__builtin_ctzll(fl_map));
+        sl_map = sl_bitmap_[fl];
+    }
+    sl = static_cast<size_t>(__builtin_ctz(sl_map));
+    return bins_[fl][sl];
+}
+
+FreeListAllocator::FreeBlock* FreeListAllocator::find_placement(size_t size, size_t alignment, size_t needed) {
+    // 小块仍在精确大小的分级里：不小于 needed 的第一个非空分级就是最贴合的块
+    if (needed < SMALL_BLOCK_SIZE) {
+        size_t fl, sl;
+        mapping_insert(needed, fl, sl);
+        const uint32_t sl_map = sl_bitmap_[0] & (~uint32_t(0) << sl);
+        if (sl_map != 0) {
+            return bins_[0][__builtin_ctz(sl_map)];
+        }
     }
     
-    // 计算剩余部分
-    size_t remaining_size = block->size - needed_size;
-    
-    // 创建新的自由块从剩余部分
-    char* block_start = reinterpret_cast<char*>(block);
-    FreeBlock* new_block = reinterpret_cast<FreeBlock*>(block_start + needed_size);
+    TreeBlock* block = nullptr;
+    switch (policy_) {
+    case PlacementPolicy::BestFit:
+        block = tree_best_fit(size, alignment);
+        break;
+    case PlacementPolicy::NextFit:
+        // 从上次分配的末尾向高地址找，找不到再从头开始
+        block = tree_first_fit(tree_root_, needed, rover_);
+        if (block == nullptr && rover_ != 0) {
+            block = tree_first_fit(tree_root_, needed, 0);
+        }
+        break;
+    default:
+        block = tree_first_fit(tree_root_, needed, 0);
+        break;
+    }
+    MP_TRACE_DEBUG("  %s placement found %p", placement_policy_name(policy_), static_cast<void*>(block));
+    return block;
+}
+
+bool FreeListAllocator::tree_less(const TreeBlock* a, const TreeBlock* b) const {
+    if (policy_ == PlacementPolicy::BestFit && block_size(a) != block_size(b)) {
+        return block_size(a) < block_size(b);
+    }
+    return a < b;
+}
+
+void FreeListAllocator::tree_insert(TreeBlock* block) {
+    block->next = nullptr;
+    block->prev = nullptr;
+    block->left = nullptr;
+    block->right = nullptr;
+    block->max_size = block_size(block);
     
-    new_block->size = remaining_size;
-    new_block->next = nullptr;
-    new_block->prev = nullptr;
+    // 沿途的子树都将包含新块，下降时顺便更新 max_size
+    TreeBlock* parent = nullptr;
+    TreeBlock** link = &tree_root_;
+    while (*link != nullptr) {
+        parent = *link;
+        parent->max_size = std::max(parent->max_size, block->max_size);
+        link = tree_less(block, parent) ? &parent->left : &parent->right;
+    }
+    *link = block;
+    block->parent_color = reinterpret_cast<uintptr_t>(parent);
+    tree_set_red(block, true);
     
-    // 调整原块大小
-    block->size = needed_size;
+    // 红黑修复：父节点为红时按叔节点颜色重新着色或旋转
+    TreeBlock* node = block;
+    while (tree_red(tree_parent(node))) {
+        TreeBlock* up = tree_parent(node);
+        TreeBlock* grand = tree_parent(up); // 红节点不是根，一定有父节点
+        const bool up_is_left = up == grand->left;
+        TreeBlock* uncle = up_is_left ? grand->right : grand->left;
+        if (tree_red(uncle)) {
+            tree_set_red(up, false);
+            tree_set_red(uncle, false);
+            tree_set_red(grand, true);
+            node = grand;
+            continue;
+        }
+        if (node == (up_is_left ? up->right : up->left)) {
+            tree_rotate(up, up_is_left);
+            node = up;
+            up = tree_parent(node);
+        }
+        tree_set_red(up, false);
+        tree_set_red(grand, true);
+        tree_rotate(grand, !up_is_left);
+        break;
+    }
+    tree_set_red(tree_root_, false);
+}
+
+void FreeListAllocator::tree_remove(TreeBlock* block) {
+    TreeBlock* child;
+    TreeBlock* parent;
+    bool removed_black;
     
-    // 将新块添加到自由列表
-    add_to_free_list(new_block);
+    if (block->left == nullptr || block->right == nullptr) {
+        // 至多一个孩子：孩子直接顶替
+        child = block->left != nullptr ? block->left : block->right;
+        parent = tree_parent(block);
+        removed_black = !tree_red(block);
+        tree_replace_child(parent, block, child);
+        if (child != nullptr) {
+            tree_set_parent(child, parent);
+        }
+        tree_update_path(parent);
+    } else {
+        // 两个孩子：中序后继（右子树最左节点）接替位置与颜色
+        TreeBlock* heir = tree_leftmost(block->right);
+        removed_black = !tree_red(heir);
+        child = heir->right;
+        if (tree_parent(heir) == block) {
+            parent = heir;
+        } else {
+            parent = tree_parent(heir);
+            parent->left = child;
+            if (child != nullptr) {
+                tree_set_parent(child, parent);
+            }
+            heir->right = block->right;
+            tree_set_parent(heir->right, heir);
+        }
+        heir->left = block->left;
+        tree_set_parent(heir->left, heir);
+        tree_replace_child(tree_parent(block), block, heir);
+        heir->parent_color = block->parent_color;
+        tree_update_path(parent);
+    }
     
-    std::cout << "Split complete: original block " << block << " (size " << block->size 
-              << "), new block " << new_block << " (size " << new_block->size << ")" << std::endl;
+    if (removed_black) {
+        tree_remove_fixup(child, parent);
+    }
 }
 
-void FreeListAllocator::coalesce_free_blocks() {
-    std::cout << "Starting coalesce_free_blocks" << std::endl;
-    
-    if (free_list_head_ == nullptr) {
+void FreeListAllocator::tree_remove_fixup(TreeBlock* node, TreeBlock* parent) {
+    // node 所在路径少了一个黑节点（node 可以为空，parent 是它的父节点）
+    while (node != tree_root_ && !tree_red(node)) {
+        const bool is_left = node == parent->left;
+        TreeBlock* sibling = is_left ? parent->right : parent->left;
+        if (tree_red(sibling)) {
+            tree_set_red(sibling, false);
+            tree_set_red(parent, true);
+            tree_rotate(parent, is_left);
+            sibling = is_left ? parent->right : parent->left;
+        }
+        TreeBlock* near = is_left ? sibling->left : sibling->right;
+        TreeBlock* far = is_left ? sibling->right : sibling->left;
+        if (!tree_red(near) && !tree_red(far)) {
+            tree_set_red(sibling, true);
+            node = parent;
+            parent = tree_parent(node);
+            continue;
+        }
+        if (!tree_red(far)) {
+            tree_set_red(near, false);
+            tree_set_red(sibling, true);
+            tree_rotate(sibling, !is_left);
+            sibling = is_left ? parent->right : parent->left;
+            far = is_left ? sibling->right : sibling->left;
+        }
+        tree_set_red(sibling, tree_red(parent));
+        tree_set_red(parent, false);
+        tree_set_red(far, false);
+        tree_rotate(parent, is_left);
+        node = tree_root_;
+        break;
+    }
+    if (node != nullptr) {
+        tree_set_red(node, false);
+    }
+}
+
+void FreeListAllocator::tree_rotate(TreeBlock* node, bool left) {
+    // 左旋：右孩子上升为子树根；右旋对称。子树整体内容不变，max_size 随之转移
+    TreeBlock* pivot = left ? node->right : node->left;
+    TreeBlock* inner = left ? pivot->left : pivot->right;
+    if (left) {
+        node->right = inner;
+        pivot->left = node;
+    } else {
+        node->left = inner;
+        pivot->right = node;
+    }
+    if (inner != nullptr) {
+        tree_set_parent(inner, node);
+    }
+    TreeBlock* parent = tree_parent(node);
+    tree_replace_child(parent, node, pivot);
+    tree_set_parent(pivot, parent);
+    tree_set_parent(node, pivot);
+    pivot->max_size = node->max_size;
+    tree_update(node);
+}
+
+void FreeListAllocator::tree_replace_child(TreeBlock* parent, TreeBlock* old_child, TreeBlock* new_child) {
+    if (parent == nullptr) {
+        tree_root_ = new_child;
+    } else if (parent->left == old_child) {
+        parent->left = new_child;
+    } else {
+        parent->right = new_child;
+    }
+}
+
+FreeListAllocator::TreeBlock* FreeListAllocator::tree_best_fit(size_t size, size_t alignment) const {
+    // 按 (大小, 地址) 排序：找到第一个不小于最小块大小的节点，
+    // 对齐填充可能让它放不下，此时依次尝试更大的块
+    const size_t min_size = TAG_SIZE + payload_span(size);
+    TreeBlock* candidate = nullptr;
+    for (TreeBlock* node = tree_root_; node != nullptr;) {
+        if (block_size(node) >= min_size) {
+            candidate = node;
+            node = node->left;
+        } else {
+            node = node->right;
+        }
+    }
+    while (candidate != nullptr && !block_fits(candidate, size, alignment)) {
+        candidate = tree_successor(candidate);
+    }
+    return candidate;
+}
+
+FreeListAllocator::TreeBlock* FreeListAllocator::tree_first_fit(TreeBlock* node, size_t needed, uintptr_t from) {
+    // 按地址排序：地址不低于 from 且不小于 needed 的最低地址块；
+    // max_size 不足的子树整棵跳过
+    if (node == nullptr || node->max_size < needed) {
+        return nullptr;
+    }
+    if (reinterpret_cast<uintptr_t>(node) >= from) {
+        TreeBlock* found = tree_first_fit(node->left, needed, from);
+        if (found != nullptr) {
+            return found;
+        }
+        if (block_size(node) >= needed) {
+            return node;
+        }
+    }
+    return tree_first_fit(node->right, needed, from);
+}
+
+FreeListAllocator::TreeBlock* FreeListAllocator::tree_leftmost(TreeBlock* node) {
+    while (node->left != nullptr) {
+        node = node->left;
+    }
+    return node;
+}
+
+FreeListAllocator::TreeBlock* FreeListAllocator::tree_successor(TreeBlock* node) {
+    if (node->right != nullptr) {
+        return tree_leftmost(node->right);
+    }
+    TreeBlock* parent = tree_parent(node);
+    while (parent != nullptr && node == parent->right) {
+        node = parent;
+        parent = tree_parent(node);
+    }
+    return parent;
+}
+
+void FreeListAllocator::tree_update(TreeBlock* node) {
+    size_t max_size = block_size(node);
+    if (node->left != nullptr) {
+        max_size = std::max(max_size, node->left->max_size);
+    }
+    if (node->right != nullptr) {
+        max_size = std::max(max_size, node->right->max_size);
+    }
+    node->max_size = max_size;
+}
+
+void FreeListAllocator::tree_update_path(TreeBlock* node) {
+    for (; node != nullptr; node = tree_parent(node)) {
+        tree_update(node);
+    }
+}
+
+void FreeListAllocator::set_placement_policy(PlacementPolicy policy) {
+    if (policy == policy_) {
         return;
     }
     
-    bool merged = true;
-    int iterations = 0;
-    const int max_iterations = 100; // 防止无限循环
-    
-    while (merged && iterations < max_iterations) {
-        merged = false;
-        iterations++;
-        
-        // 遍历自由列表，寻找相邻的块进行合并
-        FreeBlock* current = free_list_head_;
-        while (current != nullptr) {
-            FreeBlock* next_in_list = current->next;
-            
-            // 检查当前块是否与列表中其他块相邻
-            FreeBlock* check = free_list_head_;
-            while (check != nullptr) {
-                if (check != current) {
-                    char* current_start = reinterpret_cast<char*>(current);
-                    char* current_end = current_start + current->size;
-                    char* check_start = reinterpret_cast<char*>(check);
-                    char* check_end = check_start + check->size;
-                    
-                    // 检查 current 是否紧邻 check 之后
-                    if (current_end == check_start) {
-                        std::cout << "Merging block " << current << " (size " << current->size 
-                                  << ") with block " << check << " (size " << check->size << ")" << std::endl;
-                        
-                        // 扩展 current 块包含 check 块
-                        current->size += check->size;
-                        
-                        // 从自由列表中移除 check
-                        remove_from_free_list(check);
-                        
-                        merged = true;
-                        std::cout << "Merged result: block " << current << " now has size " << current->size << std::endl;
-                        break;
-                    }
-                    
-                    // 检查 check 是否紧邻 current 之后  
-                    if (check_end == current_start) {
-                        std::cout << "Merging block " << check << " (size " << check->size 
-                                  << ") with block " << current << " (size " << current->size << ")" << std::endl;
-                        
-                        // 扩展 check 块包含 current 块
-                        check->size += current->size;
-                        
-                        // 从自由列表中移除 current
-                        remove_from_free_list(current);
-                        
-                        merged = true;
-                        std::cout << "Merged result: block " << check << " now has size " << check->size << std::endl;
-                        break;
+    // 按物理顺序取下每个自由块，换策略后重新建立索引；计数与退还状态保持不变
+    for (int pass = 0; pass < 2; ++pass) {
+        for (const MemoryRegion* region = regions_head_; region != nullptr; region = region->next) {
+            char* fencepost = static_cast<char*>(region->start) + region->size - TAG_SIZE;
+            for (char* cursor = static_cast<char*>(region->start) + sizeof(MemoryRegion); cursor < fencepost;
+                 cursor += block_size(cursor)) {
+                if ((tag_at(cursor) & TAG_IN_USE) != 0) {
+                    continue;
+                }
+                FreeBlock* block = reinterpret_cast<FreeBlock*>(cursor);
+                if (pass == 0) {
+                    if (uses_tree(block_size(block))) {
+                        tree_remove(static_cast<TreeBlock*>(block));
+                    } else {
+                        remove_from_bin(block);
                     }
+                } else if (uses_tree(block_size(block))) {
+                    tree_insert(static_cast<TreeBlock*>(block));
+                } else {
+                    insert_into_bin(block);
                 }
-                check = check->next;
             }
-            
-            if (merged) {
-                break; // 重新开始扫描
-            }
-            
-            current = next_in_list;
         }
+        if (pass == 0) {
+            policy_ = policy;
+            rover_ = 0;
+        }
+    }
+    MP_TRACE_INFO("Placement policy set to %s", placement_policy_name(policy));
+}
+
+const char* FreeListAllocator::placement_policy_name(PlacementPolicy policy) {
+    switch (policy) {
+    case PlacementPolicy::GoodFit: return "good-fit";
+    case PlacementPolicy::FirstFit: return "first-fit";
+    case PlacementPolicy::NextFit: return "next-fit";
+    case PlacementPolicy::BestFit: return "best-fit";
+    }
+    return "unknown";
+}
+
+FreeListAllocator::FreeBlock* FreeListAllocator::coalesce_block(char* block_start, size_t size, bool zeroed) {
+    MP_TRACE_DEBUG("Coalescing block %p (size %zu)", static_cast<void*>(block_start), size);
+    size_t merged = 0;
+    char* upper_junction = nullptr;
+    char* lower_junction = nullptr;
+    size_t upper_size = 0;
+    const size_t lower_size = size;
+    
+    // 后继块：区域末尾有占用状态的哨兵标记，读取总是安全的
+    char* next_start = block_start + size;
+    if ((tag_at(next_start) & TAG_IN_USE) == 0) {
+        FreeBlock* upper = reinterpret_cast<FreeBlock*>(next_start);
+        MP_TRACE_DEBUG("Merging with following block %p (size %zu)",
+                       static_cast<void*>(upper), block_size(upper));
+        zeroed = zeroed && (upper->tag & TAG_ZEROED) != 0;
+        upper_junction = next_start;
+        upper_size = block_size(upper);
+        remove_from_free_list(upper);
+        size += block_size(upper);
+        merged++;
     }
     
-    if (iterations >= max_iterations) {
-        std::cout << "Warning: coalesce_free_blocks hit iteration limit" << std::endl;
+    // 前驱块：PREV_IN_USE 为 0 时，前驱的脚部记录了它的大小
+    if ((tag_at(block_start) & TAG_PREV_IN_USE) == 0) {
+        size_t prev_size = *reinterpret_cast<size_t*>(block_start - TAG_SIZE);
+        char* prev_start = block_start - prev_size;
+        MP_TRACE_DEBUG("Merging into preceding block %p (size %zu)",
+                       static_cast<void*>(prev_start), prev_size);
+        zeroed = zeroed && (tag_at(prev_start) & TAG_ZEROED) != 0;
+        lower_junction = block_start;
+        remove_from_free_list(reinterpret_cast<FreeBlock*>(prev_start));
+        block_start = prev_start;
+        size += prev_size;
+        merged++;
     }
     
-    std::cout << "Coalesce completed after " << iterations << " iterations" << std::endl;
+    MP_TRACE_DEBUG("Coalesce result: block %p with size %zu", static_cast<void*>(block_start), size);
+    if (merged != 0) {
+        MP_TRACE_EVENT(Coalesce, block_start, size, merged);
+    }
+    FreeBlock* block = make_free_block(block_start, size);
+    if (zeroed) {
+        // 接合处残留着下方块的脚部与上方块的标记、链表指针和树节点，清掉后整块仍是零页
+        auto clear_junction = [](char* junction, size_t upper_block_size) {
+            const size_t node = std::min(sizeof(TreeBlock), upper_block_size - TAG_SIZE);
+            std::memset(junction - TAG_SIZE, 0, TAG_SIZE + node);
+        };
+        if (upper_junction != nullptr) {
+            clear_junction(upper_junction, upper_size);
+        }
+        if (lower_junction != nullptr) {
+            clear_junction(lower_junction, lower_size);
+        }
+        block->tag |= TAG_ZEROED;
+    }
+    return block;
+}
+
+FreeListAllocator::FreeBlock* FreeListAllocator::make_free_block(char* block_start, size_t size) {
+    // 自由块总是与前驱合并过，所以前驱一定不是自由块
+    FreeBlock* block = reinterpret_cast<FreeBlock*>(block_start);
+    block->tag = size | TAG_PREV_IN_USE;
+    block->next = nullptr;
+    block->prev = nullptr;
+    
+    // 脚部与后继块的 PREV_IN_USE 位
+    *reinterpret_cast<size_t*>(block_start + size - TAG_SIZE) = size;
+    set_prev_in_use(block_start + size, false);
+    return block;
+}
+
+void FreeListAllocator::set_payload(char* block_start, char* user_ptr, size_t requested) {
+    // 负载不紧跟标记时，前缀的每个字都记录负载相对块起点的偏移：
+    // 从负载向前读一个字、从块起点向后读一个字都能找到对方
+    const size_t offset = static_cast<size_t>(user_ptr - block_start);
+    if (offset != TAG_SIZE) {
+        tag_at(block_start) |= TAG_ALIGNED;
+        for (char* word = block_start + TAG_SIZE; word < user_ptr; word += sizeof(size_t)) {
+            *reinterpret_cast<size_t*>(word) = offset;
+        }
+    }
+    set_requested(block_start, user_ptr, requested);
+}
+
+void FreeListAllocator::set_requested(char* block_start, const char* user_ptr, size_t requested) {
+    if ((tag_at(block_start) & TAG_LARGE) != 0) {
+        // 跨度的余量可达数页，请求大小记在描述符里
+        reinterpret_cast<MemoryRegion*>(block_start - sizeof(MemoryRegion))->requested = requested;
+        return;
+    }
+    const size_t slack = static_cast<size_t>(block_start + block_size(block_start) - user_ptr) - requested;
+    assert(slack <= TAG_SLACK_MAX);
+    tag_at(block_start) = (tag_at(block_start) & ~TAG_SLACK_MASK) | (slack << TAG_SLACK_SHIFT);
+}
+
+bool FreeListAllocator::map_range(void* start, size_t size, MemoryRegion* region) {
+    if (!page_map_.set_range(start, size, region)) {
+        return false;
+    }
+    if (range_hook_ != nullptr && !range_hook_(range_hook_context_, start, size, true)) {
+        page_map_.clear_range(start, size);
+        return false;
+    }
+    return true;
+}
+
+void FreeListAllocator::unmap_range(void* start, size_t size) {
+    if (range_hook_ != nullptr) {
+        range_hook_(range_hook_context_, start, size, false);
+    }
+    page_map_.clear_range(start, size);
+}
+
+bool FreeListAllocator::set_range_hook(RangeHook hook, void* context) {
+    range_hook_ = hook;
+    range_hook_context_ = context;
+    if (hook == nullptr) {
+        return true;
+    }
+    
+    // 补报已经映射的区域与跨度（包括缓存中的跨度）
+    bool complete = true;
+    const MemoryRegion* lists[] = {regions_head_, large_spans_, span_cache_};
+    for (const MemoryRegion* head : lists) {
+        for (const MemoryRegion* region = head; region != nullptr; region = region->next) {
+            complete = hook(context, region->start, region->size, true) && complete;
+        }
+    }
+    return complete;
+}
+
+void FreeListAllocator::set_prev_in_use(char* block_start, bool in_use) {
+    // 后继可能是占用块，其标记会被 allocation_size() 不加锁地读取
+    if (in_use) {
+        __atomic_fetch_or(&tag_at(block_start), TAG_PREV_IN_USE, __ATOMIC_RELAXED);
+    } else {
+        __atomic_fetch_and(&tag_at(block_start), ~TAG_PREV_IN_USE, __ATOMIC_RELAXED);
+    }
 }
 
 bool FreeListAllocator::expand_heap(size_t min_size) {
-    std::cout << "Expanding heap with min_size: " << min_size << std::endl;
+    MP_TRACE_INFO("Expanding heap with min_size: %zu", min_size);
     
     // 确保请求的大小至少能容纳区域描述符和一个自由块
     size_t region_size = std::max(min_size, default_block_size_);
-    region_size = std::max(region_size, sizeof(MemoryRegion) + sizeof(FreeBlock));
+    region_size = std::max(region_size, sizeof(MemoryRegion) + MIN_BLOCK_SIZE + TAG_SIZE);
+    region_size = memory_source_.block_size_for(region_size); // 整页（或整个大页）都纳入管理
+    
+    // 有地址空间预留时优先提交预留区的下一段：紧接在上一段之后就原地扩展
+    void* new_region = nullptr;
+    if (memory_source_.has_arena()) {
+        new_region = memory_source_.commit_arena(region_size);
+        if (new_region != nullptr && arena_region_ != nullptr &&
+            static_cast<char*>(arena_region_->start) + arena_region_->size == new_region) {
+            return extend_region(arena_region_, static_cast<char*>(new_region), region_size);
+        }
+    }
     
     // 从OS获取内存
-    void* new_region = memory_source_.allocate_block(region_size);
     if (new_region == nullptr) {
-        std::cout << "Failed to allocate " << region_size << " bytes from OS" << std::endl;
+        new_region = memory_source_.allocate_block(region_size);
+    }
+    if (new_region == nullptr) {
+        MP_TRACE_WARN("Failed to allocate %zu bytes from OS", region_size);
         return false;
     }
     
-    std::cout << "Got " << region_size << " bytes from OS at " << new_region << std::endl;
+    MP_TRACE_INFO("Got %zu bytes from OS at %p", region_size, new_region);
+    reserved_bytes_ += region_size;
+    MP_TRACE_EVENT(ExpandHeap, new_region, region_size, 0);
     
     // 在区域开始处放置区域描述符
     MemoryRegion* region_desc = static_cast<MemoryRegion*>(new_region);
     region_desc->start = new_region;
     region_desc->size = region_size;
-    region_desc->next = regions_head_;
+    
+    // 在页映射中登记区域的每一页
+    if (!map_range(new_region, region_size, region_desc)) {
+        MP_TRACE_WARN("Failed to register region %p in page map", new_region);
+        memory_source_.deallocate_block(new_region, region_size);
+        reserved_bytes_ -= region_size;
+        return false;
+    }
     
     // 将新区域链接到区域列表
-    regions_head_ = region_desc;
+    list_push(regions_head_, region_desc);
+    if (memory_source_.in_arena(new_region)) {
+        arena_region_ = region_desc;
+    }
     
-    // 在区域描述符后创建自由块
+    // 区域末尾放置占用状态的哨兵标记，防止越过区域合并
     char* region_start = static_cast<char*>(new_region);
-    char* free_block_start = region_start + sizeof(MemoryRegion);
-    FreeBlock* free_block = reinterpret_cast<FreeBlock*>(free_block_start);
+    char* fencepost = region_start + region_size - TAG_SIZE;
+    tag_at(fencepost) = TAG_IN_USE;
     
-    // 设置自由块
-    free_block->size = region_size - sizeof(MemoryRegion);
-    free_block->next = nullptr;
-    free_block->prev = nullptr;
+    // 在区域描述符与哨兵之间创建自由块
+    char* free_block_start = region_start + sizeof(MemoryRegion);
+    FreeBlock* free_block = make_free_block(free_block_start,
+                                            static_cast<size_t>(fencepost - free_block_start));
+    free_block->tag |= TAG_ZEROED; // 新映射的内存由内核清零
     
-    std::cout << "Created free block at " << free_block << " with size " << free_block->size << std::endl;
+    MP_TRACE_DEBUG("Created free block at %p with size %zu",
+                   static_cast<void*>(free_block), block_size(free_block));
     
     // 将自由块添加到自由列表
     add_to_free_list(free_block);
@@ -451,10 +1157,395 @@ bool FreeListAllocator::expand_heap(size_t min_size) {
     return true;
 }
 
+bool FreeListAllocator::extend_region(MemoryRegion* region, char* chunk, size_t size) {
+    if (!map_range(chunk, size, region)) {
+        MP_TRACE_WARN("Failed to register chunk %p in page map", static_cast<void*>(chunk));
+        memory_source_.deallocate_block(chunk, size);
+        return false;
+    }
+    reserved_bytes_ += size;
+    region->size += size;
+    MP_TRACE_INFO("Extended region %p by %zu bytes to %zu", region->start, size, region->size);
+    MP_TRACE_EVENT(ExpandHeap, chunk, size, 0);
+    
+    // 旧哨兵成为新自由块的起点，新哨兵放在新段末尾；
+    // 旧哨兵保留了 PREV_IN_USE，所以末尾的自由块会跨越原区域边界合并
+    char* old_fencepost = chunk - TAG_SIZE;
+    tag_at(chunk + size - TAG_SIZE) = TAG_IN_USE;
+    add_to_free_list(coalesce_block(old_fencepost, size, true));
+    return true;
+}
+
+void* FreeListAllocator::allocate_large(size_t size, size_t alignment, bool zero) {
+    // 跨度布局：[区域描述符][标记][对齐前缀][用户数据]
+    const size_t padding = alignment > MIN_ALIGNMENT ? alignment - MIN_ALIGNMENT : 0;
+    const size_t overhead = sizeof(MemoryRegion) + TAG_SIZE + padding;
+    // 先比较开销本身，对齐接近 2^63 时减法会回绕，跨度大小随之溢出
+    if (overhead > SIZE_MAX / 2 || size > SIZE_MAX / 2 - overhead) {
+        return nullptr;
+    }
+    const size_t span_size = memory_source_.block_size_for(overhead + align_size(size, MIN_ALIGNMENT));
+    
+    MemoryRegion* span = take_cached_span(span_size);
+    const bool recycled = span != nullptr;
+    if (span == nullptr) {
+        void* memory = memory_source_.allocate_block(span_size);
+        if (memory == nullptr) {
+            MP_TRACE_WARN("Failed to map %zu byte large span", span_size);
+            return nullptr;
+        }
+        span = static_cast<MemoryRegion*>(memory);
+        span->start = memory;
+        span->size = span_size;
+        if (!map_range(memory, span_size, span)) {
+            memory_source_.deallocate_block(memory, span_size);
+            return nullptr;
+        }
+        reserved_bytes_ += span_size;
+        MP_TRACE_INFO("Mapped large span %p (%zu bytes)", memory, span_size);
+        MP_TRACE_EVENT(ExpandHeap, memory, span_size, 0);
+    }
+    list_push(large_spans_, span);
+    large_span_count_++;
+    
+    // 整个跨度是一个占用块；没有物理邻居，所以不需要哨兵
+    char* block_start = static_cast<char*>(span->start) + sizeof(MemoryRegion);
+    char* user_ptr = static_cast<char*>(align_pointer(block_start + TAG_SIZE, alignment));
+    tag_at(block_start) = (span->size - sizeof(MemoryRegion)) | TAG_IN_USE | TAG_PREV_IN_USE | TAG_LARGE;
+    set_payload(block_start, user_ptr, size);
+    counter_add(live_block_bytes_, block_size(block_start));
+    
+    // 新映射的跨度由内核清零，只有缓存中复用的跨度需要清除
+    if (zero) {
+        if (recycled) {
+            std::memset(user_ptr, 0, size);
+            zero_fill_.cleared++;
+            zero_fill_.cleared_bytes += size;
+        } else {
+            zero_fill_.pristine++;
+        }
+    }
+    
+    MP_TRACE_DEBUG("Large allocation of %zu bytes at %p (span %zu bytes)",
+                   size, static_cast<void*>(user_ptr), span->size);
+    return user_ptr;
+}
+
+void FreeListAllocator::deallocate_large(MemoryRegion* span) {
+    list_remove(large_spans_, span);
+    large_span_count_--;
+    
+    if (max_cached_spans_ == 0 || span->size > LARGE_CACHE_MAX_BYTES) {
+        release_span(span);
+        return;
+    }
+    
+    // 放入缓存头部；超出数量或字节上限时淘汰最久未用的跨度
+    list_push(span_cache_, span);
+    cached_span_count_++;
+    cached_span_bytes_ += span->size;
+    while (cached_span_count_ > max_cached_spans_ || cached_span_bytes_ > LARGE_CACHE_MAX_BYTES) {
+        MemoryRegion* oldest = span_cache_;
+        while (oldest->next != nullptr) {
+            oldest = oldest->next;
+        }
+        list_remove(span_cache_, oldest);
+        cached_span_count_--;
+        cached_span_bytes_ -= oldest->size;
+        release_span(oldest);
+    }
+}
+
+char* FreeListAllocator::reallocate_large(MemoryRegion* span, char* user_ptr,
+                                          size_t new_size, size_t alignment) {
+    char* span_start = static_cast<char*>(span->start);
+    const size_t user_offset = static_cast<size_t>(user_ptr - span_start);
+    if (new_size > SIZE_MAX / 2 - user_offset) {
+        return nullptr;
+    }
+    const size_t old_size = span->size;
+    const size_t span_size = memory_source_.block_size_for(user_offset + align_size(new_size, MIN_ALIGNMENT));
+    if (span_size == old_size) {
+        return user_ptr;
+    }
+    
+    if (span_size < old_size) {
+        // 缩小：原地截掉尾部的页（不能 mremap 的跨度就保持原大小）
+        // 先注销尾部再截断：归还的地址随时可能被别处重新映射
+        unmap_range(span_start + span_size, old_size - span_size);
+        if (memory_source_.resize_block(span_start, old_size, span_size)) {
+            set_span_size(span, span_size);
+        } else {
+            map_range(span_start + span_size, old_size - span_size, span);
+        }
+        return user_ptr;
+    }
+    
+    // 增长：先尝试原地扩展映射
+    if (memory_source_.resize_block(span_start, old_size, span_size)) {
+        if (map_range(span_start + old_size, span_size - old_size, span)) {
+            set_span_size(span, span_size);
+            return user_ptr;
+        }
+        memory_source_.resize_block(span_start, span_size, old_size);
+        return nullptr;
+    }
+    
+    // 上方的地址被占用：把页搬到新映射。新映射只保证页对齐，
+    // 且先登记好页映射，搬动成功后跨度立刻处于一致状态
+    if (alignment > memory_source_.get_page_size() ||
+        !memory_source_.can_remap(span_start, old_size, span_size)) {
+        return nullptr;
+    }
+    void* destination = memory_source_.allocate_block(span_size);
+    if (destination == nullptr) {
+        return nullptr;
+    }
+    MemoryRegion* moved = static_cast<MemoryRegion*>(destination);
+    if (!map_range(destination, span_size, moved)) {
+        memory_source_.deallocate_block(destination, span_size);
+        return nullptr;
+    }
+    list_remove(large_spans_, span);
+    unmap_range(span_start, old_size);
+    if (!memory_source_.move_block(span_start, old_size, destination, span_size)) {
+        map_range(span_start, old_size, span);
+        list_push(large_spans_, span);
+        unmap_range(destination, span_size);
+        memory_source_.deallocate_block(destination, span_size);
+        return nullptr;
+    }
+    // 描述符随页一起搬来，size 仍是旧值，由 set_span_size 统一调整
+    moved->start = destination;
+    list_push(large_spans_, moved);
+    set_span_size(moved, span_size);
+    MP_TRACE_INFO("Moved large span %p (%zu bytes) to %p (%zu bytes)",
+                  static_cast<void*>(span_start), old_size, destination, span_size);
+    return static_cast<char*>(destination) + user_offset;
+}
+
+void FreeListAllocator::set_span_size(MemoryRegion* span, size_t size) {
+    // 描述符中的 size 仍是旧值：据此调整统计，再改写描述符与块标记
+    char* block_start = static_cast<char*>(span->start) + sizeof(MemoryRegion);
+    const size_t old_block = block_size(block_start);
+    reserved_bytes_ -= span->size;
+    reserved_bytes_ += size;
+    span->size = size;
+    tag_at(block_start) = (size - sizeof(MemoryRegion)) | TAG_IN_USE | TAG_PREV_IN_USE | TAG_LARGE |
+                          (tag_at(block_start) & TAG_ALIGNED);
+    counter_sub(live_block_bytes_, old_block);
+    counter_add(live_block_bytes_, block_size(block_start));
+}
+
+FreeListAllocator::MemoryRegion* FreeListAllocator::take_cached_span(size_t min_size) {
+    // 缓存很小，直接线性查找最合适的跨度；过大的跨度不用于小请求
+    MemoryRegion* best = nullptr;
+    for (MemoryRegion* span = span_cache_; span != nullptr; span = span->next) {
+        if (span->size >= min_size && span->size / 2 < min_size &&
+            (best == nullptr || span->size < best->size)) {
+            best = span;
+        }
+    }
+    if (best != nullptr) {
+        list_remove(span_cache_, best);
+        cached_span_count_--;
+        cached_span_bytes_ -= best->size;
+        MP_TRACE_DEBUG("Reusing cached span %p (%zu bytes)", best->start, best->size);
+    }
+    return best;
+}
+
+void FreeListAllocator::release_span(MemoryRegion* span) {
+    void* start = span->start;
+    size_t size = span->size;
+    MP_TRACE_INFO("Unmapping large span %p (%zu bytes)", start, size);
+    MP_TRACE_EVENT(ReleaseSpan, start, size, 0);
+    unmap_range(start, size);
+    memory_source_.deallocate_block(start, size);
+    reserved_bytes_ -= size;
+}
+
+void FreeListAllocator::release_cached_spans() {
+    while (span_cache_ != nullptr) {
+        MemoryRegion* span = span_cache_;
+        list_remove(span_cache_, span);
+        release_span(span);
+    }
+    cached_span_count_ = 0;
+    cached_span_bytes_ = 0;
+}
+
+void FreeListAllocator::decommit_range(const FreeBlock* block, char*& begin, char*& end) const {
+    // 头部（标记、链表指针与树节点）和脚部必须保持可用，只退还两者之间的整页
+    const uintptr_t page = memory_source_.get_page_size();
+    const uintptr_t start = reinterpret_cast<uintptr_t>(block);
+    const uintptr_t first = (start + sizeof(TreeBlock) + page - 1) & ~(page - 1);
+    const uintptr_t last = (start + block_size(block) - TAG_SIZE) & ~(page - 1);
+    begin = reinterpret_cast<char*>(first);
+    end = reinterpret_cast<char*>(last > first ? last : first);
+}
+
+size_t FreeListAllocator::decommit_length(const FreeBlock* block) const {
+    char* begin;
+    char* end;
+    decommit_range(block, begin, end);
+    return static_cast<size_t>(end - begin);
+}
+
+bool FreeListAllocator::decommit_block(FreeBlock* block) {
+    if ((block->tag & TAG_DECOMMITTED) != 0) {
+        return false;
+    }
+    char* begin;
+    char* end;
+    decommit_range(block, begin, end);
+    const size_t length = static_cast<size_t>(end - begin);
+    if (length == 0 || !memory_source_.decommit(begin, length)) {
+        return false;
+    }
+    block->tag |= TAG_DECOMMITTED;
+    decommitted_bytes_ += length;
+    reclaimable_bytes_ -= length;
+    MP_TRACE_DEBUG("Decommitted %zu bytes inside free block %p", length, static_cast<void*>(block));
+    return true;
+}
+
+bool FreeListAllocator::release_region_if_empty(MemoryRegion* region) {
+    // 区域完全空闲时只包含一个从描述符延伸到哨兵的自由块
+    char* first_block = static_cast<char*>(region->start) + sizeof(MemoryRegion);
+    const size_t whole = region->size - sizeof(MemoryRegion) - TAG_SIZE;
+    if ((tag_at(first_block) & TAG_IN_USE) != 0 || block_size(first_block) != whole) {
+        return false;
+    }
+    
+    void* start = region->start;
+    const size_t size = region->size;
+    remove_from_free_list(reinterpret_cast<FreeBlock*>(first_block));
+    list_remove(regions_head_, region);
+    if (region == arena_region_) {
+        arena_region_ = nullptr;
+    }
+    unmap_range(start, size);
+    memory_source_.deallocate_block(start, size);
+    reserved_bytes_ -= size;
+    MP_TRACE_INFO("Released empty region %p (%zu bytes)", start, size);
+    MP_TRACE_EVENT(ReleaseSpan, start, size, 0);
+    return true;
+}
+
+FreeListAllocator::MemoryUsage FreeListAllocator::memory_usage() const {
+    MemoryUsage usage;
+    usage.reserved = reserved_bytes_;
+    usage.committed = reserved_bytes_ - decommitted_bytes_;
+    usage.free = free_bytes_;
+    usage.decommitted = decommitted_bytes_;
+    usage.cached_spans = cached_span_bytes_;
+    return usage;
+}
+
+size_t FreeListAllocator::huge_page_bytes() const {
+    size_t total = 0;
+    const MemoryRegion* lists[] = {regions_head_, large_spans_, span_cache_};
+    for (const MemoryRegion* head : lists) {
+        for (const MemoryRegion* region = head; region != nullptr; region = region->next) {
+            total += MemorySource::huge_page_bytes(region->start, region->size);
+        }
+    }
+    return total;
+}
+
+size_t FreeListAllocator::idle_bytes() const {
+    return reclaimable_bytes_ + cached_span_bytes_;
+}
+
+size_t FreeListAllocator::trim(size_t retain) {
+    size_t released = 0;
+    
+    // 1. 缓存的大对象跨度：整体归还
+    while (span_cache_ != nullptr && idle_bytes() > retain) {
+        MemoryRegion* oldest = span_cache_;
+        while (oldest->next != nullptr) {
+            oldest = oldest->next;
+        }
+        list_remove(span_cache_, oldest);
+        cached_span_count_--;
+        cached_span_bytes_ -= oldest->size;
+        released += oldest->size;
+        release_span(oldest);
+    }
+    
+    // 2. 完全空闲的区域：解除映射（已退还页面的空区域不占用内存，总是释放）
+    MemoryRegion* region = regions_head_;
+    while (region != nullptr) {
+        MemoryRegion* next = region->next;
+        const size_t size = region->size;
+        const bool decommitted =
+            (tag_at(static_cast<char*>(region->start) + sizeof(MemoryRegion)) & (TAG_IN_USE | TAG_DECOMMITTED)) ==
+            TAG_DECOMMITTED;
+        if ((idle_bytes() > retain || decommitted) && release_region_if_empty(region)) {
+            released += size;
+        }
+        region = next;
+    }
+    
+    // 3. 其余自由块：从最大的分级开始退还中间的整页
+    size_t min_fl, min_sl;
+    mapping_insert(memory_source_.get_page_size() + MIN_BLOCK_SIZE, min_fl, min_sl);
+    for (size_t fl = FL_INDEX_COUNT; fl-- > min_fl && idle_bytes() > retain;) {
+        for (size_t sl = SL_INDEX_COUNT; sl-- > 0 && idle_bytes() > retain;) {
+            for (FreeBlock* block = bins_[fl][sl]; block != nullptr && idle_bytes() > retain;
+                 block = block->next) {
+                const size_t before = decommitted_bytes_;
+                if (decommit_block(block)) {
+                    released += decommitted_bytes_ - before;
+                }
+            }
+        }
+    }
+    
+    // 放置树中的块（非 GoodFit 策略）：按树的顺序逐个退还，不改变树的结构
+    for (TreeBlock* block = tree_root_ != nullptr ? tree_leftmost(tree_root_) : nullptr;
+         block != nullptr && idle_bytes() > retain; block = tree_successor(block)) {
+        const size_t before = decommitted_bytes_;
+        if (decommit_block(block)) {
+            released += decommitted_bytes_ - before;
+        }
+    }
+    
+    MP_TRACE_INFO("Trim released %zu bytes, %zu idle bytes remain", released, idle_bytes());
+    return released;
+}
+
+void FreeListAllocator::list_push(MemoryRegion*& head, MemoryRegion* region) {
+    region->prev = nullptr;
+    region->next = head;
+    if (head != nullptr) {
+        head->prev = region;
+    }
+    head = region;
+}
+
+void FreeListAllocator::list_remove(MemoryRegion*& head, MemoryRegion* region) {
+    if (region->prev != nullptr) {
+        region->prev->next = region->next;
+    } else {
+        head = region->next;
+    }
+    if (region->next != nullptr) {
+        region->next->prev = region->prev;
+    }
+    region->next = nullptr;
+    region->prev = nullptr;
+}
+
 size_t FreeListAllocator::align_size(size_t size, size_t alignment) {
     return (size + alignment - 1) & ~(alignment - 1);
 }
 
+size_t FreeListAllocator::payload_span(size_t size) {
+    return std::max(align_size(size, MIN_ALIGNMENT), MIN_PAYLOAD);
+}
+
 bool FreeListAllocator::is_aligned(void* ptr, size_t alignment) {
     return (reinterpret_cast<uintptr_t>(ptr) & (alignment - 1)) == 0;
 }
@@ -466,17 +1557,268 @@ void* FreeListAllocator::align_pointer(void* ptr, size_t alignment) {
 }
 
 bool FreeListAllocator::validate_free_list() const {
-    // 暂时总是返回true
+    size_t counted = 0;
+    for (size_t fl = 0; fl < FL_INDEX_COUNT; ++fl) {
+        for (size_t sl = 0; sl < SL_INDEX_COUNT; ++sl) {
+            const FreeBlock* head = bins_[fl][sl];
+            
+            // 位图必须与链表是否为空一致
+            const bool sl_bit = (sl_bitmap_[fl] >> sl) & 1u;
+            if (sl_bit != (head != nullptr)) {
+                return false;
+            }
+            
+            const FreeBlock* prev = nullptr;
+            for (const FreeBlock* block = head; block != nullptr; block = block->next) {
+                size_t block_fl, block_sl;
+                mapping_insert(block_size(block), block_fl, block_sl);
+                if (block->prev != prev || block_fl != fl || block_sl != sl ||
+                    (block->tag & TAG_IN_USE) != 0 || uses_tree(block_size(block)) ||
+                    !owns(const_cast<FreeBlock*>(block))) {
+                    return false;
+                }
+                prev = block;
+                counted++;
+            }
+        }
+        const bool fl_bit = (fl_bitmap_ >> fl) & 1u;
+        if (fl_bit != (sl_bitmap_[fl] != 0)) {
+            return false;
+        }
+    }
+    
+    // 放置树：有序性、父指针、红黑性质与 max_size
+    size_t black_height = 0;
+    if (tree_red(tree_root_) || !validate_tree(tree_root_, nullptr, black_height, counted)) {
+        return false;
+    }
+    if (counted != free_block_count_) {
+        return false;
+    }
+    
+    size_t free_total = 0;
+    size_t decommitted_total = 0;
+    size_t reclaimable_total = 0;
+    
+    // 按物理顺序遍历每个区域，检查边界标记
+    size_t physical_free = 0;
+    for (const MemoryRegion* region = regions_head_; region != nullptr; region = region->next) {
+        char* cursor = static_cast<char*>(region->start) + sizeof(MemoryRegion);
+        char* fencepost = static_cast<char*>(region->start) + region->size - TAG_SIZE;
+        bool prev_free = false;
+        while (cursor < fencepost) {
+            const size_t tag = tag_at(cursor);
+            const size_t size = tag & TAG_SIZE_MASK;
+            const bool is_free = (tag & TAG_IN_USE) == 0;
+            if (size < MIN_BLOCK_SIZE || size > static_cast<size_t>(fencepost - cursor) ||
+                ((tag & TAG_PREV_IN_USE) != 0) == prev_free) {
+                return false;
+            }
+            if (is_free) {
+                // 相邻自由块说明合并遗漏；脚部必须与标记一致
+                if (prev_free || *reinterpret_cast<size_t*>(cursor + size - TAG_SIZE) != size) {
+                    return false;
+                }
+                physical_free++;
+                free_total += size;
+                const size_t length = decommit_length(reinterpret_cast<const FreeBlock*>(cursor));
+                if ((tag & TAG_DECOMMITTED) != 0) {
+                    decommitted_total += length;
+                } else {
+                    reclaimable_total += length;
+                }
+            } else {
+                // 占用块：负载与标记能互相找到，余量不超出负载之后的部分
+                const char* user_ptr = payload_of_block(cursor);
+                if (user_ptr >= cursor + size || block_of_payload(user_ptr) != cursor ||
+                    ((tag & TAG_SLACK_MASK) >> TAG_SLACK_SHIFT) > static_cast<size_t>(cursor + size - user_ptr)) {
+                    return false;
+                }
+            }
+            prev_free = is_free;
+            cursor += size;
+        }
+        const size_t fence_tag = tag_at(fencepost);
+        if (cursor != fencepost || (fence_tag & TAG_IN_USE) == 0 ||
+            ((fence_tag & TAG_PREV_IN_USE) != 0) == prev_free) {
+            return false;
+        }
+    }
+    return physical_free == free_block_count_ && free_total == free_bytes_ &&
+           decommitted_total == decommitted_bytes_ && reclaimable_total == reclaimable_bytes_;
+}
+
+size_t FreeListAllocator::region_count() const {
+    size_t count = 0;
+    for (const MemoryRegion* region = regions_head_; region != nullptr; region = region->next) {
+        count++;
+    }
+    return count;
+}
+
+bool FreeListAllocator::validate_tree(const TreeBlock* node, const TreeBlock* parent,
+                                      size_t& black_height, size_t& count) const {
+    if (node == nullptr) {
+        black_height = 1;
+        return true;
+    }
+    if (tree_parent(node) != parent || (node->tag & TAG_IN_USE) != 0 || !uses_tree(block_size(node)) ||
+        !owns(const_cast<TreeBlock*>(node))) {
+        return false;
+    }
+    if (tree_red(node) && (tree_red(node->left) || tree_red(node->right))) {
+        return false;
+    }
+    if ((node->left != nullptr && !tree_less(node->left, node)) ||
+        (node->right != nullptr && !tree_less(node, node->right))) {
+        return false;
+    }
+    size_t left_height, right_height;
+    if (!validate_tree(node->left, node, left_height, count) ||
+        !validate_tree(node->right, node, right_height, count) || left_height != right_height) {
+        return false;
+    }
+    size_t max_size = block_size(node);
+    max_size = std::max(max_size, node->left != nullptr ? node->left->max_size : 0);
+    max_size = std::max(max_size, node->right != nullptr ? node->right->max_size : 0);
+    if (node->max_size != max_size) {
+        return false;
+    }
+    black_height = left_height + (tree_red(node) ? 0 : 1);
+    count++;
     return true;
 }
 
+size_t FreeListAllocator::largest_free_block() const {
+    // 放置树的块都不小于 SMALL_BLOCK_SIZE，根节点记录了其中最大的块
+    if (tree_root_ != nullptr) {
+        return tree_root_->max_size;
+    }
+    if (fl_bitmap_ == 0) {
+        return 0;
+    }
+    
+    // 最大的块一定在最高的非空分级里
+    const size_t fl = 63 - static_cast<size_t>(__builtin_clzll(fl_bitmap_));
+    const size_t sl = 31 - static_cast<size_t>(__builtin_clz(sl_bitmap_[fl]));
+    size_t largest = 0;
+    for (const FreeBlock* block = bins_[fl][sl]; block != nullptr; block = block->next) {
+        largest = std::max(largest, block_size(block));
+    }
+    return largest;
+}
+
+FreeListAllocator::Fragmentation FreeListAllocator::fragmentation() const {
+    Fragmentation result;
+    result.requested = live_requested_bytes_.load(std::memory_order_relaxed);
+    result.allocated = live_block_bytes_.load(std::memory_order_relaxed);
+    result.internal = ratio_lost(result.requested, result.allocated);
+    result.free = free_bytes_;
+    result.largest_free = largest_free_block();
+    result.external = ratio_lost(result.largest_free, result.free);
+    return result;
+}
+
+void FreeListAllocator::export_heap_map(std::ostream& out) const {
+    const MemoryUsage usage = memory_usage();
+    const Fragmentation frag = fragmentation();
+    out << "{\"allocator\":\"" << get_name() << "\",\"summary\":{"
+        << "\"reserved\":" << usage.reserved
+        << ",\"committed\":" << usage.committed
+        << ",\"free\":" << usage.free
+        << ",\"decommitted\":" << usage.decommitted
+        << ",\"cached_spans\":" << usage.cached_spans
+        << ",\"requested\":" << frag.requested
+        << ",\"allocated\":" << frag.allocated
+        << ",\"largest_free\":" << frag.largest_free
+        << ",\"internal_fragmentation\":" << frag.internal
+        << ",\"external_fragmentation\":" << frag.external
+        << ",\"free_blocks\":" << free_block_count_ << "},\n\"regions\":[";
+    
+    // 按物理顺序输出每个区域的块；偏移相对于区域起点
+    bool first_region = true;
+    for (const MemoryRegion* region = regions_head_; region != nullptr; region = region->next) {
+        char* base = static_cast<char*>(region->start);
+        char* fencepost = base + region->size - TAG_SIZE;
+        out << (first_region ? "\n" : ",\n") << "{\"address\":" << reinterpret_cast<uintptr_t>(base)
+            << ",\"size\":" << region->size
+            << ",\"arena\":" << (region == arena_region_ ? "true" : "false") << ",\"blocks\":[";
+        first_region = false;
+        bool first_block = true;
+        for (char* cursor = base + sizeof(MemoryRegion); cursor < fencepost; cursor += block_size(cursor)) {
+            const size_t tag = tag_at(cursor);
+            out << (first_block ? "" : ",") << "{\"offset\":" << (cursor - base)
+                << ",\"size\":" << (tag & TAG_SIZE_MASK);
+            if ((tag & TAG_IN_USE) != 0) {
+                out << ",\"state\":\"used\",\"requested\":" << requested_size(cursor, payload_of_block(cursor)) << "}";
+            } else {
+                out << ",\"state\":\"free\",\"decommitted\":"
+                    << ((tag & TAG_DECOMMITTED) != 0 ? "true" : "false") << ",\"zeroed\":"
+                    << ((tag & TAG_ZEROED) != 0 ? "true" : "false") << "}";
+            }
+            first_block = false;
+        }
+        out << "]}";
+    }
+    
+    out << "],\n\"large_spans\":[";
+    for (const MemoryRegion* span = large_spans_; span != nullptr; span = span->next) {
+        out << (span == large_spans_ ? "" : ",") << "{\"address\":" << reinterpret_cast<uintptr_t>(span->start)
+            << ",\"size\":" << span->size << ",\"requested\":" << span->requested << "}";
+    }
+    out << "],\n\"cached_spans\":[";
+    for (const MemoryRegion* span = span_cache_; span != nullptr; span = span->next) {
+        out << (span == span_cache_ ? "" : ",") << "{\"address\":" << reinterpret_cast<uintptr_t>(span->start)
+            << ",\"size\":" << span->size << "}";
+    }
+    out << "]}\n";
+}
+
 void FreeListAllocator::dump_free_list() const {
-    std::cout << "=== Free List Dump (Basic Version) ===" << std::endl;
+    std::cout << "=== Free List Dump (Size-Class Bins) ===" << std::endl;
+    const AllocatorStats stats = stats_.snapshot();
     std::cout << "Current stats:" << std::endl;
-    std::cout << "  Total allocated: " << stats_.total_allocated << " bytes" << std::endl;
-    std::cout << "  Current usage: " << stats_.current_usage << " bytes" << std::endl;
-    std::cout << "  Allocations: " << stats_.allocation_count << std::endl;
-    std::cout << "  Deallocations: " << stats_.deallocation_count << std::endl;
+    std::cout << "  Total allocated: " << stats.total_allocated << " bytes" << std::endl;
+    std::cout << "  Current usage: " << stats.current_usage << " bytes" << std::endl;
+    std::cout << "  Allocations: " << stats.allocation_count << std::endl;
+    std::cout << "  Deallocations: " << stats.deallocation_count << std::endl;
+    std::cout << "  Free blocks: " << free_block_count_ << std::endl;
+    std::cout << "  Page map overhead: " << page_map_.memory_overhead() << " bytes ("
+              << page_map_.node_count() << " nodes)" << std::endl;
+    std::cout << "  Reserved: " << reserved_bytes_ << " bytes, committed: "
+              << reserved_bytes_ - decommitted_bytes_ << " bytes (" << decommitted_bytes_
+              << " decommitted in free blocks)" << std::endl;
+    std::cout << "  Large spans: " << large_span_count_ << " live, "
+              << cached_span_count_ << " cached (" << cached_span_bytes_ << " bytes)" << std::endl;
+    const Fragmentation frag = fragmentation();
+    std::cout << "  Internal fragmentation: " << frag.internal * 100.0 << "% ("
+              << frag.requested << " requested in " << frag.allocated << " block bytes)" << std::endl;
+    std::cout << "  External fragmentation: " << frag.external * 100.0 << "% (largest free "
+              << frag.largest_free << " of " << frag.free << " free bytes)" << std::endl;
+    for (size_t fl = 0; fl < FL_INDEX_COUNT; ++fl) {
+        for (size_t sl = 0; sl < SL_INDEX_COUNT; ++sl) {
+            size_t count = 0;
+            size_t bytes = 0;
+            for (const FreeBlock* block = bins_[fl][sl]; block != nullptr; block = block->next) {
+                count++;
+                bytes += block_size(block);
+            }
+            if (count != 0) {
+                std::cout << "  Bin [" << fl << "][" << sl << "]: " << count
+                          << " blocks, " << bytes << " bytes" << std::endl;
+            }
+        }
+    }
+    if (tree_root_ != nullptr) {
+        size_t count = 0;
+        size_t bytes = 0;
+        for (TreeBlock* block = tree_leftmost(tree_root_); block != nullptr; block = tree_successor(block)) {
+            count++;
+            bytes += block_size(block);
+        }
+        std::cout << "  " << placement_policy_name(policy_) << " tree: " << count << " blocks, "
+                  << bytes << " bytes, largest " << tree_root_->max_size << std::endl;
+    }
     std::cout << "===================================" << std::endl;
 }
 
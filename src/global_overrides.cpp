@@ -1,53 +1,748 @@
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <mutex>
 #include <new>
+#include <ostream>
+#include <sched.h>
+#include <streambuf>
+#include <unistd.h>
+#include "axontzz/allocation_stats.h"
 #include "axontzz/free_list_allocator.h"
 #include "axontzz/memory_source.h"
+#include "axontzz/numa.h"
+#include "axontzz/page_map.h"
 
 namespace {
-    // 全局分配器实例 - 使用静态初始化确保线程安全
+    // 小对象尺寸分级：128 字节以内按 16 字节递增，之后每个2的幂分 4 级，最大 1024 字节
+    constexpr std::size_t kClassSizes[] = {
+        16, 32, 48, 64, 80, 96, 112, 128,
+        160, 192, 224, 256,
+        320, 384, 448, 512,
+        640, 768, 896, 1024,
+    };
+    constexpr std::size_t kNumSizeClasses = sizeof(kClassSizes) / sizeof(kClassSizes[0]);
+    constexpr std::size_t kMaxCachedSize = kClassSizes[kNumSizeClasses - 1];
+
+    // operator new(size_t) 必须按 __STDCPP_DEFAULT_NEW_ALIGNMENT__ 对齐；更大的对齐走 align_val_t 重载
+    constexpr std::size_t kDefaultAlignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+    // 以 16 字节为步长的查找表：(size + 15) / 16 -> 尺寸分级
+    struct ClassLookup {
+        std::uint8_t index[kMaxCachedSize / 16 + 1];
+
+        constexpr ClassLookup() : index{} {
+            std::size_t cls = 0;
+            for (std::size_t slot = 0; slot <= kMaxCachedSize / 16; ++slot) {
+                while (kClassSizes[cls] < slot * 16) {
+                    ++cls;
+                }
+                index[slot] = static_cast<std::uint8_t>(cls);
+            }
+        }
+    };
+    constexpr ClassLookup kClassLookup;
+
+    inline std::size_t size_class_of(std::size_t size) {
+        return kClassLookup.index[(size + 15) >> 4];
+    }
+
+    // 每次与共享堆交换的对象数：小对象多取，大对象少取
+    inline std::uint32_t batch_size(std::size_t cls) {
+        std::size_t batch = 4096 / kClassSizes[cls];
+        return static_cast<std::uint32_t>(batch < 4 ? 4 : (batch > 32 ? 32 : batch));
+    }
+
+    struct CachedObject {
+        CachedObject* next;
+    };
+
+    // 分配区个数上限（AXONTZZ_ARENAS 与 CPU 数都截断到这里）
+    constexpr std::size_t kMaxArenas = 64;
+    // CPU -> NUMA 节点表的大小；编号更大的 CPU 取模查表
+    constexpr std::size_t kMaxCpus = 1024;
+
+    // 定长缓冲、直接 write(2) 的流缓冲区，不做任何堆分配
+    class FdStreambuf : public std::streambuf {
+    public:
+        explicit FdStreambuf(int fd) : fd_(fd) { setp(buffer_, buffer_ + sizeof(buffer_)); }
+        ~FdStreambuf() override { sync(); }
+        bool failed() const { return failed_; }
+
+    protected:
+        int_type overflow(int_type ch) override {
+            if (sync() != 0) {
+                return traits_type::eof();
+            }
+            if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+                *pptr() = traits_type::to_char_type(ch);
+                pbump(1);
+            }
+            return traits_type::not_eof(ch);
+        }
+
+        int sync() override {
+            const char* cursor = pbase();
+            while (cursor < pptr()) {
+                ssize_t written = ::write(fd_, cursor, static_cast<std::size_t>(pptr() - cursor));
+                if (written <= 0) {
+                    failed_ = true;
+                    break;
+                }
+                cursor += written;
+            }
+            setp(buffer_, buffer_ + sizeof(buffer_));
+            return failed_ ? -1 : 0;
+        }
+
+    private:
+        int fd_;
+        bool failed_ = false;
+        char buffer_[4096];
+    };
+
+    /**
+     * Per-thread cache of small objects
+     *
+     * Trivially constructible and destructible so the thread_local needs no
+     * guard on access; cleanup at thread exit is done by ThreadCacheGuard.
+     * Cached objects are live FreeListAllocator allocations of exactly the
+     * class size; a thread may cache objects of any arena, and they go
+     * back to whichever arena owns them.
+     */
+    struct ThreadCache {
+        enum State : std::uint8_t { Uninitialized = 0, Registering, Active, Dead };
+
+        CachedObject* heads[kNumSizeClasses];
+        std::uint32_t counts[kNumSizeClasses];
+        State state;
+        std::uint32_t arena;          // Arena index assigned at registration (round-robin)
+        ThreadCache* next;            // Registry links (protected by registry mutex)
+        ThreadCache* prev;
+        memplumber::StatsShard counters; // Single writer: only the owning thread updates
+    };
+
+    thread_local ThreadCache tcache;
+
+    /**
+     * Global allocator instance behind operator new/delete and malloc
+     *
+     * The shared heap is split into arenas, each with its own lock,
+     * MemorySource and FreeListAllocator. A thread allocates from the arena
+     * assigned to it when it registered (round-robin), or from the arena of
+     * the CPU it is running on with AXONTZZ_ARENA_SELECT=cpu, so threads
+     * refilling their caches at the same time mostly take different locks.
+     * AXONTZZ_ARENAS sets the arena count (default: one per online CPU).
+     *
+     * On a multi-node machine (or with AXONTZZ_ARENA_SELECT=node) arena i
+     * belongs to NUMA node i % nodes and its source binds every mapping to
+     * that node; a thread uses one of the arenas of the node it is running
+     * on. AXONTZZ_NUMA_NODES=N simulates N nodes by CPU number, binding
+     * logical node k to real node k % online nodes.
+     *
+     * Every range an arena maps is recorded in arena_map_ through the
+     * allocator's range hook, so a free from any thread finds the owning
+     * arena with one lock-free page map lookup; objects never migrate
+     * between arenas.
+     */
     class GlobalAllocatorManager {
     public:
         static GlobalAllocatorManager& instance() {
-            static GlobalAllocatorManager instance;
-            return instance;
+            // 永不析构：静态析构阶段仍可能有 delete 调用，堆区域必须保持映射
+            alignas(GlobalAllocatorManager) static unsigned char storage[sizeof(GlobalAllocatorManager)];
+            static GlobalAllocatorManager* instance = new (storage) GlobalAllocatorManager();
+            return *instance;
+        }
+
+        /**
+         * Invariant relied on by sized delete: every allocation of at most
+         * kMaxCachedSize bytes with default alignment has exactly its class
+         * size as usable size, whether it came from a thread cache or (for
+         * a thread that is exiting) straight from the shared heap.
+         */
+        void* allocate(std::size_t size, std::size_t alignment = kDefaultAlignment) {
+            ThreadCache* cache = local_cache();
+
+            if (size <= kMaxCachedSize && alignment <= kDefaultAlignment) {
+                std::size_t cls = size_class_of(size);
+                size = kClassSizes[cls];
+                if (cache == nullptr) {
+                    return allocate_from_heap(nullptr, size, kDefaultAlignment);
+                }
+
+                // 小对象：无锁地从线程缓存分配，缓存为空时批量补充
+                CachedObject* object = cache->heads[cls];
+                if (object == nullptr) {
+                    object = refill(*cache, cls);
+                    if (object == nullptr) {
+                        cache->counters.record_local_failure();
+                        return nullptr;
+                    }
+                }
+                cache->heads[cls] = object->next;
+                cache->counts[cls]--;
+                cache->counters.record_local_allocation(size);
+                return object;
+            }
+
+            return allocate_from_heap(cache, size, alignment < kDefaultAlignment ? kDefaultAlignment : alignment);
+        }
+
+        /**
+         * calloc semantics: cached classes are recycled memory and are
+         * cleared here, larger blocks come from the heap, which skips the
+         * memset for blocks that are still untouched kernel pages
+         */
+        void* allocate_zeroed(std::size_t size, std::size_t alignment = kDefaultAlignment) {
+            if (size <= kMaxCachedSize && alignment <= kDefaultAlignment) {
+                void* ptr = allocate(size, alignment);
+                if (ptr != nullptr) {
+                    std::memset(ptr, 0, size);
+                }
+                return ptr;
+            }
+            return allocate_from_heap(local_cache(), size,
+                                      alignment < kDefaultAlignment ? kDefaultAlignment : alignment, true);
+        }
+
+        // 共享堆分配（加锁），计入线程或 retired_ 计数
+        void* allocate_from_heap(ThreadCache* cache, std::size_t size, std::size_t alignment,
+                                 bool zeroed = false) {
+            Arena& arena = arena_for(cache);
+            void* ptr;
+            {
+                std::lock_guard<std::mutex> lock(arena.mutex);
+                ptr = zeroed ? arena.allocator.allocate_zeroed(size, alignment)
+                             : arena.allocator.allocate(size, alignment);
+            }
+            if (ptr == nullptr) {
+                if (cache != nullptr) {
+                    cache->counters.record_local_failure();
+                } else {
+                    retired_.record_failure();
+                }
+            } else if (cache != nullptr) {
+                cache->counters.record_local_allocation(size);
+            } else {
+                retired_.record_allocation(size);
+            }
+            return ptr;
         }
-        
-        void* allocate(std::size_t size, std::size_t alignment = sizeof(void*)) {
-            std::lock_guard<std::mutex> lock(mutex_);
-            return allocator_.allocate(size, alignment);
+
+        /**
+         * Sized delete of a default-aligned allocation: a small size maps
+         * straight to its class (see allocate), so the object goes back to
+         * the thread cache without reading its allocation header
+         */
+        void deallocate_sized(void* ptr, std::size_t size) {
+            if (ptr == nullptr) return;
+
+            ThreadCache* cache = local_cache();
+            if (cache != nullptr && size != 0 && size <= kMaxCachedSize) {
+                cache_object(*cache, ptr, size_class_of(size));
+                return;
+            }
+            deallocate_unsized(cache, ptr);
         }
-        
-        void deallocate(void* ptr, std::size_t size = 0) {
+
+        void deallocate(void* ptr) {
             if (ptr == nullptr) return;
-            
-            std::lock_guard<std::mutex> lock(mutex_);
-            allocator_.deallocate(ptr, size);
+            deallocate_unsized(local_cache(), ptr);
+        }
+
+        /**
+         * realloc semantics for a live, non-null pointer and non-zero size
+         *
+         * Thread-cached objects must keep their class size, so only blocks
+         * above kMaxCachedSize on both sides are resized by the heap (in
+         * place where possible); smaller ones stay put when shrinking by
+         * at most half and are copied otherwise.
+         */
+        void* reallocate(void* ptr, std::size_t size) {
+            Arena* arena = arena_of(ptr);
+            if (arena == nullptr) {
+                return nullptr;
+            }
+            std::size_t usable = arena->allocator.allocation_size(ptr);
+            if (usable > kMaxCachedSize && size > kMaxCachedSize) {
+                // 在所属分配区内调整（必要时在那里搬移）
+                void* result;
+                {
+                    std::lock_guard<std::mutex> lock(arena->mutex);
+                    result = arena->allocator.reallocate(ptr, usable, size, kDefaultAlignment);
+                }
+                if (result != nullptr) {
+                    ThreadCache* cache = local_cache();
+                    if (cache != nullptr) {
+                        cache->counters.record_local_deallocation(usable);
+                        cache->counters.record_local_allocation(size);
+                    } else {
+                        retired_.record_deallocation(usable);
+                        retired_.record_allocation(size);
+                    }
+                }
+                return result;
+            }
+
+            if (size <= usable && size >= usable / 2) {
+                return ptr;
+            }
+            void* fresh = allocate(size);
+            if (fresh == nullptr) {
+                return nullptr;
+            }
+            std::memcpy(fresh, ptr, size < usable ? size : usable);
+            deallocate(ptr);
+            return fresh;
+        }
+
+    private:
+        // 大小从分配头部读取；只有恰好为分级大小的块才进入线程缓存
+        void deallocate_unsized(ThreadCache* cache, void* ptr) {
+            Arena* arena = arena_of(ptr);
+            if (arena == nullptr) {
+                return; // 不是本分配器的指针
+            }
+            std::size_t usable = arena->allocator.allocation_size(ptr);
+
+            if (cache != nullptr && usable <= kMaxCachedSize) {
+                std::size_t cls = size_class_of(usable);
+                if (kClassSizes[cls] == usable) {
+                    cache_object(*cache, ptr, cls);
+                    return;
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(arena->mutex);
+                arena->allocator.deallocate(ptr, usable);
+            }
+            if (cache != nullptr) {
+                cache->counters.record_local_deallocation(usable);
+            } else {
+                retired_.record_deallocation(usable);
+            }
         }
-        
+
+        // 放回线程缓存；缓存过多时归还一批给共享堆
+        void cache_object(ThreadCache& cache, void* ptr, std::size_t cls) {
+            CachedObject* object = static_cast<CachedObject*>(ptr);
+            object->next = cache.heads[cls];
+            cache.heads[cls] = object;
+            cache.counts[cls]++;
+            cache.counters.record_local_deallocation(kClassSizes[cls]);
+
+            if (cache.counts[cls] > 2 * batch_size(cls)) {
+                flush(cache, cls, batch_size(cls));
+            }
+        }
+
+    public:
         bool owns(void* ptr) const {
-            std::lock_guard<std::mutex> lock(mutex_);
-            return allocator_.owns(ptr);
+            return arena_of(ptr) != nullptr;
+        }
+
+        std::size_t arena_count() const {
+            return arena_count_;
+        }
+
+        std::size_t numa_nodes() const {
+            return numa_nodes_;
+        }
+
+        // 调用线程当前所在的（逻辑）节点
+        int current_node() const {
+            int cpu = sched_getcpu();
+            return cpu_node_[cpu > 0 ? static_cast<std::size_t>(cpu) % kMaxCpus : 0];
+        }
+
+        // 指针所属分配区服务的节点；不按节点选择或不属于本分配器时为 NO_NODE
+        int arena_node(void* ptr) const {
+            const Arena* arena = arena_of(ptr);
+            return arena != nullptr ? arena->node : memplumber::numa::NO_NODE;
+        }
+
+        // 指针所属分配区的下标，不属于本分配器时为 -1
+        int arena_index(void* ptr) const {
+            const Arena* arena = arena_of(ptr);
+            for (std::size_t i = 0; arena != nullptr && i < arena_count_; ++i) {
+                if (&this->arena(i) == arena) {
+                    return static_cast<int>(i);
+                }
+            }
+            return -1;
+        }
+
+        // 空闲内存回收（线程缓存中的对象对共享堆而言仍是存活分配）
+        std::size_t idle_bytes() const {
+            std::size_t total = 0;
+            for (std::size_t i = 0; i < arena_count_; ++i) {
+                const Arena& arena = this->arena(i);
+                std::lock_guard<std::mutex> lock(arena.mutex);
+                total += arena.allocator.idle_bytes();
+            }
+            return total;
+        }
+
+        // 保留额度平分给各分配区，逐个加锁回收
+        std::size_t trim(std::size_t retain) {
+            std::size_t released = 0;
+            for (std::size_t i = 0; i < arena_count_; ++i) {
+                Arena& arena = this->arena(i);
+                std::lock_guard<std::mutex> lock(arena.mutex);
+                released += arena.allocator.trim(retain / arena_count_);
+            }
+            return released;
+        }
+
+        // fork 前取得全部锁，子进程继承一致的堆与注册表
+        // 加锁顺序：注册表 -> 各分配区（下标递增）-> 归属映射；其他路径最多持有一个分配区锁
+        void lock_for_fork() {
+            registry_mutex_.lock();
+            for (std::size_t i = 0; i < arena_count_; ++i) {
+                arena(i).mutex.lock();
+            }
+            map_mutex_.lock();
+        }
+
+        void unlock_after_fork() {
+            map_mutex_.unlock();
+            for (std::size_t i = arena_count_; i-- > 0;) {
+                arena(i).mutex.unlock();
+            }
+            registry_mutex_.unlock();
+        }
+
+        std::size_t allocation_size(void* ptr) const {
+            const Arena* arena = arena_of(ptr);
+            return arena != nullptr ? arena->allocator.allocation_size(ptr) : 0;
+        }
+
+        // 持有堆锁期间不能经过 operator new：输出直接写入文件描述符
+        bool write_heap_map(int fd) const {
+            FdStreambuf buffer(fd);
+            std::ostream out(&buffer);
+            out << "{\"allocator\":\"GlobalAllocator\",\"arenas\":[";
+            for (std::size_t i = 0; i < arena_count_; ++i) {
+                const Arena& arena = this->arena(i);
+                std::lock_guard<std::mutex> lock(arena.mutex);
+                out << (i == 0 ? "" : ",");
+                arena.allocator.export_heap_map(out);
+                out.flush();
+            }
+            out << "]}";
+            out.flush();
+            return out.good() && !buffer.failed();
         }
-        
+
+        /**
+         * Statistics of operator new/delete calls, summed over all threads
+         * (objects sitting in thread caches count as deallocated)
+         *
+         * Only the registry mutex is taken (held by threads starting or
+         * exiting), never the heap mutex, so polling does not stall allocation.
+         */
         memplumber::FreeListAllocator::AllocatorStats get_stats() const {
-            std::lock_guard<std::mutex> lock(mutex_);
-            return allocator_.get_stats();
+            memplumber::FreeListAllocator::AllocatorStats stats;
+            stats.fragmentation_ratio = fragmentation_ratio();
+
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            retired_.add_to(stats);
+            for (const ThreadCache* cache = registry_head_; cache != nullptr; cache = cache->next) {
+                cache->counters.add_to(stats);
+            }
+            stats.current_usage = memplumber::usage_from(stats);
+            return stats;
+        }
+
+        // 按统计尺寸分级汇总的 new/delete 次数与字节数
+        memplumber::SizeClassTable size_class_stats() const {
+            memplumber::SizeClassTable table = memplumber::make_size_class_table();
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            retired_.add_to(table);
+            for (const ThreadCache* cache = registry_head_; cache != nullptr; cache = cache->next) {
+                cache->counters.add_to(table);
+            }
+            return table;
+        }
+
+        // 线程退出：把缓存全部还给共享堆，并把计数并入全局
+        void retire_thread_cache(ThreadCache& cache) {
+            for (std::size_t cls = 0; cls < kNumSizeClasses; ++cls) {
+                flush(cache, cls, cache.counts[cls]);
+            }
+
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            if (cache.prev != nullptr) {
+                cache.prev->next = cache.next;
+            } else {
+                registry_head_ = cache.next;
+            }
+            if (cache.next != nullptr) {
+                cache.next->prev = cache.prev;
+            }
+            retired_.merge(cache.counters);
+            cache.state = ThreadCache::Dead;
         }
-        
+
     private:
-        GlobalAllocatorManager() : memory_source_(), allocator_(memory_source_, 64 * 1024) {
-            // 64KB 初始块大小，适合大多数应用
-        }
-        
-        mutable std::mutex mutex_;
-        memplumber::MemorySource memory_source_;
-        memplumber::FreeListAllocator allocator_;
-        
+        /**
+         * One shard of the shared heap
+         *
+         * Cache-line aligned so neighbouring arenas' locks do not share a
+         * line. The heap grows contiguously inside the source's reservation.
+         */
+        struct alignas(64) Arena {
+            Arena(GlobalAllocatorManager& owner, std::size_t reserve, int logical_node, int bind_node)
+                : manager(owner)
+                , node(logical_node)
+                , source(memplumber::MemorySource::HugePagePolicy::None, reserve, bind_node)
+                , allocator(source, 64 * 1024) {} // 64KB 初始块大小，适合大多数应用
+
+            GlobalAllocatorManager& manager;
+            int node;                     // Logical NUMA node served, NO_NODE unless selecting by node
+            mutable std::mutex mutex;
+            memplumber::MemorySource source;
+            memplumber::FreeListAllocator allocator;
+        };
+
+        enum class ArenaSelection { RoundRobin, CpuId, Node };
+
+        GlobalAllocatorManager()
+            : arena_map_(map_source_)
+            , numa_nodes_(configured_numa_nodes())
+            , selection_(configured_selection(numa_nodes_))
+            , arena_count_(configured_arena_count(selection_, numa_nodes_)) {
+            // 逻辑节点数与真实节点数不同即为模拟：CPU 按编号轮流归入各节点
+            const int real_nodes = memplumber::numa::online_nodes();
+            const bool simulated = numa_nodes_ != static_cast<std::size_t>(real_nodes);
+            const long cpus = sysconf(_SC_NPROCESSORS_CONF);
+            if (!simulated) {
+                memplumber::numa::cpu_nodes(real_nodes, cpu_node_, kMaxCpus);
+            }
+            for (std::size_t cpu = 0; cpu < kMaxCpus; ++cpu) {
+                const bool known = !simulated && static_cast<long>(cpu) < cpus;
+                cpu_node_[cpu] = static_cast<std::uint8_t>(known ? cpu_node_[cpu] % numa_nodes_ : cpu % numa_nodes_);
+            }
+
+            // 预留的地址空间由各分配区平分，但每个至少 kMinArenaReserve
+            std::size_t reserve = kTotalReserve / arena_count_;
+            if (reserve < kMinArenaReserve) {
+                reserve = kMinArenaReserve;
+            }
+            for (std::size_t i = 0; i < arena_count_; ++i) {
+                int node = memplumber::numa::NO_NODE;
+                int bind_node = memplumber::numa::NO_NODE;
+                if (selection_ == ArenaSelection::Node) {
+                    node = static_cast<int>(i % numa_nodes_);
+                    bind_node = node % real_nodes;
+                }
+                Arena* arena = new (arena_storage_[i]) Arena(*this, reserve, node, bind_node);
+                if (!arena->allocator.set_range_hook(&GlobalAllocatorManager::record_range, arena)) {
+                    throw std::bad_alloc();
+                }
+            }
+        }
+
+        // 预留的虚拟地址空间（PROT_NONE，不占物理内存），用尽后退回逐段 mmap
+        static constexpr std::size_t kTotalReserve = std::size_t(16) << 30;
+        static constexpr std::size_t kMinArenaReserve = std::size_t(1) << 30;
+
+        // 构造发生在第一次分配时，读环境变量、sysconf 与 sysfs 都不分配内存
+        static std::size_t configured_numa_nodes() {
+            long nodes = 0;
+            if (const char* value = std::getenv("AXONTZZ_NUMA_NODES")) {
+                nodes = std::strtol(value, nullptr, 10);
+            }
+            if (nodes <= 0) {
+                nodes = memplumber::numa::online_nodes();
+            }
+            return static_cast<std::size_t>(nodes) < kMaxArenas ? static_cast<std::size_t>(nodes) : kMaxArenas;
+        }
+
+        static ArenaSelection configured_selection(std::size_t numa_nodes) {
+            const char* value = std::getenv("AXONTZZ_ARENA_SELECT");
+            if (value != nullptr && std::strcmp(value, "cpu") == 0) {
+                return ArenaSelection::CpuId;
+            }
+            if (value != nullptr && std::strcmp(value, "node") == 0) {
+                return ArenaSelection::Node;
+            }
+            if (value != nullptr && std::strcmp(value, "round-robin") == 0) {
+                return ArenaSelection::RoundRobin;
+            }
+            return numa_nodes > 1 ? ArenaSelection::Node : ArenaSelection::RoundRobin;
+        }
+
+        // 按节点选择时分配区数取节点数的整数倍，每个节点分到同样多的分配区
+        static std::size_t configured_arena_count(ArenaSelection selection, std::size_t numa_nodes) {
+            long requested = 0;
+            if (const char* value = std::getenv("AXONTZZ_ARENAS")) {
+                requested = std::strtol(value, nullptr, 10);
+            }
+            if (requested <= 0) {
+                requested = sysconf(_SC_NPROCESSORS_ONLN);
+            }
+            std::size_t count = requested < 1 ? 1 : static_cast<std::size_t>(requested);
+            if (selection == ArenaSelection::Node) {
+                count = (count + numa_nodes - 1) / numa_nodes * numa_nodes;
+                return count <= kMaxArenas ? count : kMaxArenas / numa_nodes * numa_nodes;
+            }
+            return count < kMaxArenas ? count : kMaxArenas;
+        }
+
+        // 分配区的范围钩子：在分配区锁内调用，登记或注销该分配区的地址范围
+        static bool record_range(void* context, void* start, std::size_t size, bool mapped) {
+            Arena* arena = static_cast<Arena*>(context);
+            GlobalAllocatorManager& manager = arena->manager;
+            std::lock_guard<std::mutex> lock(manager.map_mutex_);
+            if (mapped) {
+                return manager.arena_map_.set_range(start, size, arena);
+            }
+            manager.arena_map_.clear_range(start, size);
+            return true;
+        }
+
+        Arena& arena(std::size_t index) {
+            return *reinterpret_cast<Arena*>(arena_storage_[index]);
+        }
+
+        const Arena& arena(std::size_t index) const {
+            return *reinterpret_cast<const Arena*>(arena_storage_[index]);
+        }
+
+        // 无锁查找指针所属分配区；不属于本分配器时为 nullptr
+        Arena* arena_of(const void* ptr) const {
+            return static_cast<Arena*>(arena_map_.lookup(ptr));
+        }
+
+        // 新分配使用的分配区；线程缓存不可用时（线程退出中）退回 0 号，或本节点的第一个
+        Arena& arena_for(const ThreadCache* cache) {
+            if (selection_ == ArenaSelection::CpuId) {
+                int cpu = sched_getcpu();
+                return arena(cpu > 0 ? static_cast<std::size_t>(cpu) % arena_count_ : 0);
+            }
+            if (selection_ == ArenaSelection::Node) {
+                // 本节点的分配区为 node, node + nodes, ...；节点内仍按注册顺序轮流
+                const std::size_t per_node = arena_count_ / numa_nodes_;
+                const std::size_t slot = cache != nullptr ? cache->arena % per_node : 0;
+                return arena(slot * numa_nodes_ + static_cast<std::size_t>(current_node()));
+            }
+            return arena(cache != nullptr ? cache->arena : 0);
+        }
+
+        // 各分配区碎片率的合并：1 - 总请求字节 / 总块字节
+        double fragmentation_ratio() const {
+            double requested = 0.0;
+            double blocks = 0.0;
+            for (std::size_t i = 0; i < arena_count_; ++i) {
+                const memplumber::FreeListAllocator::AllocatorStats stats = arena(i).allocator.get_stats();
+                const double live = static_cast<double>(stats.current_usage);
+                requested += live;
+                if (stats.fragmentation_ratio < 1.0) {
+                    blocks += live / (1.0 - stats.fragmentation_ratio);
+                }
+            }
+            return blocks > 0.0 ? 1.0 - requested / blocks : 0.0;
+        }
+
+        ThreadCache* local_cache();
+
+        CachedObject* refill(ThreadCache& cache, std::size_t cls) {
+            std::uint32_t batch = batch_size(cls);
+            Arena& arena = arena_for(&cache);
+            std::lock_guard<std::mutex> lock(arena.mutex);
+            for (std::uint32_t i = 0; i < batch; ++i) {
+                void* ptr = arena.allocator.allocate(kClassSizes[cls], kDefaultAlignment);
+                if (ptr == nullptr) {
+                    break;
+                }
+                CachedObject* object = static_cast<CachedObject*>(ptr);
+                object->next = cache.heads[cls];
+                cache.heads[cls] = object;
+                cache.counts[cls]++;
+            }
+            return cache.heads[cls];
+        }
+
+        void flush(ThreadCache& cache, std::size_t cls, std::uint32_t count) {
+            // 缓存里可能混有其他线程分配区的对象：各自还给所属分配区，
+            // 相邻对象属于同一分配区时沿用已持有的锁
+            Arena* locked = nullptr;
+            for (std::uint32_t i = 0; i < count && cache.heads[cls] != nullptr; ++i) {
+                CachedObject* object = cache.heads[cls];
+                Arena* owner = arena_of(object);
+                if (owner != locked) {
+                    if (locked != nullptr) {
+                        locked->mutex.unlock();
+                    }
+                    owner->mutex.lock();
+                    locked = owner;
+                }
+                cache.heads[cls] = object->next;
+                cache.counts[cls]--;
+                owner->allocator.deallocate(object, kClassSizes[cls]);
+            }
+            if (locked != nullptr) {
+                locked->mutex.unlock();
+            }
+        }
+
+        void register_thread_cache(ThreadCache& cache) {
+            std::lock_guard<std::mutex> lock(registry_mutex_);
+            cache.prev = nullptr;
+            cache.next = registry_head_;
+            if (registry_head_ != nullptr) {
+                registry_head_->prev = &cache;
+            }
+            registry_head_ = &cache;
+            cache.arena = static_cast<std::uint32_t>(next_arena_++ % arena_count_);
+            cache.state = ThreadCache::Active;
+        }
+
+        mutable std::mutex registry_mutex_;  // 保护线程缓存注册表、retired_ 与 next_arena_
+        mutable std::mutex map_mutex_;       // 串行化 arena_map_ 的写入（查找无锁）
+        memplumber::MemorySource map_source_;
+        memplumber::PageMap arena_map_;      // 页 -> 所属分配区
+        std::size_t numa_nodes_;             // 逻辑节点数（模拟时不同于真实节点数）
+        ArenaSelection selection_;
+        std::size_t arena_count_;
+        std::uint8_t cpu_node_[kMaxCpus];    // CPU -> 逻辑节点
+        std::size_t next_arena_ = 0;
+        alignas(Arena) unsigned char arena_storage_[kMaxArenas][sizeof(Arena)];
+        ThreadCache* registry_head_ = nullptr;
+        memplumber::StatsShard retired_{};   // 已退出线程的计数，以及线程缓存不可用时的记录
+
         // 禁用复制和移动
         GlobalAllocatorManager(const GlobalAllocatorManager&) = delete;
         GlobalAllocatorManager& operator=(const GlobalAllocatorManager&) = delete;
     };
+
+    // 线程退出时清理线程缓存（注册析构函数不经过 operator new）
+    struct ThreadCacheGuard {
+        ~ThreadCacheGuard() {
+            GlobalAllocatorManager::instance().retire_thread_cache(tcache);
+        }
+    };
+
+    ThreadCache* GlobalAllocatorManager::local_cache() {
+        ThreadCache& cache = tcache;
+        if (cache.state == ThreadCache::Active) {
+            return &cache;
+        }
+        if (cache.state != ThreadCache::Uninitialized) {
+            return nullptr; // 已退出，或正在注册（见下）
+        }
+        // 作为 malloc 使用时，注册线程析构函数本身会调用 calloc：
+        // 注册期间的分配直接走共享堆，不会重入这里
+        cache.state = ThreadCache::Registering;
+        static thread_local ThreadCacheGuard guard;
+        (void)guard;
+        register_thread_cache(cache);
+        return &cache;
+    }
 }
 
 // 全局 new 重载
@@ -55,7 +750,7 @@ void* operator new(std::size_t size) {
     if (size == 0) {
         size = 1; // C++ 标准要求
     }
-    
+
     void* ptr = GlobalAllocatorManager::instance().allocate(size);
     if (ptr == nullptr) {
         throw std::bad_alloc();
@@ -71,7 +766,7 @@ void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
     if (size == 0) {
         size = 1;
     }
-    
+
     return GlobalAllocatorManager::instance().allocate(size);
 }
 
@@ -88,8 +783,9 @@ void operator delete[](void* ptr) noexcept {
     operator delete(ptr);
 }
 
+// 带大小的 delete：小对象直接由大小得到尺寸分级，不读分配头部
 void operator delete(void* ptr, std::size_t size) noexcept {
-    GlobalAllocatorManager::instance().deallocate(ptr, size);
+    GlobalAllocatorManager::instance().deallocate_sized(ptr, size);
 }
 
 void operator delete[](void* ptr, std::size_t size) noexcept {
@@ -104,15 +800,138 @@ void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
     operator delete(ptr);
 }
 
+// 过度对齐的 new/delete（C++17 align_val_t）
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+
+    void* ptr = GlobalAllocatorManager::instance().allocate(size, static_cast<std::size_t>(alignment));
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    if (size == 0) {
+        size = 1;
+    }
+
+    return GlobalAllocatorManager::instance().allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    GlobalAllocatorManager::instance().deallocate(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment) noexcept {
+    operator delete(ptr, alignment);
+}
+
+// 对齐不超过默认值的分配同样遵守分级约定，可以走带大小的快速路径
+void operator delete(void* ptr, std::size_t size, std::align_val_t alignment) noexcept {
+    if (static_cast<std::size_t>(alignment) <= kDefaultAlignment) {
+        GlobalAllocatorManager::instance().deallocate_sized(ptr, size);
+    } else {
+        GlobalAllocatorManager::instance().deallocate(ptr);
+    }
+}
+
+void operator delete[](void* ptr, std::size_t size, std::align_val_t alignment) noexcept {
+    operator delete(ptr, size, alignment);
+}
+
+void operator delete(void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    operator delete(ptr, alignment);
+}
+
+void operator delete[](void* ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    operator delete(ptr, alignment);
+}
+
 // 提供访问全局分配器统计信息的API
 namespace memplumber {
     namespace global {
         AllocatorInterface::AllocatorStats get_global_allocator_stats() {
             return GlobalAllocatorManager::instance().get_stats();
         }
-        
+
         bool is_pointer_owned_by_global_allocator(void* ptr) {
             return GlobalAllocatorManager::instance().owns(ptr);
         }
+
+        std::size_t global_allocator_idle_bytes() {
+            return GlobalAllocatorManager::instance().idle_bytes();
+        }
+
+        std::size_t trim_global_allocator(std::size_t retain) {
+            return GlobalAllocatorManager::instance().trim(retain);
+        }
+
+        SizeClassTable global_allocator_size_class_stats() {
+            return GlobalAllocatorManager::instance().size_class_stats();
+        }
+
+        bool write_global_heap_map(int fd) {
+            return GlobalAllocatorManager::instance().write_heap_map(fd);
+        }
+
+        std::size_t global_allocator_arena_count() {
+            return GlobalAllocatorManager::instance().arena_count();
+        }
+
+        int global_allocator_arena_of(void* ptr) {
+            return GlobalAllocatorManager::instance().arena_index(ptr);
+        }
+
+        std::size_t global_allocator_numa_nodes() {
+            return GlobalAllocatorManager::instance().numa_nodes();
+        }
+
+        int global_allocator_current_node() {
+            return GlobalAllocatorManager::instance().current_node();
+        }
+
+        int global_allocator_arena_node(void* ptr) {
+            return GlobalAllocatorManager::instance().arena_node(ptr);
+        }
+
+        // malloc 接口（libaxontzz.so）使用的入口：与 operator new/delete 共用同一个堆
+        void* global_allocate(std::size_t size, std::size_t alignment) {
+            return GlobalAllocatorManager::instance().allocate(size, alignment);
+        }
+
+        void* global_allocate_zeroed(std::size_t size, std::size_t alignment) {
+            return GlobalAllocatorManager::instance().allocate_zeroed(size, alignment);
+        }
+
+        void global_deallocate(void* ptr) {
+            GlobalAllocatorManager::instance().deallocate(ptr);
+        }
+
+        void* global_reallocate(void* ptr, std::size_t size) {
+            return GlobalAllocatorManager::instance().reallocate(ptr, size);
+        }
+
+        std::size_t global_allocation_size(void* ptr) {
+            return GlobalAllocatorManager::instance().allocation_size(ptr);
+        }
+
+        void global_allocator_prepare_fork() {
+            GlobalAllocatorManager::instance().lock_for_fork();
+        }
+
+        void global_allocator_after_fork() {
+            GlobalAllocatorManager::instance().unlock_after_fork();
+        }
     }
 }
@@ -1,15 +1,62 @@
 #include "axontzz/memory_source.h"
+#include "axontzz/trace.h"
 #include <cassert>
-#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
 
 namespace memplumber {
 
-MemorySource::MemorySource() 
+namespace {
+    // 计数器各自精确即可，不需要与其他内存访问排序
+    inline void count_up(std::atomic<size_t>& counter, size_t amount = 1) {
+        counter.fetch_add(amount, std::memory_order_relaxed);
+    }
+    
+    inline void count_down(std::atomic<size_t>& counter, size_t amount) {
+        counter.fetch_sub(amount, std::memory_order_relaxed);
+    }
+    
+    inline uint64_t pack_head(uint64_t tag, uint32_t index) {
+        return (tag << 32) | index;
+    }
+}
+
+MemorySource::MemorySource()
+    : MemorySource(HugePagePolicy::None) {
+}
+
+MemorySource::MemorySource(HugePagePolicy huge_page_policy, size_t arena_reserve, int numa_node)
     : page_size_(static_cast<size_t>(getpagesize()))
-    , stats_{} {
+    , huge_page_policy_(huge_page_policy)
+    , decommit_mode_(DecommitMode::DontNeed)
+    , numa_node_(numa::NO_NODE)
+    , numa_policy_(numa::Policy::Preferred)
+    , arena_base_(nullptr)
+    , arena_size_(0)
+    , arena_top_(0)
+    , stats_{}
+    , block_cache_size_(0)
+    , cached_head_(pack_head(0, NO_SLOT))
+    , spare_head_(pack_head(0, NO_SLOT)) {
     // Verify we got a reasonable page size
     assert(page_size_ > 0 && page_size_ <= 65536);
     assert((page_size_ & (page_size_ - 1)) == 0); // Must be power of 2
+    
+    if (numa_node != numa::NO_NODE && !set_numa_node(numa_node)) {
+        MP_TRACE_WARN("Ignoring out-of-range NUMA node %d", numa_node);
+    }
+    if (arena_reserve != 0 && !reserve_arena(arena_reserve)) {
+        // 预留失败不致命：commit_arena() 返回 nullptr，调用者退回 allocate_block()
+        MP_TRACE_WARN("Failed to reserve %zu byte address space arena", arena_reserve);
+    }
+}
+
+MemorySource::~MemorySource() {
+    release_cached_blocks();
+    if (arena_base_ != nullptr) {
+        munmap(arena_base_, arena_size_);
+    }
 }
 
 void* MemorySource::allocate_block(size_t size) {
@@ -17,51 +64,598 @@ void* MemorySource::allocate_block(size_t size) {
         return nullptr;
     }
     
-    // Round up to page boundary
-    size_t aligned_size = align_to_page(size);
+    // Round up to page boundary (huge page boundary for big blocks under a huge page policy)
+    size_t aligned_size = block_size_for(size);
     
-    // Use mmap to get memory directly from OS
-    // MAP_PRIVATE | MAP_ANONYMOUS gives us a private, zero-filled mapping
-    void* ptr = mmap(nullptr,                    // Let kernel choose address
-                     aligned_size,               // Size (page-aligned)
-                     PROT_READ | PROT_WRITE,     // Read/write permissions
-                     MAP_PRIVATE | MAP_ANONYMOUS, // Private, not backed by file
-                     -1,                         // No file descriptor
-                     0);                         // No offset
+    if (aligned_size == block_cache_size_) {
+        if (void* cached = take_cached_block()) {
+            return cached;
+        }
+    }
     
-    if (ptr == MAP_FAILED) {
+    void* ptr;
+    if (wants_huge_pages(size)) {
+        ptr = map_huge_block(aligned_size);
+    } else {
+        // Use mmap to get memory directly from OS
+        // MAP_PRIVATE | MAP_ANONYMOUS gives us a private, zero-filled mapping
+        ptr = mmap(nullptr,                    // Let kernel choose address
+                   aligned_size,               // Size (page-aligned)
+                   PROT_READ | PROT_WRITE,     // Read/write permissions
+                   MAP_PRIVATE | MAP_ANONYMOUS, // Private, not backed by file
+                   -1,                         // No file descriptor
+                   0);                         // No offset
+        if (ptr == MAP_FAILED) {
+            ptr = nullptr;
+        }
+    }
+    
+    if (ptr == nullptr) {
         // mmap failed - could be out of virtual address space or memory
         return nullptr;
     }
+    place_on_node(ptr, aligned_size);
     
     // Update statistics
-    stats_.total_allocated += aligned_size;
-    stats_.current_usage += aligned_size;
-    stats_.allocation_count++;
+    count_up(stats_.total_allocated, aligned_size);
+    count_up(stats_.current_usage, aligned_size);
+    count_up(stats_.allocation_count);
     
     return ptr;
 }
 
+void* MemorySource::allocate_aligned_block(size_t size, size_t alignment) {
+    if (size == 0 || alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        return nullptr;
+    }
+    if (alignment <= page_size_ ||
+        (wants_huge_pages(size) && alignment <= HUGE_PAGE_SIZE)) {
+        return allocate_block(size);
+    }
+    
+    size_t aligned_size = block_size_for(size);
+    void* ptr = map_aligned(aligned_size, alignment);
+    if (ptr == nullptr) {
+        return nullptr;
+    }
+    if (wants_huge_pages(size) && madvise(ptr, aligned_size, MADV_HUGEPAGE) == 0) {
+        count_up(stats_.hugepage_advised_blocks);
+    }
+    place_on_node(ptr, aligned_size);
+    
+    // Update statistics
+    count_up(stats_.total_allocated, aligned_size);
+    count_up(stats_.current_usage, aligned_size);
+    count_up(stats_.allocation_count);
+    
+    return ptr;
+}
+
+void* MemorySource::map_aligned(size_t aligned_size, size_t alignment, int prot) {
+    size_t reserve_size = aligned_size + alignment - page_size_;
+    
+    // 只预留地址空间时不占用交换空间配额
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | (prot == PROT_NONE ? MAP_NORESERVE : 0);
+    void* raw = mmap(nullptr, reserve_size, prot, flags, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    
+    // 裁掉对齐起点之前和块末尾之后多余的页
+    uintptr_t raw_addr = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t start = (raw_addr + alignment - 1) & ~(alignment - 1);
+    size_t head = static_cast<size_t>(start - raw_addr);
+    size_t tail = reserve_size - head - aligned_size;
+    if (head != 0) {
+        munmap(raw, head);
+    }
+    if (tail != 0) {
+        munmap(reinterpret_cast<void*>(start + aligned_size), tail);
+    }
+    return reinterpret_cast<void*>(start);
+}
+
+bool MemorySource::wants_huge_pages(size_t size) const {
+    return huge_page_policy_ != HugePagePolicy::None && size >= HUGE_PAGE_SIZE;
+}
+
+void* MemorySource::map_huge_block(size_t size) {
+    if (huge_page_policy_ == HugePagePolicy::Explicit) {
+#ifdef MAP_HUGETLB
+        void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (ptr != MAP_FAILED) {
+            count_up(stats_.hugetlb_blocks);
+            return ptr;
+        }
+#endif
+        // 大页池为空或内核不支持：退回透明大页
+        count_up(stats_.hugetlb_fallbacks);
+        MP_TRACE_INFO("MAP_HUGETLB failed for %zu bytes, falling back to transparent huge pages", size);
+    }
+    
+    // 按大页边界对齐，整块都能由 2 MiB 页支撑
+    void* ptr = map_aligned(size, HUGE_PAGE_SIZE);
+    if (ptr == nullptr) {
+        return nullptr;
+    }
+#ifdef MADV_HUGEPAGE
+    if (madvise(ptr, size, MADV_HUGEPAGE) == 0) {
+        count_up(stats_.hugepage_advised_blocks);
+    } else {
+        MP_TRACE_INFO("MADV_HUGEPAGE not honoured for %p (%zu bytes)", ptr, size);
+    }
+#endif
+    return ptr;
+}
+
+bool MemorySource::reserve_arena(size_t size) {
+    if (arena_base_ != nullptr || size == 0) {
+        return false;
+    }
+    
+    // 大页策略下按大页对齐，提交的块才能由 2 MiB 页支撑
+    const size_t alignment = huge_page_policy_ != HugePagePolicy::None ? HUGE_PAGE_SIZE : page_size_;
+    const size_t reserve_size = (size + alignment - 1) & ~(alignment - 1);
+    void* base = alignment > page_size_ ? map_aligned(reserve_size, alignment, PROT_NONE)
+                                        : mmap(nullptr, reserve_size, PROT_NONE,
+                                               MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == nullptr || base == MAP_FAILED) {
+        return false;
+    }
+    
+    arena_base_ = static_cast<char*>(base);
+    arena_size_ = reserve_size;
+    arena_top_.store(0, std::memory_order_relaxed);
+    MP_TRACE_INFO("Reserved %zu byte arena at %p", reserve_size, base);
+    return true;
+}
+
+void* MemorySource::commit_arena(size_t size) {
+    if (arena_base_ == nullptr || size == 0) {
+        return nullptr;
+    }
+    
+    const size_t aligned_size = block_size_for(size);
+    
+    // 先用 CAS 占下边界之上的一段，再修改保护；并发的提交各得一段互不重叠的地址
+    // acquire 与降低边界的 release 配对：复用的地址在上一个持有者释放之后才交出
+    size_t top = arena_top_.load(std::memory_order_acquire);
+    do {
+        if (aligned_size > arena_size_ - top) {
+            MP_TRACE_INFO("Arena exhausted: %zu of %zu bytes committed, %zu requested",
+                          top, arena_size_, aligned_size);
+            return nullptr;
+        }
+    } while (!arena_top_.compare_exchange_weak(top, top + aligned_size, std::memory_order_acquire));
+    
+    char* chunk = arena_base_ + top;
+    if (mprotect(chunk, aligned_size, PROT_READ | PROT_WRITE) != 0) {
+        MP_TRACE_WARN("Warning: mprotect failed for arena chunk %p size=%zu",
+                      static_cast<void*>(chunk), aligned_size);
+        // 仍在顶端时退回边界；否则这段保持 PROT_NONE，留在预留区里
+        size_t expected = top + aligned_size;
+        arena_top_.compare_exchange_strong(expected, top, std::memory_order_relaxed);
+        return nullptr;
+    }
+    if (wants_huge_pages(size) && madvise(chunk, aligned_size, MADV_HUGEPAGE) == 0) {
+        count_up(stats_.hugepage_advised_blocks);
+    }
+    // 释放时以 MAP_FIXED 重新映射会丢掉策略，所以每次提交都重新设置
+    place_on_node(chunk, aligned_size);
+    
+    // Update statistics
+    count_up(stats_.total_allocated, aligned_size);
+    count_up(stats_.current_usage, aligned_size);
+    count_up(stats_.allocation_count);
+    
+    return chunk;
+}
+
+void MemorySource::release_arena_chunk(void* ptr, size_t size) {
+    // 以 PROT_NONE 重新映射：一次调用同时丢弃物理页和访问权限，地址保持预留
+    void* result = mmap(ptr, size, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    if (result == MAP_FAILED) {
+        MP_TRACE_WARN("Warning: failed to uncommit arena chunk ptr=%p size=%zu", ptr, size);
+        return;
+    }
+    
+    // 位于顶端的块降低提交边界，下次 commit_arena() 可复用
+    size_t end = static_cast<size_t>(static_cast<char*>(ptr) + size - arena_base_);
+    arena_top_.compare_exchange_strong(end, end - size, std::memory_order_release, std::memory_order_relaxed);
+    
+    count_up(stats_.total_deallocated, size);
+    count_down(stats_.current_usage, size);
+    count_up(stats_.deallocation_count);
+}
+
 void MemorySource::deallocate_block(void* ptr, size_t size) {
     if (ptr == nullptr || size == 0) {
         return;
     }
     
-    size_t aligned_size = align_to_page(size);
+    if (in_arena(ptr)) {
+        // 相邻的块可能被调用者合并过，按页粒度释放实际传入的范围
+        release_arena_chunk(ptr, align_to_page(size));
+        return;
+    }
+    
+    size_t aligned_size = block_size_for(size);
+    if (aligned_size == block_cache_size_ && cache_block(ptr)) {
+        return;
+    }
     
     // Return memory to OS
     int result = munmap(ptr, aligned_size);
     
     if (result == 0) {
         // Success
-        stats_.total_deallocated += aligned_size;
-        stats_.current_usage -= aligned_size;
-        stats_.deallocation_count++;
+        count_up(stats_.total_deallocated, aligned_size);
+        count_down(stats_.current_usage, aligned_size);
+        count_up(stats_.deallocation_count);
     } else {
         // munmap failed - this is a serious error
-        std::cerr << "Warning: munmap failed for ptr=" << ptr 
-                  << " size=" << aligned_size << std::endl;
+        MP_TRACE_WARN("Warning: munmap failed for ptr=%p size=%zu", ptr, aligned_size);
+    }
+}
+
+bool MemorySource::can_remap(const void* ptr, size_t old_size, size_t new_size) const {
+    // 预留区的块由调用者按页合并管理；大页块的对齐与 hugetlbfs 映射都不能随意搬动
+    return ptr != nullptr && old_size != 0 && new_size != 0 && !in_arena(ptr) &&
+           !wants_huge_pages(old_size) && !wants_huge_pages(new_size);
+}
+
+bool MemorySource::resize_block(void* ptr, size_t old_size, size_t new_size) {
+    if (!can_remap(ptr, old_size, new_size)) {
+        return false;
+    }
+    
+    const size_t old_aligned = block_size_for(old_size);
+    const size_t new_aligned = block_size_for(new_size);
+    if (old_aligned == new_aligned) {
+        return true;
+    }
+    
+    // 不带 MREMAP_MAYMOVE：上方的页被占用时失败，块保持不动
+    if (mremap(ptr, old_aligned, new_aligned, 0) == MAP_FAILED) {
+        return false;
+    }
+    
+    if (new_aligned > old_aligned) {
+        count_up(stats_.total_allocated, new_aligned - old_aligned);
+        count_up(stats_.current_usage, new_aligned - old_aligned);
+    } else {
+        count_up(stats_.total_deallocated, old_aligned - new_aligned);
+        count_down(stats_.current_usage, old_aligned - new_aligned);
+    }
+    count_up(stats_.remap_count);
+    return true;
+}
+
+bool MemorySource::move_block(void* from, size_t old_size, void* to, size_t new_size) {
+    if (!can_remap(from, old_size, new_size) || to == nullptr || new_size < old_size) {
+        return false;
+    }
+    
+    const size_t old_aligned = block_size_for(old_size);
+    const size_t new_aligned = block_size_for(new_size);
+    
+    // 目标映射被原子地替换为搬来的页，原地址范围随之解除映射
+    void* result = mremap(from, old_aligned, new_aligned, MREMAP_MAYMOVE | MREMAP_FIXED, to);
+    if (result == MAP_FAILED) {
+        MP_TRACE_WARN("Warning: mremap failed moving %p (%zu bytes) to %p", from, old_aligned, to);
+        return false;
+    }
+    
+    // 目标块已计入统计；原块的映射消失
+    count_up(stats_.total_deallocated, old_aligned);
+    count_down(stats_.current_usage, old_aligned);
+    count_up(stats_.deallocation_count);
+    count_up(stats_.remap_count);
+    return true;
+}
+
+bool MemorySource::decommit(void* ptr, size_t size) {
+    if (ptr == nullptr || size == 0) {
+        return true;
+    }
+    
+    int result = -1;
+#ifdef MADV_FREE
+    if (decommit_mode_ == DecommitMode::Free) {
+        result = madvise(ptr, size, MADV_FREE);
+    }
+#endif
+    if (result != 0) {
+        // MADV_FREE 不可用（内核过旧）或选择了 DontNeed
+        result = madvise(ptr, size, MADV_DONTNEED);
+    }
+    
+    if (result != 0) {
+        MP_TRACE_WARN("Warning: madvise failed for ptr=%p size=%zu", ptr, size);
+        return false;
+    }
+    count_up(stats_.current_decommitted, size);
+    count_up(stats_.decommit_count);
+    return true;
+}
+
+void MemorySource::recommit(void* ptr, size_t size) {
+    (void)ptr; // 映射一直可读写，首次访问时由内核补页
+    count_down(stats_.current_decommitted, size);
+}
+
+MemorySource::Stats MemorySource::get_stats() const {
+    Stats stats;
+    stats.total_allocated = stats_.total_allocated.load(std::memory_order_relaxed);
+    stats.total_deallocated = stats_.total_deallocated.load(std::memory_order_relaxed);
+    stats.current_usage = stats_.current_usage.load(std::memory_order_relaxed);
+    stats.allocation_count = stats_.allocation_count.load(std::memory_order_relaxed);
+    stats.deallocation_count = stats_.deallocation_count.load(std::memory_order_relaxed);
+    stats.current_decommitted = stats_.current_decommitted.load(std::memory_order_relaxed);
+    stats.decommit_count = stats_.decommit_count.load(std::memory_order_relaxed);
+    stats.hugetlb_blocks = stats_.hugetlb_blocks.load(std::memory_order_relaxed);
+    stats.hugepage_advised_blocks = stats_.hugepage_advised_blocks.load(std::memory_order_relaxed);
+    stats.hugetlb_fallbacks = stats_.hugetlb_fallbacks.load(std::memory_order_relaxed);
+    stats.remap_count = stats_.remap_count.load(std::memory_order_relaxed);
+    stats.current_cached = stats_.current_cached.load(std::memory_order_relaxed);
+    stats.cache_hits = stats_.cache_hits.load(std::memory_order_relaxed);
+    stats.numa_bound_blocks = stats_.numa_bound_blocks.load(std::memory_order_relaxed);
+    stats.numa_bind_failures = stats_.numa_bind_failures.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MemorySource::reset_stats() {
+    std::atomic<size_t>* counters[] = {
+        &stats_.total_allocated, &stats_.total_deallocated, &stats_.current_usage,
+        &stats_.allocation_count, &stats_.deallocation_count, &stats_.current_decommitted,
+        &stats_.decommit_count, &stats_.hugetlb_blocks, &stats_.hugepage_advised_blocks,
+        &stats_.hugetlb_fallbacks, &stats_.remap_count, &stats_.current_cached, &stats_.cache_hits,
+        &stats_.numa_bound_blocks, &stats_.numa_bind_failures,
+    };
+    for (std::atomic<size_t>* counter : counters) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+}
+
+bool MemorySource::set_numa_node(int node, numa::Policy policy) {
+    if (node != numa::NO_NODE && (node < 0 || node >= numa::MAX_NODES)) {
+        return false;
+    }
+    numa_node_ = node;
+    numa_policy_ = policy;
+    return true;
+}
+
+void MemorySource::place_on_node(void* ptr, size_t size) {
+    if (numa_node_ == numa::NO_NODE) {
+        return;
+    }
+    if (numa::bind_range(ptr, size, numa_node_, numa_policy_)) {
+        count_up(stats_.numa_bound_blocks);
+    } else {
+        count_up(stats_.numa_bind_failures);
+    }
+}
+
+bool MemorySource::set_block_cache(size_t block_size, size_t max_blocks) {
+    release_cached_blocks();
+    block_cache_size_ = 0;
+    if (block_size == 0 || max_blocks == 0) {
+        return true;
+    }
+    const size_t aligned_size = block_size_for(block_size);
+    if (wants_huge_pages(aligned_size)) {
+        return false;
+    }
+    
+    // 前 max_blocks 个槽串成空槽栈
+    if (max_blocks > BLOCK_CACHE_SLOTS) {
+        max_blocks = BLOCK_CACHE_SLOTS;
+    }
+    for (size_t i = 0; i < max_blocks; ++i) {
+        cache_slots_[i].block = nullptr;
+        cache_slots_[i].next.store(i + 1 < max_blocks ? static_cast<uint32_t>(i + 1) : NO_SLOT,
+                                   std::memory_order_relaxed);
+    }
+    cached_head_.store(pack_head(0, NO_SLOT), std::memory_order_relaxed);
+    spare_head_.store(pack_head(0, 0), std::memory_order_release);
+    block_cache_size_ = aligned_size;
+    return true;
+}
+
+/*
+ * Treiber 栈：头部高 32 位是每次修改递增的标记，槽被弹出又压回后
+ * 旧头部的 CAS 必然失败（ABA）；读到的 next 可能已过时，但槽数组始终有效
+ */
+uint32_t MemorySource::pop_slot(std::atomic<uint64_t>& head) {
+    uint64_t old_head = head.load(std::memory_order_acquire);
+    while (true) {
+        uint32_t index = static_cast<uint32_t>(old_head);
+        if (index == NO_SLOT) {
+            return NO_SLOT;
+        }
+        uint32_t next = cache_slots_[index].next.load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(old_head, pack_head((old_head >> 32) + 1, next),
+                                       std::memory_order_acquire, std::memory_order_acquire)) {
+            return index;
+        }
+    }
+}
+
+void MemorySource::push_slot(std::atomic<uint64_t>& head, uint32_t index) {
+    uint64_t old_head = head.load(std::memory_order_relaxed);
+    do {
+        cache_slots_[index].next.store(static_cast<uint32_t>(old_head), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(old_head, pack_head((old_head >> 32) + 1, index),
+                                         std::memory_order_release, std::memory_order_relaxed));
+}
+
+void* MemorySource::take_cached_block() {
+    uint32_t index = pop_slot(cached_head_);
+    if (index == NO_SLOT) {
+        return nullptr;
+    }
+    void* block = cache_slots_[index].block;
+    push_slot(spare_head_, index);
+    
+    count_down(stats_.current_cached, block_cache_size_);
+    count_up(stats_.current_usage, block_cache_size_);
+    count_up(stats_.cache_hits);
+    return block;
+}
+
+bool MemorySource::cache_block(void* ptr) {
+    uint32_t index = pop_slot(spare_head_);
+    if (index == NO_SLOT) {
+        return false; // 缓存已满
+    }
+    // 丢弃物理页：再次使用时与新映射一样读出零，且 madvise 只需 mmap 锁的读权限
+    if (madvise(ptr, block_cache_size_, MADV_DONTNEED) != 0) {
+        push_slot(spare_head_, index);
+        return false;
+    }
+    cache_slots_[index].block = ptr;
+    push_slot(cached_head_, index);
+    
+    count_down(stats_.current_usage, block_cache_size_);
+    count_up(stats_.current_cached, block_cache_size_);
+    return true;
+}
+
+void MemorySource::release_cached_blocks() {
+    if (block_cache_size_ == 0) {
+        return;
+    }
+    uint32_t index;
+    while ((index = pop_slot(cached_head_)) != NO_SLOT) {
+        munmap(cache_slots_[index].block, block_cache_size_);
+        push_slot(spare_head_, index);
+        count_down(stats_.current_cached, block_cache_size_);
+        count_up(stats_.total_deallocated, block_cache_size_);
+        count_up(stats_.deallocation_count);
+    }
+}
+
+size_t MemorySource::block_size_for(size_t size) const {
+    if (wants_huge_pages(size)) {
+        return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+    return align_to_page(size);
+}
+
+namespace {
+    // 逐行读取 /proc 文件，不经过堆分配（可在全局分配器内部调用）
+    class ProcLineReader {
+    public:
+        explicit ProcLineReader(const char* path)
+            : fd_(open(path, O_RDONLY | O_CLOEXEC)), begin_(0), end_(0) {}
+        ~ProcLineReader() {
+            if (fd_ >= 0) {
+                close(fd_);
+            }
+        }
+        bool ok() const { return fd_ >= 0; }
+        
+        // 读取下一行（过长的行被截断），文件结束时返回 false
+        bool next(char* line, size_t capacity) {
+            size_t length = 0;
+            while (true) {
+                if (begin_ == end_) {
+                    ssize_t n = read(fd_, buffer_, sizeof(buffer_));
+                    if (n <= 0) {
+                        line[length] = '\0';
+                        return length != 0;
+                    }
+                    begin_ = 0;
+                    end_ = static_cast<size_t>(n);
+                }
+                char c = buffer_[begin_++];
+                if (c == '\n') {
+                    line[length] = '\0';
+                    return true;
+                }
+                if (length + 1 < capacity) {
+                    line[length++] = c;
+                }
+            }
+        }
+    private:
+        int fd_;
+        size_t begin_;
+        size_t end_;
+        char buffer_[4096];
+    };
+    
+    // "Name:   1234 kB" 中的数值（字节）
+    size_t smaps_kb_field(const char* line, const char* name) {
+        size_t name_length = std::strlen(name);
+        if (std::strncmp(line, name, name_length) != 0 || line[name_length] != ':') {
+            return SIZE_MAX;
+        }
+        return static_cast<size_t>(std::strtoull(line + name_length + 1, nullptr, 10)) * 1024;
+    }
+}
+
+size_t MemorySource::huge_page_bytes(const void* ptr, size_t size) {
+    ProcLineReader reader("/proc/self/smaps");
+    if (!reader.ok() || size == 0) {
+        return 0;
+    }
+    
+    const uintptr_t range_start = reinterpret_cast<uintptr_t>(ptr);
+    const uintptr_t range_end = range_start + size;
+    size_t total = 0;
+    size_t overlap = 0;        // 当前映射与查询区间的重叠字节数
+    size_t rss = 0;
+    size_t anon_huge = 0;
+    size_t kernel_page = 0;
+    
+    auto finish_mapping = [&] {
+        if (overlap != 0) {
+            size_t huge = kernel_page >= HUGE_PAGE_SIZE ? rss : anon_huge;
+            total += huge < overlap ? huge : overlap;
+        }
+        overlap = rss = anon_huge = kernel_page = 0;
+    };
+    
+    char line[256];
+    while (reader.next(line, sizeof(line))) {
+        char* dash = nullptr;
+        unsigned long long start = std::strtoull(line, &dash, 16);
+        if (dash != line && *dash == '-') {
+            // 映射头部行："start-end perms offset dev inode path"
+            finish_mapping();
+            unsigned long long end = std::strtoull(dash + 1, nullptr, 16);
+            uintptr_t lo = start > range_start ? start : range_start;
+            uintptr_t hi = end < range_end ? end : range_end;
+            overlap = hi > lo ? hi - lo : 0;
+            continue;
+        }
+        if (overlap == 0) {
+            continue;
+        }
+        size_t value;
+        if ((value = smaps_kb_field(line, "Rss")) != SIZE_MAX) {
+            rss = value;
+        } else if ((value = smaps_kb_field(line, "AnonHugePages")) != SIZE_MAX) {
+            anon_huge = value;
+        } else if ((value = smaps_kb_field(line, "KernelPageSize")) != SIZE_MAX) {
+            kernel_page = value;
+        }
+    }
+    finish_mapping();
+    return total;
+}
+
+bool MemorySource::transparent_huge_pages_available() {
+    ProcLineReader reader("/sys/kernel/mm/transparent_hugepage/enabled");
+    char line[128];
+    if (!reader.ok() || !reader.next(line, sizeof(line))) {
+        return false;
     }
+    return std::strstr(line, "[always]") != nullptr || std::strstr(line, "[madvise]") != nullptr;
 }
 
 size_t MemorySource::align_to_page(size_t size) const {
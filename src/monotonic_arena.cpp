@@ -0,0 +1,213 @@
+#include "axontzz/monotonic_arena.h"
+#include "axontzz/trace.h"
+#include <algorithm>
+#include <cstring>
+
+namespace memplumber {
+
+namespace {
+    char* align_up(char* ptr, size_t alignment) {
+        return reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(ptr) + alignment - 1) & ~(alignment - 1));
+    }
+}
+
+MonotonicArena::MonotonicArena(MemorySource& memory_source,
+                               size_t initial_block_size,
+                               size_t max_block_size)
+    : memory_source_(memory_source)
+    , page_map_(memory_source)
+    , initial_block_size_(memory_source.align_to_page(std::max(initial_block_size, sizeof(Block) + 1)))
+    , max_block_size_(std::max(max_block_size, initial_block_size_))
+    , next_block_size_(initial_block_size_)
+    , head_(nullptr)
+    , current_(nullptr)
+    , cursor_(nullptr)
+    , limit_(nullptr)
+    , last_(nullptr)
+    , used_bytes_(0)
+    , used_blocks_(0)
+    , block_count_(0)
+    , reserved_bytes_(0)
+    , stats_() {
+    MP_TRACE_INFO("MonotonicArena created: initial block %zu, max block %zu",
+                  initial_block_size_, max_block_size_);
+}
+
+MonotonicArena::~MonotonicArena() {
+    release();
+    MP_TRACE_INFO("MonotonicArena destroyed");
+}
+
+void* MonotonicArena::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    // 确保对齐是2的幂
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        alignment = sizeof(void*);
+    }
+
+    // 快速路径：当前块剩余空间足够时只移动游标（尚无块时 limit_ 为空，必然走慢路径）
+    char* ptr = align_up(cursor_, alignment);
+    if (ptr > limit_ || size > static_cast<size_t>(limit_ - ptr)) {
+        return allocate_slow(size, alignment);
+    }
+    cursor_ = ptr + size;
+    last_ = ptr;
+    set_used_bytes(used_bytes() + size);
+    stats_.record_local_allocation(size);
+    MP_TRACE_EVENT(Allocate, ptr, size, alignment);
+    return ptr;
+}
+
+void* MonotonicArena::allocate_slow(size_t size, size_t alignment) {
+    if (size > SIZE_MAX / 2 - alignment) {
+        stats_.record_local_failure();
+        return nullptr;
+    }
+    const size_t needed = size + alignment - 1;
+
+    // 优先使用游标之后保留下来的块（reset/rollback 之后），放不下时在它前面插入新块
+    Block* spare = current_ != nullptr ? current_->next : head_;
+    Block* block = spare;
+    if (block == nullptr || static_cast<size_t>(block_end(block) - block_begin(block)) < needed) {
+        block = create_block(needed);
+        if (block == nullptr) {
+            MP_TRACE_WARN("MonotonicArena failed to get a block for %zu bytes", size);
+            MP_TRACE_EVENT(AllocateFailed, size, alignment, 0);
+            stats_.record_local_failure();
+            return nullptr;
+        }
+        block->next = spare;
+        if (current_ != nullptr) {
+            current_->next = block;
+        } else {
+            head_ = block;
+        }
+    }
+    enter_block(block);
+
+    char* ptr = align_up(cursor_, alignment);
+    cursor_ = ptr + size;
+    last_ = ptr;
+    set_used_bytes(used_bytes() + size);
+    stats_.record_local_allocation(size);
+    MP_TRACE_EVENT(Allocate, ptr, size, alignment);
+    return ptr;
+}
+
+void MonotonicArena::deallocate(void* ptr, size_t size) {
+    // 单个对象不回收，内存只随 reset()/rollback() 整体归还
+    MP_TRACE_EVENT(Deallocate, ptr, size, 0);
+}
+
+void* MonotonicArena::reallocate(void* ptr, size_t old_size, size_t new_size, size_t alignment) {
+    if (ptr == nullptr) {
+        return allocate(new_size, alignment);
+    }
+    if (new_size == 0) {
+        return nullptr;
+    }
+
+    // 最近一次分配位于游标末端，可以原地伸缩
+    if (ptr == last_ && new_size <= static_cast<size_t>(limit_ - last_)) {
+        cursor_ = last_ + new_size;
+        set_used_bytes(used_bytes() - old_size + new_size);
+        MP_TRACE_EVENT(Reallocate, ptr, old_size, new_size);
+        return ptr;
+    }
+    if (new_size <= old_size) {
+        return ptr;
+    }
+
+    void* fresh = allocate(new_size, alignment);
+    if (fresh != nullptr) {
+        std::memcpy(fresh, ptr, old_size);
+        MP_TRACE_EVENT(Reallocate, fresh, old_size, new_size);
+    }
+    return fresh;
+}
+
+bool MonotonicArena::owns(void* ptr) const {
+    if (ptr == nullptr) {
+        return false;
+    }
+
+    // 通过页映射查找所属块，不访问可能未映射的内存
+    Block* block = static_cast<Block*>(page_map_.lookup(ptr));
+    return block != nullptr && static_cast<char*>(ptr) >= block_begin(block);
+}
+
+MonotonicArena::AllocatorStats MonotonicArena::get_stats() const {
+    AllocatorStats stats = stats_.snapshot();
+    stats.current_usage = used_bytes();
+    return stats;
+}
+
+void MonotonicArena::reset_stats() {
+    stats_.clear();
+}
+
+void MonotonicArena::rollback(const Checkpoint& checkpoint) {
+    // 检查点之后进入的块留在链表中，成为后续分配的备用块
+    current_ = checkpoint.block;
+    cursor_ = checkpoint.cursor;
+    limit_ = current_ != nullptr ? block_end(current_) : nullptr;
+    last_ = nullptr;
+    set_used_bytes(checkpoint.used_bytes);
+    used_blocks_ = checkpoint.used_blocks;
+}
+
+void MonotonicArena::reset() {
+    rollback(Checkpoint{});
+    MP_TRACE_DEBUG("MonotonicArena reset, keeping %zu blocks (%zu bytes)", block_count_, reserved_bytes_);
+}
+
+void MonotonicArena::release() {
+    while (head_ != nullptr) {
+        Block* block = head_;
+        head_ = block->next;
+        page_map_.clear_range(block, block->size);
+        memory_source_.deallocate_block(block, block->size);
+    }
+    rollback(Checkpoint{});
+    block_count_ = 0;
+    reserved_bytes_ = 0;
+    next_block_size_ = initial_block_size_;
+}
+
+MonotonicArena::Block* MonotonicArena::create_block(size_t min_size) {
+    // 常规块按几何级数增长；超出当前块大小的请求单独占用一个块，不影响增长
+    const bool oversized = min_size > next_block_size_ - sizeof(Block);
+    const size_t size = memory_source_.block_size_for(oversized ? min_size + sizeof(Block) : next_block_size_);
+    void* memory = memory_source_.allocate_block(size);
+    if (memory == nullptr) {
+        return nullptr;
+    }
+    if (!page_map_.set_range(memory, size, memory)) {
+        memory_source_.deallocate_block(memory, size);
+        return nullptr;
+    }
+
+    Block* block = static_cast<Block*>(memory);
+    block->next = nullptr;
+    block->size = size;
+    block_count_++;
+    reserved_bytes_ += size;
+    if (!oversized) {
+        next_block_size_ = std::min(next_block_size_ * 2, max_block_size_);
+    }
+    MP_TRACE_DEBUG("MonotonicArena mapped block %p (%zu bytes)", memory, size);
+    MP_TRACE_EVENT(ExpandHeap, memory, size, 0);
+    return block;
+}
+
+void MonotonicArena::enter_block(Block* block) {
+    current_ = block;
+    cursor_ = block_begin(block);
+    limit_ = block_end(block);
+    used_blocks_++;
+}
+
+} // namespace memplumber
@@ -0,0 +1,159 @@
+#include "axontzz/numa.h"
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace memplumber {
+namespace numa {
+
+namespace {
+    constexpr size_t kQueryBatch = 64; // 每次 move_pages 查询的页数
+
+    int policy_mode(Policy policy) {
+        return policy == Policy::Bind ? MPOL_BIND : MPOL_PREFERRED;
+    }
+
+    // maxnode 按内核的约定比掩码位数多一
+    constexpr unsigned long kMaskBits = sizeof(unsigned long) * 8 + 1;
+
+    // 读取 sysfs 的编号列表（形如 "0-3,8-11"），对每个区间调用 visit(first, last)
+    template <typename Visit>
+    bool read_list(const char* path, Visit visit) {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return false;
+        }
+        char buffer[4096];
+        ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+        close(fd);
+        if (length <= 0) {
+            return false;
+        }
+
+        int first = -1;
+        int value = -1;
+        for (ssize_t i = 0; i <= length; ++i) {
+            const char c = i < length ? buffer[i] : '\n';
+            if (c >= '0' && c <= '9') {
+                value = (value < 0 ? 0 : value * 10) + (c - '0');
+            } else if (c == '-') {
+                first = value;
+                value = -1;
+            } else {
+                if (value >= 0) {
+                    visit(first >= 0 ? first : value, value);
+                }
+                first = -1;
+                value = -1;
+            }
+        }
+        return true;
+    }
+}
+
+int online_nodes() {
+    // 形如 "0-1" 或 "0,2-3"：取出现的最大编号
+    int highest = 0;
+    if (!read_list("/sys/devices/system/node/online", [&](int, int last) {
+            highest = last > highest ? last : highest;
+        })) {
+        return 1;
+    }
+    return highest + 1 < MAX_NODES ? highest + 1 : MAX_NODES;
+}
+
+int node_of_cpu(int cpu) {
+    // 每个 CPU 目录下有指向所属节点的 nodeN 链接
+    const int nodes = online_nodes();
+    char path[96];
+    for (int node = 0; node < nodes; ++node) {
+        std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/node%d", cpu, node);
+        if (access(path, F_OK) == 0) {
+            return node;
+        }
+    }
+    return 0;
+}
+
+void cpu_nodes(int nodes, unsigned char* table, size_t cpus) {
+    for (size_t cpu = 0; cpu < cpus; ++cpu) {
+        table[cpu] = 0;
+    }
+    // 每个节点只读一次 cpulist，而不是逐个 CPU 探测
+    char path[64];
+    for (int node = 0; node < nodes && node < MAX_NODES; ++node) {
+        std::snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        read_list(path, [&](int first, int last) {
+            for (int cpu = first; cpu <= last && static_cast<size_t>(cpu) < cpus; ++cpu) {
+                table[cpu] = static_cast<unsigned char>(node);
+            }
+        });
+    }
+}
+
+bool bind_range(void* ptr, size_t size, int node, Policy policy) {
+    if (node < 0 || node >= MAX_NODES || size == 0) {
+        return false;
+    }
+    unsigned long mask = 1ul << node;
+    return syscall(SYS_mbind, ptr, size, policy_mode(policy), &mask, kMaskBits, 0) == 0;
+}
+
+bool set_thread_policy(int node, Policy policy) {
+    if (node == NO_NODE) {
+        return syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+    }
+    if (node < 0 || node >= MAX_NODES) {
+        return false;
+    }
+    unsigned long mask = 1ul << node;
+    return syscall(SYS_set_mempolicy, policy_mode(policy), &mask, kMaskBits) == 0;
+}
+
+int page_node(const void* ptr) {
+    const uintptr_t page_size = static_cast<uintptr_t>(getpagesize());
+    void* page = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(ptr) & ~(page_size - 1));
+    int status = NO_NODE;
+    // nodes 为空时只查询，不搬动
+    if (syscall(SYS_move_pages, 0, 1ul, &page, nullptr, &status, 0) != 0 || status < 0) {
+        return NO_NODE;
+    }
+    return status;
+}
+
+size_t pages_on_node(const void* ptr, size_t size, int node, size_t* resident) {
+    const uintptr_t page_size = static_cast<uintptr_t>(getpagesize());
+    uintptr_t page = reinterpret_cast<uintptr_t>(ptr) & ~(page_size - 1);
+    const uintptr_t end = reinterpret_cast<uintptr_t>(ptr) + size;
+    size_t on_node = 0;
+    size_t present = 0;
+
+    void* pages[kQueryBatch];
+    int status[kQueryBatch];
+    while (page < end) {
+        unsigned long count = 0;
+        for (; count < kQueryBatch && page < end; ++count, page += page_size) {
+            pages[count] = reinterpret_cast<void*>(page);
+        }
+        if (syscall(SYS_move_pages, 0, count, pages, nullptr, status, 0) != 0) {
+            break;
+        }
+        for (unsigned long i = 0; i < count; ++i) {
+            // 未驻留的页报告 -ENOENT
+            if (status[i] >= 0) {
+                ++present;
+                on_node += status[i] == node ? 1 : 0;
+            }
+        }
+    }
+    if (resident != nullptr) {
+        *resident = present;
+    }
+    return on_node;
+}
+
+} // namespace numa
+} // namespace memplumber
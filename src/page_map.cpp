@@ -0,0 +1,145 @@
+#include "axontzz/page_map.h"
+#include "axontzz/trace.h"
+
+namespace memplumber {
+
+PageMap::PageMap(MemorySource& memory_source)
+    : memory_source_(memory_source)
+    , root_(nullptr)
+    , node_count_(0) {
+}
+
+PageMap::~PageMap() {
+    release_nodes();
+}
+
+bool PageMap::set_range(void* start, size_t size, void* value) {
+    if (size == 0) {
+        return true;
+    }
+
+    uintptr_t first = reinterpret_cast<uintptr_t>(start) >> PAGE_SHIFT;
+    uintptr_t last = (reinterpret_cast<uintptr_t>(start) + size - 1) >> PAGE_SHIFT;
+    if (last >> (3 * LEVEL_BITS) != 0) {
+        MP_TRACE_WARN("PageMap: range %p+%zu is outside the %zu-bit address space",
+                      start, size, ADDRESS_BITS);
+        return false;
+    }
+
+    // 逐个叶子节点填充，叶子内部按页连续写入
+    uintptr_t page = first;
+    while (page <= last) {
+        Leaf* leaf = leaf_for(page, true);
+        if (leaf == nullptr) {
+            return false;
+        }
+        uintptr_t leaf_end = (page | (NODE_ENTRIES - 1));
+        uintptr_t stop = leaf_end < last ? leaf_end : last;
+        for (; page <= stop; ++page) {
+            leaf->values[page & (NODE_ENTRIES - 1)].store(value, std::memory_order_release);
+        }
+    }
+    return true;
+}
+
+void PageMap::clear_range(void* start, size_t size) {
+    if (size == 0) {
+        return;
+    }
+
+    uintptr_t first = reinterpret_cast<uintptr_t>(start) >> PAGE_SHIFT;
+    uintptr_t last = (reinterpret_cast<uintptr_t>(start) + size - 1) >> PAGE_SHIFT;
+    if (last >> (3 * LEVEL_BITS) != 0) {
+        return;
+    }
+
+    uintptr_t page = first;
+    while (page <= last) {
+        uintptr_t leaf_end = (page | (NODE_ENTRIES - 1));
+        uintptr_t stop = leaf_end < last ? leaf_end : last;
+        Leaf* leaf = leaf_for(page, false);
+        if (leaf != nullptr) {
+            for (uintptr_t p = page; p <= stop; ++p) {
+                leaf->values[p & (NODE_ENTRIES - 1)].store(nullptr, std::memory_order_release);
+            }
+        }
+        page = stop + 1;
+    }
+}
+
+void* PageMap::allocate_node() {
+    // mmap 返回的内存已清零，原子指针的全零表示即为 nullptr
+    void* node = memory_source_.allocate_block(NODE_BYTES);
+    if (node == nullptr) {
+        MP_TRACE_WARN("PageMap: failed to allocate %zu byte radix node", NODE_BYTES);
+        return nullptr;
+    }
+    node_count_++;
+    return node;
+}
+
+PageMap::Leaf* PageMap::leaf_for(uintptr_t page, bool create) {
+    Interior* root = root_.load(std::memory_order_acquire);
+    if (root == nullptr) {
+        if (!create) {
+            return nullptr;
+        }
+        root = static_cast<Interior*>(allocate_node());
+        if (root == nullptr) {
+            return nullptr;
+        }
+        root_.store(root, std::memory_order_release);
+    }
+
+    std::atomic<Interior*>& middle_slot = root->children[page >> (2 * LEVEL_BITS)];
+    Interior* middle = middle_slot.load(std::memory_order_acquire);
+    if (middle == nullptr) {
+        if (!create) {
+            return nullptr;
+        }
+        middle = static_cast<Interior*>(allocate_node());
+        if (middle == nullptr) {
+            return nullptr;
+        }
+        middle_slot.store(middle, std::memory_order_release);
+    }
+
+    std::atomic<Interior*>& leaf_slot = middle->children[(page >> LEVEL_BITS) & (NODE_ENTRIES - 1)];
+    Leaf* leaf = reinterpret_cast<Leaf*>(leaf_slot.load(std::memory_order_acquire));
+    if (leaf == nullptr) {
+        if (!create) {
+            return nullptr;
+        }
+        leaf = static_cast<Leaf*>(allocate_node());
+        if (leaf == nullptr) {
+            return nullptr;
+        }
+        leaf_slot.store(reinterpret_cast<Interior*>(leaf), std::memory_order_release);
+    }
+    return leaf;
+}
+
+void PageMap::release_nodes() {
+    Interior* root = root_.load(std::memory_order_acquire);
+    if (root == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < NODE_ENTRIES; ++i) {
+        Interior* middle = root->children[i].load(std::memory_order_relaxed);
+        if (middle == nullptr) {
+            continue;
+        }
+        for (size_t j = 0; j < NODE_ENTRIES; ++j) {
+            Interior* leaf = middle->children[j].load(std::memory_order_relaxed);
+            if (leaf != nullptr) {
+                memory_source_.deallocate_block(leaf, NODE_BYTES);
+            }
+        }
+        memory_source_.deallocate_block(middle, NODE_BYTES);
+    }
+    memory_source_.deallocate_block(root, NODE_BYTES);
+    root_.store(nullptr, std::memory_order_release);
+    node_count_ = 0;
+}
+
+} // namespace memplumber
@@ -0,0 +1,211 @@
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "axontzz/allocator_interface.h"
+
+/**
+ * C allocation interface for LD_PRELOAD (bin/libaxontzz.so)
+ *
+ * Exports the malloc family on top of the global allocator that also
+ * backs operator new/delete in the same library, so C and C++ allocations
+ * of a preloaded program share one heap and its per-thread caches:
+ *
+ *   LD_PRELOAD=./bin/libaxontzz.so some_program
+ *
+ * Setting AXONTZZ_STATS=1 prints the allocation counters to stderr when
+ * the program exits (also a quick way to check the library is active).
+ */
+
+namespace memplumber {
+    namespace global {
+        AllocatorInterface::AllocatorStats get_global_allocator_stats();
+        void* global_allocate(std::size_t size, std::size_t alignment);
+        void* global_allocate_zeroed(std::size_t size, std::size_t alignment);
+        void global_deallocate(void* ptr);
+        void* global_reallocate(void* ptr, std::size_t size);
+        std::size_t global_allocation_size(void* ptr);
+        void global_allocator_prepare_fork();
+        void global_allocator_after_fork();
+    }
+}
+
+namespace {
+    using namespace memplumber::global;
+
+    // malloc 的结果须满足 max_align_t 对齐
+    constexpr std::size_t kMallocAlignment = alignof(std::max_align_t);
+
+    inline bool is_power_of_two(std::size_t value) {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    // 0 字节请求也返回唯一指针；失败按 C 约定设置 errno
+    void* allocate_or_fail(std::size_t size, std::size_t alignment) {
+        void* ptr = global_allocate(size != 0 ? size : 1,
+                                    alignment < kMallocAlignment ? kMallocAlignment : alignment);
+        if (ptr == nullptr) {
+            errno = ENOMEM;
+        }
+        return ptr;
+    }
+
+    void* reallocate(void* ptr, std::size_t size) {
+        if (ptr == nullptr) {
+            return allocate_or_fail(size, kMallocAlignment);
+        }
+        if (size == 0) {
+            global_deallocate(ptr);
+            return nullptr;
+        }
+
+        // 大块原地增长/缩小，其余复制；失败时原块保持有效
+        void* result = global_reallocate(ptr, size);
+        if (result == nullptr) {
+            errno = ENOMEM;
+        }
+        return result;
+    }
+
+    std::size_t page_size() {
+        static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    void prepare_fork() { global_allocator_prepare_fork(); }
+    void after_fork() { global_allocator_after_fork(); }
+
+    // AXONTZZ_STATS 开启时复制的 stderr：程序自己的 atexit 可能已关闭 2 号描述符
+    int report_fd = -1;
+
+    __attribute__((constructor)) void install_hooks() {
+        pthread_atfork(prepare_fork, after_fork, after_fork);
+
+        const char* flag = std::getenv("AXONTZZ_STATS");
+        if (flag != nullptr && flag[0] != '\0' && flag[0] != '0') {
+            report_fd = fcntl(STDERR_FILENO, F_DUPFD_CLOEXEC, 3);
+        }
+    }
+
+    // 退出时报告计数：只用栈缓冲区与 write(2)，此时 stdio 可能已关闭
+    __attribute__((destructor)) void report_stats() {
+        if (report_fd < 0) {
+            return;
+        }
+        memplumber::AllocatorInterface::AllocatorStats stats = get_global_allocator_stats();
+        char line[256];
+        int length = std::snprintf(line, sizeof(line),
+                                   "axontzz: allocations=%zu deallocations=%zu "
+                                   "bytes_allocated=%zu current_usage=%zu failed=%zu\n",
+                                   stats.allocation_count, stats.deallocation_count,
+                                   stats.total_allocated, stats.current_usage,
+                                   stats.failed_allocations);
+        if (length > 0) {
+            ssize_t written = ::write(report_fd, line,
+                                      static_cast<std::size_t>(length) < sizeof(line)
+                                          ? static_cast<std::size_t>(length) : sizeof(line) - 1);
+            (void)written;
+        }
+        close(report_fd);
+    }
+}
+
+extern "C" {
+
+void* malloc(std::size_t size) noexcept {
+    return allocate_or_fail(size, kMallocAlignment);
+}
+
+void free(void* ptr) noexcept {
+    global_deallocate(ptr);
+}
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+    std::size_t bytes;
+    if (__builtin_mul_overflow(count, size, &bytes)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    // 复用的块由分配器清零，仍是内核零页的大块跳过 memset
+    void* ptr = global_allocate_zeroed(bytes != 0 ? bytes : 1, kMallocAlignment);
+    if (ptr == nullptr) {
+        errno = ENOMEM;
+    }
+    return ptr;
+}
+
+void* realloc(void* ptr, std::size_t size) noexcept {
+    return reallocate(ptr, size);
+}
+
+void* reallocarray(void* ptr, std::size_t count, std::size_t size) noexcept {
+    std::size_t bytes;
+    if (__builtin_mul_overflow(count, size, &bytes)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return reallocate(ptr, bytes);
+}
+
+int posix_memalign(void** out, std::size_t alignment, std::size_t size) noexcept {
+    if (!is_power_of_two(alignment) || alignment % sizeof(void*) != 0) {
+        return EINVAL;
+    }
+    int saved_errno = errno; // posix_memalign 通过返回值报告错误，不改 errno
+    void* ptr = allocate_or_fail(size, alignment);
+    errno = saved_errno;
+    if (ptr == nullptr) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    if (!is_power_of_two(alignment)) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return allocate_or_fail(size, alignment);
+}
+
+// 以下为 glibc 的旧接口：程序用它们分配、再用 free 释放，因此也必须接管
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+    if (!is_power_of_two(alignment)) {
+        if (alignment > SIZE_MAX / 2) {
+            errno = EINVAL;
+            return nullptr;
+        }
+        std::size_t rounded = kMallocAlignment;
+        while (rounded < alignment) {
+            rounded <<= 1;
+        }
+        alignment = rounded;
+    }
+    return allocate_or_fail(size, alignment);
+}
+
+void* valloc(std::size_t size) noexcept {
+    return allocate_or_fail(size, page_size());
+}
+
+void* pvalloc(std::size_t size) noexcept {
+    std::size_t page = page_size();
+    if (size > SIZE_MAX - page) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return allocate_or_fail((size + page - 1) & ~(page - 1), page);
+}
+
+std::size_t malloc_usable_size(void* ptr) noexcept {
+    return ptr != nullptr ? global_allocation_size(ptr) : 0;
+}
+
+}
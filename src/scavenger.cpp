@@ -0,0 +1,86 @@
+#include "axontzz/scavenger.h"
+#include "axontzz/trace.h"
+
+namespace memplumber {
+
+Scavenger::Scavenger(IdleFunction idle, TrimFunction trim, Policy policy)
+    : idle_(std::move(idle))
+    , trim_(std::move(trim))
+    , policy_(policy)
+    , stopping_(false)
+    , woken_(false)
+    , passes_(0)
+    , trims_(0)
+    , released_bytes_(0) {
+    // 所有成员初始化完成后再启动线程
+    thread_ = std::thread(&Scavenger::run, this);
+}
+
+Scavenger::~Scavenger() {
+    stop();
+}
+
+void Scavenger::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        woken_ = true;
+    }
+    wakeup_.notify_one();
+}
+
+void Scavenger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    wakeup_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+size_t Scavenger::passes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return passes_;
+}
+
+size_t Scavenger::trims() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return trims_;
+}
+
+size_t Scavenger::released_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return released_bytes_;
+}
+
+void Scavenger::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wakeup_.wait_for(lock, policy_.interval, [this] { return stopping_ || woken_; });
+        if (stopping_) {
+            return;
+        }
+        woken_ = false;
+
+        // 回调会获取分配器的锁，调用期间不持有自己的锁
+        lock.unlock();
+        const size_t idle = idle_();
+        size_t released = 0;
+        bool trimmed = false;
+        if (idle > policy_.idle_threshold) {
+            released = trim_(policy_.retain);
+            trimmed = true;
+            MP_TRACE_INFO("Scavenger: %zu idle bytes, released %zu", idle, released);
+        }
+        lock.lock();
+
+        passes_++;
+        if (trimmed) {
+            trims_++;
+            released_bytes_ += released;
+        }
+    }
+}
+
+} // namespace memplumber
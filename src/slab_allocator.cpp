@@ -0,0 +1,296 @@
+#include "axontzz/slab_allocator.h"
+#include "axontzz/trace.h"
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+namespace memplumber {
+
+namespace {
+    // 每个板块至少容纳的对象数，避免大对象时板块利用率过低
+    constexpr size_t MIN_OBJECTS_PER_SLAB = 8;
+
+    size_t round_up(size_t value, size_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+SlabAllocator::SlabAllocator(MemorySource& memory_source,
+                             size_t object_size,
+                             size_t slab_size,
+                             size_t max_empty_slabs)
+    : memory_source_(memory_source)
+    , page_map_(memory_source)
+    , object_size_(object_size)
+    , slot_size_(0)
+    , slot_alignment_(0)
+    , slab_size_(0)
+    , first_slot_offset_(0)
+    , objects_per_slab_(0)
+    , max_empty_slabs_(max_empty_slabs)
+    , partial_{}
+    , full_{}
+    , empty_{}
+    , stats_()
+    , owner_thread_(std::this_thread::get_id())
+    , remote_free_count_(0)
+    , remote_frees_() {
+
+    if (object_size == 0) {
+        throw std::invalid_argument("SlabAllocator: object_size must be non-zero");
+    }
+
+    // 槽位至少能放下空闲链表指针，并保持字长对齐
+    slot_size_ = round_up(std::max(object_size, sizeof(FreeSlot)), sizeof(void*));
+
+    // 槽位的自然对齐 = 槽位大小的最低位，不超过一页
+    slot_alignment_ = std::min(slot_size_ & (~slot_size_ + 1), memory_source_.get_page_size());
+    first_slot_offset_ = round_up(sizeof(Slab), slot_alignment_);
+
+    // 板块大小取页对齐后的2的幂，以便通过掩码找到板块头部
+    slab_size_ = memory_source_.get_page_size();
+    while (slab_size_ < slab_size ||
+           (slab_size_ - first_slot_offset_) / slot_size_ < MIN_OBJECTS_PER_SLAB) {
+        slab_size_ <<= 1;
+    }
+    objects_per_slab_ = (slab_size_ - first_slot_offset_) / slot_size_;
+
+    MP_TRACE_INFO("SlabAllocator created: object=%zu slot=%zu align=%zu slab=%zu objects/slab=%zu",
+                  object_size_, slot_size_, slot_alignment_, slab_size_, objects_per_slab_);
+}
+
+SlabAllocator::~SlabAllocator() {
+    // 释放所有板块（包括仍有存活对象的板块）
+    SlabList* lists[] = {&partial_, &full_, &empty_};
+    for (SlabList* list : lists) {
+        while (list->head != nullptr) {
+            Slab* slab = list->head;
+            list_remove(*list, slab);
+            destroy_slab(slab);
+        }
+    }
+    MP_TRACE_INFO("SlabAllocator destroyed");
+}
+
+void* SlabAllocator::allocate(size_t size, size_t alignment) {
+    if (size == 0) {
+        return nullptr;
+    }
+
+    // 确保对齐是2的幂
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        alignment = sizeof(void*);
+    }
+
+    if (size > object_size_ || alignment > slot_alignment_) {
+        MP_TRACE_WARN("SlabAllocator cannot serve %zu bytes (alignment %zu), object size is %zu",
+                      size, alignment, object_size_);
+        stats_.record_local_failure();
+        return nullptr;
+    }
+
+    // 其他线程释放的对象先批量归还，腾出的槽位可以立即复用
+    if (!remote_frees_.empty()) {
+        drain_remote_frees();
+    }
+
+    // 优先使用部分占用的板块，其次是缓存的空板块，最后向OS申请
+    Slab* slab = partial_.head;
+    if (slab == nullptr) {
+        slab = empty_.head;
+        if (slab == nullptr) {
+            slab = create_slab();
+            if (slab == nullptr) {
+                stats_.record_local_failure();
+                return nullptr;
+            }
+        }
+    }
+
+    void* ptr;
+    if (slab->free_slots != nullptr) {
+        FreeSlot* slot = slab->free_slots;
+        slab->free_slots = slot->next;
+        ptr = slot;
+    } else {
+        ptr = slab->bump;
+        slab->bump += slot_size_;
+    }
+    slab->used++;
+
+    if (slab->used == objects_per_slab_) {
+        move_to(slab, full_);
+    } else if (slab->list != &partial_) {
+        move_to(slab, partial_);
+    }
+
+    stats_.record_local_allocation(object_size_);
+    MP_TRACE_DEBUG("SlabAllocator allocated %p from slab %p (%zu/%zu used)",
+                   ptr, static_cast<void*>(slab), slab->used, objects_per_slab_);
+    MP_TRACE_EVENT(Allocate, ptr, size, alignment);
+    return ptr;
+}
+
+void SlabAllocator::deallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+        return;
+    }
+
+    // 先通过页映射确认所属板块，外来指针的掩码地址可能并未映射
+    Slab* slab = static_cast<Slab*>(page_map_.lookup(ptr));
+    if (slab == nullptr || slab->owner != this) {
+        MP_TRACE_WARN("Warning: Attempt to deallocate pointer %p not owned by this SlabAllocator", ptr);
+        return;
+    }
+
+    // 非所有者线程：只压入远程释放队列，由所有者在下次分配时统一处理
+    if (std::this_thread::get_id() != owner_thread_) {
+        remote_frees_.push(ptr);
+        MP_TRACE_EVENT(Deallocate, ptr, size, slot_size_);
+        return;
+    }
+
+    free_slot(slab, ptr);
+    MP_TRACE_EVENT(Deallocate, ptr, size, slot_size_);
+}
+
+size_t SlabAllocator::drain_remote_frees() {
+    size_t count = 0;
+    RemoteFreeQueue::Node* node = remote_frees_.take_all();
+    while (node != nullptr) {
+        RemoteFreeQueue::Node* next = node->next;
+        free_slot(slab_of(node), node);
+        node = next;
+        count++;
+    }
+    remote_free_count_ += count;
+    if (count != 0) {
+        MP_TRACE_DEBUG("SlabAllocator drained %zu remote frees", count);
+    }
+    return count;
+}
+
+void SlabAllocator::free_slot(Slab* slab, void* ptr) {
+    FreeSlot* slot = static_cast<FreeSlot*>(ptr);
+    slot->next = slab->free_slots;
+    slab->free_slots = slot;
+    slab->used--;
+
+    if (slab->used == 0) {
+        move_to(slab, empty_);
+
+        // 空板块超过阈值时归还给OS
+        if (empty_.count > max_empty_slabs_) {
+            list_remove(empty_, slab);
+            destroy_slab(slab);
+        }
+    } else if (slab->list == &full_) {
+        move_to(slab, partial_);
+    }
+
+    stats_.record_local_deallocation(object_size_);
+    MP_TRACE_DEBUG("SlabAllocator freed %p", ptr);
+}
+
+bool SlabAllocator::owns(void* ptr) const {
+    if (ptr == nullptr) {
+        return false;
+    }
+
+    // 通过页映射查找所属板块，不访问可能未映射的内存
+    const char* slab = static_cast<const char*>(page_map_.lookup(ptr));
+    return slab != nullptr && static_cast<const char*>(ptr) >= slab + first_slot_offset_;
+}
+
+SlabAllocator::AllocatorStats SlabAllocator::get_stats() const {
+    return stats_.snapshot();
+}
+
+void SlabAllocator::reset_stats() {
+    stats_.clear();
+}
+
+void SlabAllocator::release_empty_slabs() {
+    while (empty_.head != nullptr) {
+        Slab* slab = empty_.head;
+        list_remove(empty_, slab);
+        destroy_slab(slab);
+    }
+}
+
+SlabAllocator::Slab* SlabAllocator::create_slab() {
+    void* memory = memory_source_.allocate_aligned_block(slab_size_, slab_size_);
+    if (memory == nullptr) {
+        MP_TRACE_WARN("Failed to allocate %zu byte slab from OS", slab_size_);
+        return nullptr;
+    }
+
+    if (!page_map_.set_range(memory, slab_size_, memory)) {
+        memory_source_.deallocate_block(memory, slab_size_);
+        return nullptr;
+    }
+
+    Slab* slab = static_cast<Slab*>(memory);
+    slab->owner = this;
+    slab->next = nullptr;
+    slab->prev = nullptr;
+    slab->list = nullptr;
+    slab->free_slots = nullptr;
+    slab->bump = static_cast<char*>(memory) + first_slot_offset_;
+    slab->used = 0;
+    list_push(empty_, slab);
+
+    MP_TRACE_INFO("Created slab %p (%zu bytes)", memory, slab_size_);
+    MP_TRACE_EVENT(ExpandHeap, memory, slab_size_, 0);
+    return slab;
+}
+
+void SlabAllocator::destroy_slab(Slab* slab) {
+    MP_TRACE_INFO("Returning slab %p to OS", static_cast<void*>(slab));
+    slab->owner = nullptr;
+    page_map_.clear_range(slab, slab_size_);
+    memory_source_.deallocate_block(slab, slab_size_);
+}
+
+SlabAllocator::Slab* SlabAllocator::slab_of(void* ptr) const {
+    uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    return reinterpret_cast<Slab*>(addr & ~(static_cast<uintptr_t>(slab_size_) - 1));
+}
+
+void SlabAllocator::move_to(Slab* slab, SlabList& list) {
+    if (slab->list == &list) {
+        return;
+    }
+    if (slab->list != nullptr) {
+        list_remove(*slab->list, slab);
+    }
+    list_push(list, slab);
+}
+
+void SlabAllocator::list_push(SlabList& list, Slab* slab) {
+    slab->prev = nullptr;
+    slab->next = list.head;
+    if (list.head != nullptr) {
+        list.head->prev = slab;
+    }
+    list.head = slab;
+    slab->list = &list;
+    list.count++;
+}
+
+void SlabAllocator::list_remove(SlabList& list, Slab* slab) {
+    if (slab->prev != nullptr) {
+        slab->prev->next = slab->next;
+    } else {
+        list.head = slab->next;
+    }
+    if (slab->next != nullptr) {
+        slab->next->prev = slab->prev;
+    }
+    slab->next = nullptr;
+    slab->prev = nullptr;
+    slab->list = nullptr;
+    list.count--;
+}
+
+} // namespace memplumber
@@ -0,0 +1,151 @@
+#include "axontzz/trace.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#include <unistd.h>
+
+namespace memplumber {
+namespace trace {
+
+namespace {
+    static_assert((RING_CAPACITY & (RING_CAPACITY - 1)) == 0, "RING_CAPACITY must be a power of two");
+
+    // 每个槽位带一个发布序号：0 表示正在写入，否则为 sequence + 1
+    struct Slot {
+        std::atomic<uint64_t> published{0};
+        Event event;
+    };
+
+    Slot ring[RING_CAPACITY];
+    std::atomic<uint64_t> ring_head{0};
+    std::atomic<uint32_t> next_thread_id{1};
+    thread_local uint32_t thread_id = 0;
+
+    uint64_t now_ns() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    uint32_t current_thread() {
+        if (thread_id == 0) {
+            thread_id = next_thread_id.fetch_add(1, std::memory_order_relaxed);
+        }
+        return thread_id;
+    }
+
+    void write_all(int fd, const char* data, size_t length) {
+        while (length > 0) {
+            ssize_t written = ::write(fd, data, length);
+            if (written <= 0) {
+                return;
+            }
+            data += written;
+            length -= static_cast<size_t>(written);
+        }
+    }
+}
+
+void write_line(const char* format, ...) {
+    // 固定大小的栈缓冲区：不经过 iostream，也不会分配堆内存
+    char buffer[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(buffer, sizeof(buffer) - 1, format, args);
+    va_end(args);
+    if (length < 0) {
+        return;
+    }
+    size_t used = static_cast<size_t>(length);
+    if (used > sizeof(buffer) - 2) {
+        used = sizeof(buffer) - 2; // 截断过长的行
+    }
+    buffer[used++] = '\n';
+    write_all(STDERR_FILENO, buffer, used);
+}
+
+void record(EventType type, uintptr_t arg0, uintptr_t arg1, uintptr_t arg2) {
+    const uint64_t sequence = ring_head.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = ring[sequence & (RING_CAPACITY - 1)];
+
+    slot.published.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.event.sequence = sequence;
+    slot.event.timestamp_ns = now_ns();
+    slot.event.type = type;
+    slot.event.thread = current_thread();
+    slot.event.args[0] = arg0;
+    slot.event.args[1] = arg1;
+    slot.event.args[2] = arg2;
+    slot.published.store(sequence + 1, std::memory_order_release);
+}
+
+size_t snapshot(Event* out, size_t max_events) {
+    const uint64_t head = ring_head.load(std::memory_order_acquire);
+    uint64_t first = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+    if (head - first > max_events) {
+        first = head - max_events; // 只保留最新的 max_events 个事件
+    }
+
+    size_t copied = 0;
+    for (uint64_t sequence = first; sequence < head; ++sequence) {
+        const Slot& slot = ring[sequence & (RING_CAPACITY - 1)];
+        const uint64_t before = slot.published.load(std::memory_order_acquire);
+        Event event = slot.event;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t after = slot.published.load(std::memory_order_relaxed);
+        if (before == sequence + 1 && after == before) {
+            out[copied++] = event;
+        }
+    }
+    return copied;
+}
+
+uint64_t recorded_events() {
+    return ring_head.load(std::memory_order_relaxed);
+}
+
+void clear_ring() {
+    for (Slot& slot : ring) {
+        slot.published.store(0, std::memory_order_relaxed);
+    }
+    ring_head.store(0, std::memory_order_release);
+}
+
+void dump_ring(int fd) {
+    static Event events[RING_CAPACITY]; // 避免在栈上放置大数组
+    const size_t count = snapshot(events, RING_CAPACITY);
+
+    char line[160];
+    for (size_t i = 0; i < count; ++i) {
+        const Event& e = events[i];
+        int length = snprintf(line, sizeof(line), "%llu %llu t%u %s 0x%llx %llu %llu\n",
+                              static_cast<unsigned long long>(e.sequence),
+                              static_cast<unsigned long long>(e.timestamp_ns),
+                              e.thread, event_name(e.type),
+                              static_cast<unsigned long long>(e.args[0]),
+                              static_cast<unsigned long long>(e.args[1]),
+                              static_cast<unsigned long long>(e.args[2]));
+        if (length > 0) {
+            write_all(fd, line, static_cast<size_t>(length) < sizeof(line) ? static_cast<size_t>(length)
+                                                                            : sizeof(line) - 1);
+        }
+    }
+}
+
+const char* event_name(EventType type) {
+    switch (type) {
+        case EventType::Allocate:       return "allocate";
+        case EventType::AllocateFailed: return "allocate_failed";
+        case EventType::Deallocate:     return "deallocate";
+        case EventType::Coalesce:       return "coalesce";
+        case EventType::ExpandHeap:     return "expand_heap";
+        case EventType::ReleaseSpan:    return "release_span";
+        case EventType::Reallocate:     return "reallocate";
+    }
+    return "unknown";
+}
+
+} // namespace trace
+} // namespace memplumber
@@ -1,7 +1,10 @@
 #include "axontzz/memory_source.h"
+#include "axontzz/numa.h"
 #include <iostream>
 #include <cassert>
 #include <cstring>
+#include <thread>
+#include <vector>
 
 using namespace memplumber;
 
@@ -93,6 +96,323 @@ void test_large_allocations() {
     std::cout << "Large allocation tests passed!" << std::endl;
 }
 
+void test_huge_pages() {
+    std::cout << "Testing huge page policies..." << std::endl;
+    
+    constexpr size_t huge = MemorySource::HUGE_PAGE_SIZE;
+    
+    // Transparent: 大块按 2 MiB 取整并对齐，小块保持 4 KiB 粒度
+    {
+        MemorySource memory_source(MemorySource::HugePagePolicy::Transparent);
+        assert(memory_source.block_size_for(3 * 1024 * 1024) == 2 * huge);
+        assert(memory_source.block_size_for(64 * 1024) == 64 * 1024);
+        
+        void* block = memory_source.allocate_block(3 * 1024 * 1024);
+        assert(block != nullptr);
+        assert(reinterpret_cast<uintptr_t>(block) % huge == 0);
+        assert(memory_source.get_stats().current_usage == 2 * huge);
+        std::memset(block, 1, 2 * huge);
+        
+        size_t huge_bytes = MemorySource::huge_page_bytes(block, 2 * huge);
+        std::cout << "THP available: " << MemorySource::transparent_huge_pages_available()
+                  << ", advised blocks: " << memory_source.get_stats().hugepage_advised_blocks
+                  << ", huge bytes: " << huge_bytes << std::endl;
+        assert(huge_bytes <= 2 * huge);
+        assert(huge_bytes % huge == 0);
+        
+        void* small = memory_source.allocate_block(64 * 1024);
+        assert(small != nullptr);
+        memory_source.deallocate_block(small, 64 * 1024);
+        
+        // 对齐块不超过大页对齐时直接使用大页路径
+        void* aligned = memory_source.allocate_aligned_block(huge, huge);
+        assert(aligned != nullptr && reinterpret_cast<uintptr_t>(aligned) % huge == 0);
+        memory_source.deallocate_block(aligned, huge);
+        
+        memory_source.deallocate_block(block, 3 * 1024 * 1024);
+        assert(memory_source.get_stats().current_usage == 0);
+    }
+    
+    // Explicit: MAP_HUGETLB 成功，或在大页池为空时退回透明大页
+    {
+        MemorySource memory_source(MemorySource::HugePagePolicy::Explicit);
+        void* block = memory_source.allocate_block(huge);
+        assert(block != nullptr);
+        std::memset(block, 2, huge);
+        auto stats = memory_source.get_stats();
+        assert(stats.hugetlb_blocks + stats.hugetlb_fallbacks == 1);
+        std::cout << "MAP_HUGETLB blocks: " << stats.hugetlb_blocks
+                  << ", fallbacks: " << stats.hugetlb_fallbacks << std::endl;
+        memory_source.deallocate_block(block, huge);
+        assert(memory_source.get_stats().current_usage == 0);
+    }
+    
+    // 未映射的区间没有大页
+    MemorySource plain;
+    void* block = plain.allocate_block(huge);
+    assert(reinterpret_cast<uintptr_t>(block) % 4096 == 0);
+    plain.deallocate_block(block, huge);
+    assert(MemorySource::huge_page_bytes(block, huge) == 0);
+    
+    std::cout << "Huge page tests passed!" << std::endl;
+}
+
+void test_address_space_arena() {
+    std::cout << "Testing reserve-then-commit arena..." << std::endl;
+    
+    constexpr size_t reserve = 64 * 1024 * 1024;
+    MemorySource memory_source(MemorySource::HugePagePolicy::None, reserve);
+    assert(memory_source.has_arena());
+    assert(memory_source.arena_reserved() == reserve);
+    assert(memory_source.get_stats().current_usage == 0); // 预留不计入使用量
+    
+    // 连续提交的块彼此相邻
+    char* first = static_cast<char*>(memory_source.commit_arena(64 * 1024));
+    char* second = static_cast<char*>(memory_source.commit_arena(100 * 1024));
+    assert(first == memory_source.arena_base());
+    assert(second == first + 64 * 1024);
+    assert(memory_source.in_arena(second + 100));
+    assert(!memory_source.in_arena(first + reserve));
+    assert(memory_source.get_stats().current_usage == 64 * 1024 + 100 * 1024);
+    std::memset(first, 0x7E, 64 * 1024 + 100 * 1024);
+    
+    // 顶端的块释放后边界下降，下次提交复用同一地址，内容已清零
+    memory_source.deallocate_block(second, 100 * 1024);
+    assert(memory_source.arena_frontier() == 64 * 1024);
+    char* again = static_cast<char*>(memory_source.commit_arena(8192));
+    assert(again == second);
+    assert(again[0] == 0 && again[8191] == 0);
+    
+    // 超出预留范围时失败
+    assert(memory_source.commit_arena(reserve) == nullptr);
+    
+    // 普通块仍然来自独立映射
+    void* block = memory_source.allocate_block(4096);
+    assert(block != nullptr && !memory_source.in_arena(block));
+    memory_source.deallocate_block(block, 4096);
+    
+    memory_source.deallocate_block(again, 8192);
+    memory_source.deallocate_block(first, 64 * 1024);
+    assert(memory_source.get_stats().current_usage == 0);
+    assert(memory_source.arena_frontier() == 0);
+    
+    // 没有预留时 commit_arena 返回 nullptr
+    MemorySource plain;
+    assert(!plain.has_arena());
+    assert(plain.commit_arena(4096) == nullptr);
+    
+    std::cout << "Arena tests passed!" << std::endl;
+}
+
+// 在 [addr, addr + size) 放一个占位映射；地址已被占用时返回 nullptr
+static void* map_blocker(void* addr, size_t size) {
+    void* ptr = mmap(addr, size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    return ptr == addr ? ptr : nullptr;
+}
+
+void test_remap() {
+    std::cout << "Testing block resize and move..." << std::endl;
+    
+    MemorySource memory_source;
+    const size_t page = memory_source.get_page_size();
+    
+    unsigned char* block = static_cast<unsigned char*>(memory_source.allocate_block(4 * page));
+    assert(block != nullptr);
+    for (size_t i = 0; i < 4 * page; ++i) {
+        block[i] = static_cast<unsigned char>(i % 251);
+    }
+    
+    // 缩小总能原地完成
+    assert(memory_source.resize_block(block, 4 * page, 2 * page));
+    assert(memory_source.get_stats().current_usage == 2 * page);
+    assert(memory_source.get_stats().remap_count == 1);
+    
+    // 上方被占用时原地增长失败，块保持不变
+    void* blocker = map_blocker(block + 2 * page, page);
+    if (blocker != nullptr) {
+        assert(!memory_source.resize_block(block, 2 * page, 8 * page));
+        assert(memory_source.get_stats().current_usage == 2 * page);
+    }
+    
+    // 把页搬到新映射：内容不变，新增部分为零，原映射释放
+    unsigned char* destination = static_cast<unsigned char*>(memory_source.allocate_block(8 * page));
+    assert(destination != nullptr);
+    assert(memory_source.move_block(block, 2 * page, destination, 8 * page));
+    for (size_t i = 0; i < 2 * page; ++i) {
+        assert(destination[i] == static_cast<unsigned char>(i % 251));
+    }
+    assert(destination[2 * page] == 0 && destination[8 * page - 1] == 0);
+    assert(memory_source.get_stats().current_usage == 8 * page);
+    if (blocker != nullptr) {
+        munmap(blocker, page);
+    }
+    memory_source.deallocate_block(destination, 8 * page);
+    assert(memory_source.get_stats().current_usage == 0);
+    
+    // 预留区中的块不能重映射
+    MemorySource arena_source(MemorySource::HugePagePolicy::None, 64 * page);
+    void* chunk = arena_source.commit_arena(4 * page);
+    assert(chunk != nullptr);
+    assert(!arena_source.can_remap(chunk, 4 * page, 8 * page));
+    assert(!arena_source.resize_block(chunk, 4 * page, 2 * page));
+    
+    std::cout << "Remap tests passed!" << std::endl;
+}
+
+void test_block_cache() {
+    std::cout << "Testing freed block cache..." << std::endl;
+    
+    MemorySource memory_source;
+    const size_t block = 64 * 1024;
+    assert(memory_source.set_block_cache(block, 2));
+    assert(memory_source.block_cache_size() == block);
+    
+    // 释放的块进入缓存，同样大小的下一次分配直接取回，内容读出为零
+    char* a = static_cast<char*>(memory_source.allocate_block(block));
+    char* b = static_cast<char*>(memory_source.allocate_block(block));
+    char* c = static_cast<char*>(memory_source.allocate_block(block));
+    std::memset(a, 0x5A, block);
+    memory_source.deallocate_block(a, block);
+    auto stats = memory_source.get_stats();
+    assert(stats.current_usage == 2 * block && stats.current_cached == block);
+    assert(stats.deallocation_count == 0);
+    
+    char* again = static_cast<char*>(memory_source.allocate_block(block - 100));
+    assert(again == a);
+    assert(again[0] == 0 && again[block - 1] == 0);
+    assert(memory_source.get_stats().cache_hits == 1);
+    assert(memory_source.get_stats().allocation_count == 3);
+    
+    // 缓存满了或大小不符的块照常解除映射
+    memory_source.deallocate_block(again, block);
+    memory_source.deallocate_block(b, block);
+    memory_source.deallocate_block(c, block);
+    assert(memory_source.get_stats().current_cached == 2 * block);
+    assert(memory_source.get_stats().deallocation_count == 1);
+    void* other = memory_source.allocate_block(2 * block);
+    memory_source.deallocate_block(other, 2 * block);
+    assert(memory_source.get_stats().current_cached == 2 * block);
+    
+    // 关闭缓存时归还缓存的块
+    assert(memory_source.set_block_cache(0));
+    stats = memory_source.get_stats();
+    assert(stats.current_usage == 0 && stats.current_cached == 0);
+    assert(stats.total_allocated == stats.total_deallocated);
+    
+    // 需要大页的尺寸不缓存
+    MemorySource huge(MemorySource::HugePagePolicy::Transparent);
+    assert(!huge.set_block_cache(MemorySource::HUGE_PAGE_SIZE));
+    
+    std::cout << "Block cache tests passed!" << std::endl;
+}
+
+void test_shared_source() {
+    std::cout << "Testing one source shared by several threads..." << std::endl;
+    
+    MemorySource memory_source(MemorySource::HugePagePolicy::None, 256 * 1024 * 1024);
+    const size_t block = 16 * 1024;
+    memory_source.set_block_cache(block, 8);
+    
+    // 各线程交替分配、释放普通块与预留区的块，写入自己的标记检查是否串扰
+    const int num_threads = 4;
+    const int rounds = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&memory_source, t, block]() {
+            std::vector<char*> blocks;
+            for (int i = 0; i < rounds; ++i) {
+                char* ptr = static_cast<char*>(memory_source.allocate_block(block));
+                assert(ptr != nullptr && ptr[0] == 0 && ptr[block - 1] == 0);
+                std::memset(ptr, t + 1, block);
+                blocks.push_back(ptr);
+                
+                char* chunk = static_cast<char*>(memory_source.commit_arena(8192));
+                assert(chunk != nullptr && memory_source.in_arena(chunk));
+                std::memset(chunk, t + 1, 8192);
+                
+                if (i % 3 != 0) {
+                    char* old = blocks[blocks.size() / 2];
+                    assert(old[0] == t + 1 && old[block - 1] == t + 1);
+                    blocks[blocks.size() / 2] = blocks.back();
+                    blocks.pop_back();
+                    memory_source.deallocate_block(old, block);
+                }
+                assert(chunk[0] == t + 1 && chunk[8191] == t + 1);
+                memory_source.deallocate_block(chunk, 8192);
+            }
+            for (char* ptr : blocks) {
+                assert(ptr[0] == t + 1);
+                memory_source.deallocate_block(ptr, block);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    
+    auto stats = memory_source.get_stats();
+    std::cout << "mmap calls: " << stats.allocation_count << ", cache hits: " << stats.cache_hits << std::endl;
+    assert(stats.current_usage == 0);
+    assert(stats.current_cached <= 8 * block);
+    assert(stats.total_allocated == stats.total_deallocated + stats.current_cached);
+    assert(stats.allocation_count == stats.deallocation_count + stats.current_cached / block);
+    assert(stats.cache_hits > 0);
+    
+    std::cout << "Shared source tests passed!" << std::endl;
+}
+
+void test_numa_placement() {
+    std::cout << "Testing NUMA placement..." << std::endl;
+    
+    const int nodes = numa::online_nodes();
+    const int node = nodes - 1;
+    std::cout << "Online nodes: " << nodes << std::endl;
+    assert(nodes >= 1 && numa::node_of_cpu(0) < nodes);
+    
+    // 按节点批量读取的结果与逐个 CPU 查询一致
+    unsigned char table[8];
+    numa::cpu_nodes(nodes, table, 8);
+    for (int cpu = 0; cpu < 8; ++cpu) {
+        assert(table[cpu] == numa::node_of_cpu(cpu));
+    }
+    
+    // 每个新映射和每次提交的预留区块都设置节点策略
+    MemorySource memory_source(MemorySource::HugePagePolicy::None, 16 * 1024 * 1024, node);
+    assert(memory_source.numa_node() == node);
+    const size_t size = 64 * 1024;
+    char* block = static_cast<char*>(memory_source.allocate_block(size));
+    char* chunk = static_cast<char*>(memory_source.commit_arena(size));
+    assert(block != nullptr && chunk != nullptr);
+    std::memset(block, 1, size);
+    std::memset(chunk, 1, size);
+    auto stats = memory_source.get_stats();
+    assert(stats.numa_bound_blocks + stats.numa_bind_failures == 2);
+    
+    // move_pages 可用时检查页确实落在该节点
+    if (stats.numa_bound_blocks == 2 && numa::page_node(block) != numa::NO_NODE) {
+        size_t resident = 0;
+        assert(numa::page_node(chunk + size - 1) == node);
+        assert(numa::pages_on_node(block, size, node, &resident) == resident);
+        assert(resident == size / memory_source.get_page_size());
+    }
+    memory_source.deallocate_block(block, size);
+    memory_source.deallocate_block(chunk, size);
+    
+    // 线程默认策略同样经过系统调用设置和恢复
+    assert(numa::set_thread_policy(node, numa::Policy::Preferred) == (stats.numa_bind_failures == 0));
+    assert(numa::set_thread_policy(numa::NO_NODE, numa::Policy::Preferred) || stats.numa_bind_failures != 0);
+    
+    // 越界的节点被拒绝，设置保持不变
+    assert(!memory_source.set_numa_node(numa::MAX_NODES));
+    assert(memory_source.numa_node() == node);
+    assert(memory_source.set_numa_node(numa::NO_NODE));
+    void* unbound = memory_source.allocate_block(size);
+    assert(memory_source.get_stats().numa_bound_blocks + memory_source.get_stats().numa_bind_failures == 2);
+    memory_source.deallocate_block(unbound, size);
+    
+    std::cout << "NUMA placement tests passed!" << std::endl;
+}
+
 int main() {
     std::cout << "=== MemPlumber Basic Tests ===" << std::endl;
     
@@ -100,6 +420,12 @@ int main() {
         test_memory_source();
         test_page_alignment();
         test_large_allocations();
+        test_huge_pages();
+        test_address_space_arena();
+        test_remap();
+        test_block_cache();
+        test_shared_source();
+        test_numa_placement();
         
         std::cout << "\n✓ All basic tests passed!" << std::endl;
         std::cout << "Foundation is solid - ready for allocator implementation." << std::endl;
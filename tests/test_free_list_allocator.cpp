@@ -2,6 +2,14 @@
 #include "axontzz/memory_source.h"
 #include <iostream>
 #include <cassert>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <sys/mman.h>
+#include <thread>
+#include <vector>
 
 using namespace memplumber;
 
@@ -90,6 +98,159 @@ void test_multiple_allocations() {
     std::cout << "Multiple allocations test passed!" << std::endl;
 }
 
+void test_oversized_requests() {
+    std::cout << "Testing oversized requests on the free-list path..." << std::endl;
+    
+    // 关闭大对象路径：超大请求全部落到自由链表，必须失败而不是回绕
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 64 * 1024, 0);
+    assert(allocator.allocate(SIZE_MAX / 2, size_t(1) << 63) == nullptr);
+    assert(allocator.allocate(SIZE_MAX - 8, 16) == nullptr);
+    assert(allocator.allocate(SIZE_MAX / 2 - 8, 16) == nullptr);
+    assert(allocator.get_stats().failed_allocations == 3);
+    assert(allocator.validate_free_list());
+    
+    // 之后正常的请求不受影响
+    void* ptr = allocator.allocate(100, 64);
+    assert(ptr != nullptr && reinterpret_cast<uintptr_t>(ptr) % 64 == 0);
+    allocator.deallocate(ptr);
+    assert(allocator.get_stats().current_usage == 0);
+    
+    std::cout << "Oversized request test passed!" << std::endl;
+}
+
+void test_size_class_bins() {
+    std::cout << "Testing size-class bins..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 1024 * 1024);
+    
+    const int num_allocs = 64;
+    void* ptrs[num_allocs];
+    size_t sizes[num_allocs];
+    
+    // 分配不同大小的块，覆盖小块分级与按2的幂划分的分级
+    for (int i = 0; i < num_allocs; ++i) {
+        sizes[i] = 16 + static_cast<size_t>(i) * 37;
+        ptrs[i] = allocator.allocate(sizes[i]);
+        assert(ptrs[i] != nullptr);
+    }
+    assert(allocator.validate_free_list());
+    
+    // 释放偶数索引的块，产生互不相邻的碎片
+    for (int i = 0; i < num_allocs; i += 2) {
+        allocator.deallocate(ptrs[i], sizes[i]);
+    }
+    assert(allocator.validate_free_list());
+    assert(allocator.free_block_count() == num_allocs / 2 + 1);
+    
+    // 能放进某个碎片的请求应当复用碎片而不是切割尾部大块
+    void* reused = allocator.allocate(sizes[10]);
+    assert(reused != nullptr);
+    assert(allocator.free_block_count() <= num_allocs / 2 + 1);
+    assert(allocator.validate_free_list());
+    
+    // 大对齐请求
+    void* aligned = allocator.allocate(100, 256);
+    assert(aligned != nullptr);
+    assert(reinterpret_cast<uintptr_t>(aligned) % 256 == 0);
+    assert(allocator.validate_free_list());
+    
+    allocator.deallocate(reused, sizes[10]);
+    allocator.deallocate(aligned, 100);
+    for (int i = 1; i < num_allocs; i += 2) {
+        allocator.deallocate(ptrs[i], sizes[i]);
+    }
+    
+    // 全部释放后应合并回单个自由块
+    assert(allocator.validate_free_list());
+    assert(allocator.free_block_count() == 1);
+    assert(allocator.get_stats().current_usage == 0);
+    
+    std::cout << "Size-class bins test passed!" << std::endl;
+}
+
+void test_large_object_path() {
+    std::cout << "Testing large-object direct mapping and span cache..." << std::endl;
+    
+    MemorySource memory_source;
+    {
+        FreeListAllocator allocator(memory_source, 64 * 1024, 128 * 1024, 2);
+        const size_t heap_usage = memory_source.get_stats().current_usage;
+        
+        // 超过阈值的请求得到独立映射的跨度，不占用堆区域
+        const size_t big = 1024 * 1024;
+        char* ptr = static_cast<char*>(allocator.allocate(big));
+        assert(ptr != nullptr);
+        assert(allocator.owns(ptr) && allocator.owns(ptr + big - 1));
+        assert(allocator.allocation_size(ptr) == big);
+        assert(allocator.large_span_count() == 1);
+        std::memset(ptr, 0xAB, big);
+        assert(allocator.validate_free_list());
+        assert(memory_source.get_stats().current_usage > heap_usage + big);
+        
+        // 释放后进入缓存，同样大小的请求直接复用，不再调用 mmap
+        allocator.deallocate(ptr, big);
+        assert(allocator.large_span_count() == 0);
+        assert(allocator.cached_span_count() == 1);
+        const size_t maps = memory_source.get_stats().allocation_count;
+        char* again = static_cast<char*>(allocator.allocate(big - 100));
+        assert(again == ptr);
+        assert(memory_source.get_stats().allocation_count == maps);
+        assert(allocator.cached_span_count() == 0);
+        
+        // 缓存的跨度比请求大两倍以上时不复用
+        allocator.deallocate(again);
+        void* small_large = allocator.allocate(200 * 1024);
+        assert(small_large != nullptr && small_large != again);
+        assert(allocator.cached_span_count() == 1);
+        allocator.deallocate(small_large);
+        
+        // 大对齐
+        void* aligned = allocator.allocate(300 * 1024, 4096);
+        assert(aligned != nullptr);
+        assert(reinterpret_cast<uintptr_t>(aligned) % 4096 == 0);
+        allocator.deallocate(aligned);
+        
+        // 对齐或大小超出地址空间一半：失败，而不是回绕成一个很小的跨度
+        const size_t failures = allocator.get_stats().failed_allocations;
+        assert(allocator.allocate((size_t(1) << 63) + (1 << 20), size_t(1) << 63) == nullptr);
+        assert(allocator.allocate(big, size_t(1) << 63) == nullptr);
+        assert(allocator.allocate(SIZE_MAX - 8, 16) == nullptr);
+        assert(allocator.get_stats().failed_allocations == failures + 3);
+        assert(allocator.large_span_count() == 0 && allocator.validate_free_list());
+        
+        // 缓存有界：最多保留 2 个跨度
+        std::vector<void*> spans;
+        for (int i = 0; i < 5; ++i) {
+            spans.push_back(allocator.allocate(big + i * 8192));
+        }
+        for (void* span : spans) {
+            allocator.deallocate(span);
+        }
+        assert(allocator.cached_span_count() == 2);
+        
+        // 阈值以下的请求仍然走分级链表
+        void* regular = allocator.allocate(64 * 1024);
+        assert(regular != nullptr);
+        assert(allocator.large_span_count() == 0);
+        allocator.deallocate(regular);
+        
+        allocator.release_cached_spans();
+        assert(allocator.cached_span_count() == 0);
+        assert(allocator.cached_span_bytes() == 0);
+        assert(allocator.get_stats().current_usage == 0);
+        allocator.dump_free_list();
+        
+        // 存活的大对象在析构时一并归还
+        void* leaked = allocator.allocate(big);
+        assert(leaked != nullptr);
+    }
+    assert(memory_source.get_stats().current_usage == 0);
+    
+    std::cout << "Large-object path test passed!" << std::endl;
+}
+
 void test_stats_and_debugging() {
     std::cout << "Testing stats and debugging..." << std::endl;
     
@@ -108,6 +269,617 @@ void test_stats_and_debugging() {
     std::cout << "Stats and debugging test passed!" << std::endl;
 }
 
+// 暴露互斥锁，用于验证统计读取不经过它
+struct LockProbe : ThreadSafeAllocator<FreeListAllocator> {
+    using ThreadSafeAllocator<FreeListAllocator>::ThreadSafeAllocator;
+    std::mutex& allocation_mutex() { return mutex_; }
+};
+
+void test_lock_free_stats() {
+    std::cout << "Testing lock-free statistics..." << std::endl;
+    
+    MemorySource memory_source;
+    
+    // 按尺寸分级计数
+    {
+        FreeListAllocator allocator(memory_source, 64 * 1024);
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 10; ++i) {
+            ptrs.push_back(allocator.allocate(16));
+        }
+        for (int i = 0; i < 5; ++i) {
+            ptrs.push_back(allocator.allocate(100));
+        }
+        void* big = allocator.allocate(300 * 1024);
+        
+        SizeClassTable table = allocator.size_class_stats();
+        assert(table[0].max_size == 16 && table[0].allocation_count == 10);
+        assert(table[0].bytes_allocated == 160);
+        assert(table[stats_size_class(100)].allocation_count == 5);
+        assert(table[stats_size_class(100)].max_size == 128);
+        assert(table[stats_size_class(300 * 1024)].bytes_allocated == 300 * 1024);
+        assert(table[STATS_SIZE_CLASS_COUNT - 1].max_size == SIZE_MAX);
+        
+        allocator.deallocate(big);
+        for (void* ptr : ptrs) {
+            allocator.deallocate(ptr);
+        }
+        table = allocator.size_class_stats();
+        assert(table[0].deallocation_count == 10 && table[0].bytes_deallocated == 160);
+        assert(table[stats_size_class(300 * 1024)].deallocation_count == 1);
+        assert(allocator.get_stats().current_usage == 0);
+    }
+    
+    // 多线程计数在静止后精确汇总
+    LockProbe allocator(memory_source, 256 * 1024);
+    constexpr int kThreads = 4;
+    constexpr int kIterations = 5000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&allocator, t] {
+            for (int i = 0; i < kIterations; ++i) {
+                size_t size = 8 + static_cast<size_t>((i * 37 + t) % 600);
+                void* ptr = allocator.allocate(size);
+                assert(ptr != nullptr);
+                allocator.deallocate(ptr, size);
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    auto stats = allocator.get_stats();
+    assert(stats.allocation_count == kThreads * kIterations);
+    assert(stats.deallocation_count == kThreads * kIterations);
+    assert(stats.current_usage == 0);
+    size_t class_total = 0;
+    for (const SizeClassStats& cls : allocator.size_class_stats()) {
+        class_total += cls.allocation_count;
+    }
+    assert(class_total == kThreads * kIterations);
+    
+    // 持有分配锁时，另一线程仍能读取统计
+    void* live = allocator.allocate(64);
+    std::atomic<bool> done{false};
+    {
+        std::lock_guard<std::mutex> lock(allocator.allocation_mutex());
+        std::thread reader([&] {
+            auto snapshot = allocator.get_stats();
+            auto table = allocator.size_class_stats();
+            assert(snapshot.current_usage == 64);
+            assert(table[stats_size_class(64)].allocation_count > 0);
+            done.store(true);
+        });
+        for (int i = 0; i < 2000 && !done.load(); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        assert(done.load());
+        reader.join();
+    }
+    allocator.deallocate(live, 64);
+    
+    // 轮询开销
+    auto start = std::chrono::steady_clock::now();
+    size_t sink = 0;
+    for (int i = 0; i < 10000; ++i) {
+        sink += allocator.get_stats().allocation_count;
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count() / 10000;
+    std::cout << "get_stats(): " << ns << " ns per call (" << sink % 2 << ")" << std::endl;
+    
+    std::cout << "Lock-free statistics test passed!" << std::endl;
+}
+
+size_t count_occurrences(const std::string& text, const std::string& pattern) {
+    size_t count = 0;
+    for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1)) {
+        count++;
+    }
+    return count;
+}
+
+void test_fragmentation_and_heap_map() {
+    std::cout << "Testing fragmentation metrics and heap map export..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 64 * 1024);
+    assert(allocator.get_stats().fragmentation_ratio == 0.0);
+    
+    // 1 字节的请求占用一个最小块：几乎全部是内部碎片
+    void* tiny = allocator.allocate(1);
+    auto frag = allocator.fragmentation();
+    assert(frag.requested == 1 && frag.allocated >= 24);
+    assert(frag.internal > 0.9);
+    assert(allocator.get_stats().fragmentation_ratio == frag.internal);
+    
+    // 交替释放制造空洞：外部碎片上升
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 20; ++i) {
+        ptrs.push_back(allocator.allocate(200));
+    }
+    for (size_t i = 0; i < ptrs.size(); i += 2) {
+        allocator.deallocate(ptrs[i]);
+    }
+    frag = allocator.fragmentation();
+    assert(frag.requested == 1 + 10 * 200);
+    assert(frag.largest_free < frag.free && frag.external > 0.0);
+    
+    // 带对齐前缀的分配与大对象跨度也能从块起点找回请求大小
+    void* aligned = allocator.allocate(777, 32);
+    assert(aligned != nullptr && reinterpret_cast<uintptr_t>(aligned) % 32 == 0);
+    void* big = allocator.allocate(300 * 1024, 4096);
+    assert(big != nullptr);
+    
+    std::ostringstream out;
+    allocator.export_heap_map(out);
+    const std::string map = out.str();
+    assert(map.rfind("{\"allocator\":\"FreeListAllocator\"", 0) == 0);
+    assert(count_occurrences(map, "\"state\":\"free\"") == allocator.free_block_count());
+    assert(count_occurrences(map, "\"state\":\"used\"") == 1 + 10 + 1);
+    assert(map.find("\"requested\":777}") != std::string::npos);
+    assert(map.find("\"requested\":307200}") != std::string::npos);
+    assert(map.find("\"internal_fragmentation\":") != std::string::npos);
+    std::cout << "Heap map: " << map.size() << " bytes of JSON" << std::endl;
+    
+    allocator.dump_free_list();
+    
+    // 全部释放后内部碎片归零
+    allocator.deallocate(tiny);
+    allocator.deallocate(aligned);
+    allocator.deallocate(big);
+    for (size_t i = 1; i < ptrs.size(); i += 2) {
+        allocator.deallocate(ptrs[i]);
+    }
+    frag = allocator.fragmentation();
+    assert(frag.requested == 0 && frag.allocated == 0 && frag.internal == 0.0);
+    assert(allocator.free_block_count() == 1 && frag.external == 0.0);
+    
+    std::cout << "Fragmentation and heap map test passed!" << std::endl;
+}
+
+void test_reallocate() {
+    std::cout << "Testing reallocate in place..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 256 * 1024, 128 * 1024);
+    auto fill = [](void* ptr, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            static_cast<unsigned char*>(ptr)[i] = static_cast<unsigned char>(i * 13);
+        }
+    };
+    auto intact = [](const void* ptr, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            if (static_cast<const unsigned char*>(ptr)[i] != static_cast<unsigned char>(i * 13)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    // 缩小：原地拆出尾部，尾部并入后面的自由块
+    void* ptr = allocator.allocate(4000);
+    void* guard = allocator.allocate(64);
+    fill(ptr, 4000);
+    const size_t free_before = allocator.memory_usage().free;
+    void* shrunk = allocator.reallocate(ptr, 4000, 100);
+    assert(shrunk == ptr && intact(shrunk, 100));
+    assert(allocator.allocation_size(shrunk) == 100);
+    assert(allocator.memory_usage().free > free_before + 3800);
+    assert(allocator.validate_free_list());
+    
+    // 增长：吸收刚拆出的后继自由块
+    void* grown = allocator.reallocate(shrunk, 100, 3000);
+    assert(grown == ptr && intact(grown, 100));
+    fill(grown, 3000);
+    assert(allocator.validate_free_list());
+    
+    // 后继被占用：复制到新块
+    void* moved = allocator.reallocate(grown, 3000, 8000);
+    assert(moved != nullptr && moved != ptr && intact(moved, 3000));
+    assert(allocator.validate_free_list());
+    
+    // 统计：原地调整记为一次释放加一次分配，存活字节与分配头部一致
+    auto stats = allocator.get_stats();
+    assert(stats.current_usage == 8000 + 64);
+    auto frag = allocator.fragmentation();
+    assert(frag.requested == 8000 + 64);
+    allocator.deallocate(guard);
+    
+    // 跨越大对象阈值：搬到独立跨度
+    void* large = allocator.reallocate(moved, 8000, 200 * 1024);
+    assert(large != nullptr && intact(large, 3000));
+    assert(allocator.large_span_count() == 1);
+    fill(large, 200 * 1024);
+    
+    // 大对象跨度：mremap 原地或搬页增长，不经过复制路径
+    const size_t remaps = memory_source.get_stats().remap_count;
+    void* larger = allocator.reallocate(large, 200 * 1024, 3 * 1024 * 1024);
+    assert(larger != nullptr && intact(larger, 200 * 1024));
+    assert(memory_source.get_stats().remap_count > remaps);
+    assert(allocator.large_span_count() == 1);
+    assert(allocator.owns(static_cast<char*>(larger) + 3 * 1024 * 1024 - 1));
+    
+    // 跨度上方被占用：页被搬到新映射
+    const uintptr_t span_end = (reinterpret_cast<uintptr_t>(larger) + 3 * 1024 * 1024 + 4095) & ~uintptr_t(4095);
+    void* blocker = mmap(reinterpret_cast<void*>(span_end), 4096, PROT_NONE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    void* relocated = allocator.reallocate(larger, 3 * 1024 * 1024, 4 * 1024 * 1024);
+    assert(relocated != nullptr && intact(relocated, 200 * 1024));
+    if (blocker == reinterpret_cast<void*>(span_end)) {
+        assert(relocated != larger);
+        munmap(blocker, 4096);
+    }
+    assert(allocator.owns(relocated) && allocator.large_span_count() == 1);
+    assert(allocator.allocation_size(relocated) == 4 * 1024 * 1024);
+    
+    // 缩小跨度：截掉尾部的页
+    const size_t reserved = allocator.memory_usage().reserved;
+    void* trimmed = allocator.reallocate(relocated, 4 * 1024 * 1024, 150 * 1024);
+    assert(trimmed == relocated && intact(trimmed, 150 * 1024));
+    assert(allocator.memory_usage().reserved < reserved);
+    
+    // 回到阈值以下：复制进堆
+    void* back = allocator.reallocate(trimmed, 150 * 1024, 1000);
+    assert(back != nullptr && intact(back, 1000));
+    assert(allocator.large_span_count() == 0);
+    
+    // nullptr 与 0 字节
+    void* fresh = allocator.reallocate(nullptr, 0, 48);
+    assert(fresh != nullptr && allocator.allocation_size(fresh) == 48);
+    assert(allocator.reallocate(fresh, 48, 0) == nullptr);
+    
+    // 要求更强的对齐：即使后继空闲也不原地增长，搬到满足对齐的新块
+    void* first = allocator.allocate(100);
+    void* second = allocator.allocate(100);
+    void* unaligned = reinterpret_cast<uintptr_t>(second) % 4096 != 0 ? second : first;
+    allocator.deallocate(unaligned == second ? first : second);
+    fill(unaligned, 100);
+    void* realigned = allocator.reallocate(unaligned, 100, 200, 4096);
+    assert(realigned != nullptr && realigned != unaligned);
+    assert(reinterpret_cast<uintptr_t>(realigned) % 4096 == 0);
+    assert(intact(realigned, 100) && allocator.validate_free_list());
+    allocator.deallocate(realigned);
+    
+    // 其他分配器的指针：返回 nullptr，两边都不受影响
+    FreeListAllocator other(memory_source, 64 * 1024);
+    void* foreign = other.allocate(64);
+    fill(foreign, 64);
+    assert(allocator.reallocate(foreign, 64, 128) == nullptr);
+    assert(other.owns(foreign) && intact(foreign, 64));
+    other.deallocate(foreign);
+    allocator.deallocate(back);
+    
+    assert(allocator.get_stats().current_usage == 0);
+    assert(allocator.fragmentation().requested == 0 && allocator.fragmentation().allocated == 0);
+    assert(allocator.validate_free_list());
+    
+    // ThreadSafeAllocator 转发到底层实现
+    ThreadSafeAllocator<FreeListAllocator> locked(memory_source, 64 * 1024);
+    void* buffer = locked.allocate(64);
+    fill(buffer, 64);
+    buffer = locked.reallocate(buffer, 64, 4096);
+    assert(buffer != nullptr && intact(buffer, 64));
+    locked.deallocate(buffer);
+    assert(locked.get_stats().current_usage == 0);
+    
+    std::cout << "Reallocate test passed!" << std::endl;
+}
+
+void test_allocate_zeroed() {
+    std::cout << "Testing zero-page-aware allocate_zeroed..." << std::endl;
+    
+    auto all_zero = [](const void* ptr, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            if (static_cast<const unsigned char*>(ptr)[i] != 0) {
+                return false;
+            }
+        }
+        return true;
+    };
+    
+    // 新区域的块仍是内核零页：连续切分（含对齐前缀）都不需要 memset
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 256 * 1024, 128 * 1024);
+    std::vector<void*> blocks;
+    for (size_t i = 0; i < 32; ++i) {
+        void* ptr = allocator.allocate_zeroed(100 + i * 300, i % 4 == 0 ? 256 : sizeof(void*));
+        assert(ptr != nullptr && all_zero(ptr, 100 + i * 300));
+        blocks.push_back(ptr);
+    }
+    assert(allocator.zero_fill_stats().pristine == 32);
+    assert(allocator.zero_fill_stats().cleared == 0);
+    std::ostringstream map;
+    allocator.export_heap_map(map);
+    assert(map.str().find("\"zeroed\":true") != std::string::npos);
+    
+    // 写脏后释放：合并出的块不再是零页，必须清零
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        std::memset(blocks[i], 0xab, 100 + i * 300);
+        allocator.deallocate(blocks[i]);
+    }
+    void* recycled = allocator.allocate_zeroed(5000);
+    assert(recycled != nullptr && all_zero(recycled, 5000));
+    assert(allocator.zero_fill_stats().cleared == 1);
+    assert(allocator.zero_fill_stats().cleared_bytes == 5000);
+    allocator.deallocate(recycled);
+    
+    // 大对象：新映射的跨度免清零，缓存中复用的跨度要清零
+    void* large = allocator.allocate_zeroed(200 * 1024);
+    assert(large != nullptr && all_zero(large, 200 * 1024));
+    assert(allocator.zero_fill_stats().pristine == 33);
+    std::memset(large, 0xcd, 200 * 1024);
+    allocator.deallocate(large);
+    large = allocator.allocate_zeroed(200 * 1024);
+    assert(large != nullptr && all_zero(large, 200 * 1024));
+    assert(allocator.zero_fill_stats().cleared == 2);
+    allocator.deallocate(large);
+    assert(allocator.validate_free_list());
+    
+    // 预留区原地扩展：新段与末尾的零页块合并后仍免清零，混合负载下结果始终为零
+    MemorySource arena_source(MemorySource::HugePagePolicy::None, 64 * 1024 * 1024);
+    FreeListAllocator arena_allocator(arena_source, 64 * 1024, 0);
+    std::vector<std::pair<void*, size_t>> live;
+    unsigned seed = 12345;
+    for (size_t round = 0; round < 4000; ++round) {
+        seed = seed * 1103515245 + 12345;
+        const size_t size = 16 + (seed >> 8) % 20000;
+        if (live.size() > 64 && (seed & 0x300) != 0) {
+            const size_t victim = (seed >> 4) % live.size();
+            arena_allocator.deallocate(live[victim].first);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+        void* ptr = (seed & 1) != 0 ? arena_allocator.allocate_zeroed(size) : arena_allocator.allocate(size);
+        assert(ptr != nullptr);
+        if ((seed & 1) != 0) {
+            assert(all_zero(ptr, size));
+        }
+        std::memset(ptr, 0xff, size);
+        live.emplace_back(ptr, size);
+    }
+    assert(arena_allocator.region_count() == 1);
+    assert(arena_allocator.zero_fill_stats().pristine > 0);
+    assert(arena_allocator.zero_fill_stats().cleared > 0);
+    assert(arena_allocator.validate_free_list());
+    for (const auto& entry : live) {
+        arena_allocator.deallocate(entry.first);
+    }
+    
+    // 接口默认实现：分配后 memset
+    ThreadSafeAllocator<FreeListAllocator> locked(memory_source, 64 * 1024);
+    void* buffer = locked.allocate_zeroed(512);
+    assert(buffer != nullptr && all_zero(buffer, 512));
+    locked.deallocate(buffer);
+    
+    std::cout << "Allocate zeroed test passed!" << std::endl;
+}
+
+void test_placement_policies() {
+    std::cout << "Testing placement policies..." << std::endl;
+    
+    using Policy = FreeListAllocator::PlacementPolicy;
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 1024 * 1024, 0);
+    assert(allocator.placement_policy() == Policy::GoodFit);
+    
+    // 三个被占用块隔开的空洞：A(2000) < B(600) < C(1000)，之后是区域剩余的大块
+    char* a = static_cast<char*>(allocator.allocate(2000));
+    void* guard_a = allocator.allocate(64);
+    char* b = static_cast<char*>(allocator.allocate(600));
+    void* guard_b = allocator.allocate(64);
+    char* c = static_cast<char*>(allocator.allocate(1000));
+    void* guard_c = allocator.allocate(64);
+    assert(a < b && b < c);
+    allocator.deallocate(a);
+    allocator.deallocate(b);
+    allocator.deallocate(c);
+    auto inside = [](void* ptr, char* hole, size_t size) {
+        return static_cast<char*>(ptr) >= hole && static_cast<char*>(ptr) < hole + size;
+    };
+    
+    // 最佳适配：最小的能放下的空洞
+    allocator.set_placement_policy(Policy::BestFit);
+    assert(allocator.validate_free_list());
+    void* best_small = allocator.allocate(500);
+    void* best_medium = allocator.allocate(900);
+    void* best_large = allocator.allocate(1500);
+    assert(inside(best_small, b, 600) && inside(best_medium, c, 1000) && inside(best_large, a, 2000));
+    assert(allocator.validate_free_list());
+    allocator.deallocate(best_small);
+    allocator.deallocate(best_medium);
+    allocator.deallocate(best_large);
+    
+    // 首次适配：地址最低的能放下的空洞
+    allocator.set_placement_policy(Policy::FirstFit);
+    void* first = allocator.allocate(500);
+    assert(inside(first, a, 2000));
+    allocator.deallocate(first);
+    
+    // 下次适配：从上次分配的末尾继续，低地址新出现的空洞被跳过
+    allocator.set_placement_policy(Policy::NextFit);
+    void* p1 = allocator.allocate(500);
+    void* p2 = allocator.allocate(1000);
+    void* p3 = allocator.allocate(900);
+    assert(inside(p1, a, 2000) && inside(p2, a, 2000) && inside(p3, c, 1000));
+    allocator.deallocate(p1);
+    void* p4 = allocator.allocate(400);
+    assert(static_cast<char*>(p4) > c + 1000);
+    assert(allocator.validate_free_list());
+    allocator.deallocate(p2);
+    allocator.deallocate(p3);
+    allocator.deallocate(p4);
+    
+    // 小请求在任何策略下都先用精确大小的小块分级
+    void* tiny = allocator.allocate(16);
+    void* tiny_guard = allocator.allocate(16);
+    allocator.deallocate(tiny);
+    assert(allocator.allocate(16) == tiny);
+    allocator.deallocate(tiny);
+    allocator.deallocate(tiny_guard);
+    for (void* guard : {guard_a, guard_b, guard_c}) {
+        allocator.deallocate(guard);
+    }
+    assert(allocator.validate_free_list());
+    
+    // 随机负载：每种策略、切换策略、退还页面后结构与统计都保持一致
+    std::vector<std::pair<void*, size_t>> live;
+    unsigned seed = 777;
+    const Policy policies[] = {Policy::BestFit, Policy::FirstFit, Policy::NextFit, Policy::GoodFit, Policy::BestFit};
+    for (Policy policy : policies) {
+        allocator.set_placement_policy(policy);
+        assert(allocator.validate_free_list());
+        for (size_t round = 0; round < 3000; ++round) {
+            seed = seed * 1103515245 + 12345;
+            if (live.size() > 200 || (!live.empty() && (seed & 0x400) != 0)) {
+                const size_t victim = (seed >> 3) % live.size();
+                allocator.deallocate(live[victim].first);
+                live[victim] = live.back();
+                live.pop_back();
+            } else {
+                const size_t size = 8 + (seed >> 12) % ((seed & 1) != 0 ? 256 : 16384);
+                const size_t alignment = (seed & 0x30) == 0 ? 128 : sizeof(void*);
+                void* ptr = allocator.allocate(size, alignment);
+                assert(ptr != nullptr && reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+                std::memset(ptr, 0xee, size);
+                live.emplace_back(ptr, size);
+            }
+            if (round % 500 == 0) {
+                assert(allocator.validate_free_list());
+            }
+        }
+        allocator.trim(0);
+        assert(allocator.validate_free_list());
+        assert(allocator.fragmentation().largest_free <= allocator.fragmentation().free);
+    }
+    for (const auto& entry : live) {
+        allocator.deallocate(entry.first);
+    }
+    assert(allocator.validate_free_list());
+    
+    // 树节点写在零页块里：allocate_zeroed 仍然返回全零且跳过 memset
+    FreeListAllocator fresh(memory_source, 256 * 1024, 0);
+    fresh.set_placement_policy(Policy::BestFit);
+    for (size_t size : {100, 3000, 40000}) {
+        unsigned char* zeroed = static_cast<unsigned char*>(fresh.allocate_zeroed(size));
+        for (size_t i = 0; i < size; ++i) {
+            assert(zeroed[i] == 0);
+        }
+    }
+    assert(fresh.zero_fill_stats().pristine == 3);
+    assert(fresh.validate_free_list());
+    
+    std::cout << "Placement policy test passed!" << std::endl;
+}
+
+void test_compact_header() {
+    std::cout << "Testing compact allocation header..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 256 * 1024, 64 * 1024);
+    
+    // 按字长对齐的对象只有一个标记字：相邻小对象的间距是标记加负载，最小块 32 字节
+    char* a = static_cast<char*>(allocator.allocate(16));
+    char* b = static_cast<char*>(allocator.allocate(16));
+    char* c = static_cast<char*>(allocator.allocate(40));
+    char* d = static_cast<char*>(allocator.allocate(1));
+    assert(b == a + 32 && c == b + 32 && d == c + 48);
+    assert(allocator.fragmentation().allocated == 32 + 32 + 48 + 32);
+    
+    // 请求大小由块大小减去标记中的余量得到，负载写满也不影响
+    for (size_t size = 1; size <= 300; ++size) {
+        for (size_t alignment : {size_t(8), size_t(16), size_t(64), size_t(512)}) {
+            char* ptr = static_cast<char*>(allocator.allocate(size, alignment));
+            assert(ptr != nullptr && reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+            std::memset(ptr, 0xff, size);
+            assert(allocator.allocation_size(ptr) == size);
+            if (size % 37 == 0) {
+                char* resized = static_cast<char*>(allocator.reallocate(ptr, size, size / 2 + 1, alignment));
+                assert(allocator.allocation_size(resized) == size / 2 + 1);
+                ptr = resized;
+            }
+            allocator.deallocate(ptr);
+        }
+    }
+    assert(allocator.validate_free_list());
+    
+    // 大对象跨度：请求大小记在跨度描述符里
+    void* big = allocator.allocate(100000, 256);
+    assert(big != nullptr && allocator.large_span_count() == 1);
+    assert(reinterpret_cast<uintptr_t>(big) % 256 == 0);
+    assert(allocator.allocation_size(big) == 100000);
+    big = allocator.reallocate(big, 100000, 90000, 256);
+    assert(allocator.allocation_size(big) == 90000);
+    allocator.deallocate(big);
+    
+    for (char* ptr : {a, b, c, d}) {
+        allocator.deallocate(ptr);
+    }
+    auto frag = allocator.fragmentation();
+    assert(frag.requested == 0 && frag.allocated == 0);
+    assert(allocator.validate_free_list());
+    
+    std::cout << "Compact header test passed!" << std::endl;
+}
+
+// 范围钩子记录的映射总量；refuse 为真时拒绝新映射
+struct RangeLog {
+    size_t mapped = 0;
+    bool refuse = false;
+};
+
+bool log_range(void* context, void*, size_t size, bool mapped) {
+    RangeLog* log = static_cast<RangeLog*>(context);
+    if (!mapped) {
+        assert(log->mapped >= size);
+        log->mapped -= size;
+        return true;
+    }
+    if (log->refuse) {
+        return false;
+    }
+    log->mapped += size;
+    return true;
+}
+
+void test_range_hook() {
+    std::cout << "Testing range hook..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 64 * 1024, 32 * 1024);
+    void* small = allocator.allocate(100);
+    
+    // 设置时补报已映射的区域
+    RangeLog log;
+    assert(allocator.set_range_hook(&log_range, &log));
+    const size_t initial = log.mapped;
+    assert(initial >= 64 * 1024);
+    
+    // 大对象跨度的映射、原地增长、收缩与释放都经过钩子
+    void* big = allocator.allocate(100000);
+    assert(big != nullptr && log.mapped >= initial + 100000);
+    big = allocator.reallocate(big, 100000, 1000000);
+    assert(big != nullptr && log.mapped >= initial + 1000000);
+    big = allocator.reallocate(big, 1000000, 200000);
+    assert(big != nullptr && log.mapped < initial + 1000000);
+    allocator.deallocate(big);
+    allocator.trim(0);
+    
+    // 钩子拒绝的映射按映射失败处理
+    log.refuse = true;
+    const size_t before = log.mapped;
+    assert(allocator.allocate(500000) == nullptr);
+    assert(allocator.allocate(200 * 1024) == nullptr);
+    assert(log.mapped == before);
+    log.refuse = false;
+    
+    allocator.deallocate(small);
+    assert(allocator.validate_free_list());
+    allocator.set_range_hook(nullptr, nullptr);
+    
+    std::cout << "Range hook test passed!" << std::endl;
+}
+
 int main() {
     std::cout << "=== FreeListAllocator Basic Tests ===" << std::endl;
     
@@ -115,7 +887,17 @@ int main() {
         test_basic_allocator_creation();
         test_simple_allocation();
         test_multiple_allocations();
+        test_oversized_requests();
+        test_size_class_bins();
+        test_large_object_path();
         test_stats_and_debugging();
+        test_lock_free_stats();
+        test_fragmentation_and_heap_map();
+        test_reallocate();
+        test_allocate_zeroed();
+        test_placement_policies();
+        test_compact_header();
+        test_range_hook();
         
         std::cout << "\n✓ All FreeListAllocator tests passed!" << std::endl;
         std::cout << "Ready for next iteration of development." << std::endl;
@@ -2,13 +2,32 @@
 #include <cassert>
 #include <vector>
 #include <string>
-#include "axontzz/allocator_interface.h"
+#include <thread>
+#include <random>
+#include <cstdint>
+#include <cstdio>
+#include <new>
+#include <cstdlib>
+#include <cstring>
+#include <sched.h>
+#include <unistd.h>
+#include "axontzz/allocation_stats.h"
 
 // 声明全局API
 namespace memplumber {
     namespace global {
         AllocatorInterface::AllocatorStats get_global_allocator_stats();
         bool is_pointer_owned_by_global_allocator(void* ptr);
+        SizeClassTable global_allocator_size_class_stats();
+        bool write_global_heap_map(int fd);
+        std::size_t global_allocator_arena_count();
+        int global_allocator_arena_of(void* ptr);
+        std::size_t global_allocator_numa_nodes();
+        int global_allocator_current_node();
+        int global_allocator_arena_node(void* ptr);
+        void* global_allocate(std::size_t size, std::size_t alignment);
+        void* global_reallocate(void* ptr, std::size_t size);
+        void global_deallocate(void* ptr);
     }
 }
 
@@ -117,6 +136,235 @@ void test_nothrow_new() {
     std::cout << "Nothrow new test passed!" << std::endl;
 }
 
+void test_multithreaded_new_delete() {
+    std::cout << "Testing multithreaded new/delete with thread caches..." << std::endl;
+    
+    auto initial_stats = memplumber::global::get_global_allocator_stats();
+    
+    {
+        const int num_threads = 4;
+        const int ops_per_thread = 20000;
+        std::vector<std::thread> threads;
+        std::vector<std::vector<char*>> handoff(num_threads);
+        
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([t, &handoff]() {
+                std::mt19937 rng(static_cast<unsigned>(t));
+                char* slots[64] = {};
+                size_t slot_sizes[64] = {};
+                for (int i = 0; i < ops_per_thread; ++i) {
+                    size_t index = rng() % 64;
+                    if (slots[index] != nullptr) {
+                        // 校验内容未被其他线程破坏
+                        assert(slots[index][0] == static_cast<char>(t));
+                        assert(slots[index][slot_sizes[index] - 1] == static_cast<char>(t));
+                        delete[] slots[index];
+                        slots[index] = nullptr;
+                    } else {
+                        size_t size = 1 + rng() % 2000; // 覆盖缓存分级与大对象路径
+                        slots[index] = new char[size];
+                        slot_sizes[index] = size;
+                        std::memset(slots[index], t, size);
+                    }
+                }
+                // 剩余对象交给主线程释放（跨线程释放）
+                for (char* ptr : slots) {
+                    if (ptr != nullptr) {
+                        handoff[t].push_back(ptr);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        for (auto& pointers : handoff) {
+            for (char* ptr : pointers) {
+                delete[] ptr;
+            }
+        }
+    }
+    
+    // 线程退出后，其缓存与计数都应并入全局统计
+    auto final_stats = memplumber::global::get_global_allocator_stats();
+    size_t allocations = final_stats.allocation_count - initial_stats.allocation_count;
+    size_t deallocations = final_stats.deallocation_count - initial_stats.deallocation_count;
+    std::cout << "Allocations: " << allocations << ", deallocations: " << deallocations << std::endl;
+    assert(allocations > 4 * 20000 / 3);
+    assert(allocations == deallocations);
+    assert(final_stats.current_usage == initial_stats.current_usage);
+    
+    std::cout << "Multithreaded new/delete test passed!" << std::endl;
+}
+
+void test_arena_routing() {
+    std::cout << "Testing arena assignment and cross-thread frees..." << std::endl;
+    
+    const size_t arenas = memplumber::global::global_allocator_arena_count();
+    const size_t nodes = memplumber::global::global_allocator_numa_nodes();
+    const char* select = std::getenv("AXONTZZ_ARENA_SELECT");
+    const bool round_robin = select == nullptr ? nodes == 1 : std::strcmp(select, "round-robin") == 0;
+    std::cout << "Arenas: " << arenas << ", NUMA nodes: " << nodes
+              << ", selection: " << (select != nullptr ? select : "default") << std::endl;
+    assert(arenas >= 1 && nodes >= 1);
+    
+    int local = 0;
+    assert(memplumber::global::global_allocator_arena_of(&local) == -1);
+    
+    auto initial_stats = memplumber::global::get_global_allocator_stats();
+    {
+        // 每个线程分配小对象、中等对象和大块映射，全部交给主线程释放
+        const int num_threads = 4;
+        const size_t sizes[] = {24, 200, 1000, 3000, 256 * 1024};
+        std::vector<std::thread> threads;
+        std::vector<std::vector<char*>> handoff(num_threads);
+        std::vector<int> home(num_threads, -1);
+        
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back([t, &sizes, &handoff, &home]() {
+                for (int i = 0; i < 500; ++i) {
+                    size_t size = sizes[i % 5];
+                    if (size > 4096 && i >= 50) {
+                        continue;
+                    }
+                    char* ptr = new char[size];
+                    std::memset(ptr, t, size);
+                    handoff[t].push_back(ptr);
+                }
+                home[t] = memplumber::global::global_allocator_arena_of(handoff[t].back());
+            });
+            // 逐个启动：轮转分配下相邻线程拿到相邻的分配区
+            threads.back().join();
+        }
+        
+        for (int t = 0; t < num_threads; ++t) {
+            assert(home[t] >= 0 && static_cast<size_t>(home[t]) < arenas);
+            for (char* ptr : handoff[t]) {
+                int arena = memplumber::global::global_allocator_arena_of(ptr);
+                assert(arena >= 0);
+                if (round_robin) {
+                    assert(arena == home[t]);
+                }
+            }
+            if (round_robin && t > 0) {
+                assert(static_cast<size_t>(home[t]) == (static_cast<size_t>(home[t - 1]) + 1) % arenas);
+            }
+        }
+        
+        // 主线程释放所有对象：溢出的线程缓存按所属分配区归还
+        for (int t = 0; t < num_threads; ++t) {
+            for (char* ptr : handoff[t]) {
+                assert(ptr[0] == static_cast<char>(t));
+                delete[] ptr;
+            }
+        }
+        
+        // 另一线程分配的块在主线程 realloc：在原分配区内调整
+        void* block = nullptr;
+        std::thread([&block]() {
+            block = memplumber::global::global_allocate(100000, 16);
+        }).join();
+        assert(block != nullptr);
+        const int owner = memplumber::global::global_allocator_arena_of(block);
+        std::memset(block, 7, 100000);
+        void* grown = memplumber::global::global_reallocate(block, 400000);
+        assert(grown != nullptr);
+        assert(memplumber::global::global_allocator_arena_of(grown) == owner);
+        assert(static_cast<char*>(grown)[99999] == 7);
+        memplumber::global::global_deallocate(grown);
+    }
+    
+    // 按节点选择时，固定在一个 CPU 上的线程从本节点的分配区分配
+    std::thread([nodes, arenas]() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(sched_getcpu(), &set);
+        sched_setaffinity(0, sizeof(set), &set);
+        
+        char* ptr = new char[3000];
+        const int node = memplumber::global::global_allocator_current_node();
+        const int arena_node = memplumber::global::global_allocator_arena_node(ptr);
+        assert(node >= 0 && static_cast<size_t>(node) < nodes);
+        if (arena_node != -1) {
+            assert(arena_node == node);
+            assert(arenas % nodes == 0);
+            assert(static_cast<size_t>(memplumber::global::global_allocator_arena_of(ptr)) % nodes ==
+                   static_cast<size_t>(node));
+        }
+        delete[] ptr;
+    }).join();
+    
+    auto final_stats = memplumber::global::get_global_allocator_stats();
+    assert(final_stats.current_usage == initial_stats.current_usage);
+    std::cout << "Arena routing test passed!" << std::endl;
+}
+
+struct alignas(64) CacheLine {
+    char bytes[64];
+};
+
+struct alignas(256) OverAligned {
+    int value;
+};
+
+bool aligned_to(const void* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+void test_aligned_and_sized_new_delete() {
+    std::cout << "Testing aligned and sized new/delete..." << std::endl;
+    
+    // 普通 new 满足 __STDCPP_DEFAULT_NEW_ALIGNMENT__
+    std::vector<char*> buffers;
+    for (std::size_t size = 1; size <= 4096; size += 7) {
+        char* buffer = new char[size];
+        assert(aligned_to(buffer, __STDCPP_DEFAULT_NEW_ALIGNMENT__));
+        buffers.push_back(buffer);
+    }
+    for (char* buffer : buffers) {
+        delete[] buffer;
+    }
+    
+    // 过度对齐的类型经 align_val_t 重载分配
+    CacheLine* line = new CacheLine();
+    assert(aligned_to(line, 64));
+    delete line;
+    
+    OverAligned* array = new OverAligned[10];
+    assert(aligned_to(array, 256));
+    array[9].value = 9;
+    delete[] array;
+    
+    OverAligned* nothrow = new (std::nothrow) OverAligned();
+    assert(nothrow != nullptr && aligned_to(nothrow, 256));
+    delete nothrow;
+    
+    std::vector<CacheLine> lines(100);
+    assert(aligned_to(lines.data(), 64));
+    assert(memplumber::global::is_pointer_owned_by_global_allocator(lines.data()));
+    
+    void* page = ::operator new(100, std::align_val_t(4096));
+    assert(aligned_to(page, 4096));
+    ::operator delete(page, 100, std::align_val_t(4096));
+    
+    // 带大小的 delete 直接把对象放回线程缓存：紧接着的同级分配复用同一地址
+    void* first = ::operator new(40);
+    ::operator delete(first, 40);
+    void* second = ::operator new(33); // 同属 48 字节分级
+    assert(second == first);
+    ::operator delete(second, 33);
+    
+    // 不超过默认对齐的 align_val_t 分配同样走分级快速路径
+    void* small = ::operator new(40, std::align_val_t(8));
+    assert(aligned_to(small, 8));
+    ::operator delete(small, 40, std::align_val_t(8));
+    void* again = ::operator new(40);
+    assert(again == small);
+    ::operator delete(again);
+    
+    std::cout << "Aligned and sized new/delete test passed!" << std::endl;
+}
+
 void test_allocation_stats() {
     std::cout << "Testing allocation statistics..." << std::endl;
     
@@ -132,6 +380,39 @@ void test_allocation_stats() {
     std::cout << "Fragmentation ratio: " << stats.fragmentation_ratio << std::endl;
     std::cout << "===================================" << std::endl;
     
+    // 按尺寸分级：3000 字节的请求落在 (2048, 4096] 级
+    const size_t cls = memplumber::stats_size_class(3000);
+    auto before = memplumber::global::global_allocator_size_class_stats();
+    std::vector<char*> buffers;
+    for (int i = 0; i < 100; ++i) {
+        buffers.push_back(new char[3000]);
+    }
+    for (char* buffer : buffers) {
+        delete[] buffer;
+    }
+    auto after = memplumber::global::global_allocator_size_class_stats();
+    assert(after[cls].max_size == 4096);
+    assert(after[cls].allocation_count >= before[cls].allocation_count + 100);
+    assert(after[cls].bytes_allocated >= before[cls].bytes_allocated + 300000);
+    assert(after[cls].deallocation_count >= before[cls].deallocation_count + 100);
+    for (size_t i = 0; i < memplumber::STATS_SIZE_CLASS_COUNT; ++i) {
+        if (after[i].allocation_count != 0) {
+            std::cout << "  <= " << after[i].max_size << ": " << after[i].allocation_count
+                      << " allocations, " << after[i].bytes_allocated << " bytes" << std::endl;
+        }
+    }
+    
+    // 堆布局导出：直接写入文件描述符
+    std::FILE* file = std::tmpfile();
+    assert(file != nullptr);
+    assert(memplumber::global::write_global_heap_map(fileno(file)));
+    long length = lseek(fileno(file), 0, SEEK_END);
+    char head[32] = {};
+    assert(pread(fileno(file), head, sizeof(head) - 1, 0) > 0);
+    assert(std::strncmp(head, "{\"allocator\":", 13) == 0);
+    std::cout << "Global heap map: " << length << " bytes" << std::endl;
+    std::fclose(file);
+    
     std::cout << "Statistics test completed!" << std::endl;
 }
 
@@ -151,6 +432,15 @@ int main() {
         test_nothrow_new();
         std::cout << std::endl;
         
+        test_multithreaded_new_delete();
+        std::cout << std::endl;
+        
+        test_arena_routing();
+        std::cout << std::endl;
+        
+        test_aligned_and_sized_new_delete();
+        std::cout << std::endl;
+        
         test_allocation_stats();
         
         std::cout << "\n✓ All global allocator tests passed!" << std::endl;
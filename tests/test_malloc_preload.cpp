@@ -0,0 +1,299 @@
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <fstream>
+#include <malloc.h>
+#include <pthread.h>
+#include <random>
+#include <sstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// libaxontzz.so 与测试程序位于同一目录
+static std::string g_library;
+static std::string g_self;
+
+static std::string read_file(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+
+static int run_command(const std::string& command) {
+    int status = std::system(command.c_str());
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+static bool is_aligned(const void* ptr, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+// ---- 以下在 LD_PRELOAD 下的子进程中运行，只经过 C 分配接口 ----
+
+static void* thread_churn(void* arg) {
+    auto* handoff = static_cast<std::vector<void*>*>(arg);
+    std::mt19937 rng(42);
+    std::vector<void*> live;
+    for (int i = 0; i < 20000; ++i) {
+        std::size_t size = 1 + rng() % 2048;
+        void* ptr = malloc(size);
+        assert(ptr != nullptr);
+        std::memset(ptr, 0x5a, size);
+        live.push_back(ptr);
+        if (live.size() > 64) {
+            std::size_t victim = rng() % live.size();
+            free(live[victim]);
+            live[victim] = live.back();
+            live.pop_back();
+        }
+    }
+    for (void* ptr : live) {
+        free(ptr);
+    }
+    // 留给主线程释放：跨线程 free
+    for (int i = 0; i < 100; ++i) {
+        handoff->push_back(malloc(64 + i));
+    }
+    return nullptr;
+}
+
+static int preloaded_checks() {
+    std::cout << "Checking malloc interface inside preloaded process..." << std::endl;
+
+    // malloc 确实解析到了 libaxontzz.so
+    Dl_info info;
+    void* symbol = dlsym(RTLD_DEFAULT, "malloc");
+    assert(symbol != nullptr && dladdr(symbol, &info) != 0);
+    assert(std::strstr(info.dli_fname, "libaxontzz.so") != nullptr);
+
+    // malloc / malloc_usable_size / free
+    void* small = malloc(100);
+    assert(small != nullptr && is_aligned(small, alignof(std::max_align_t)));
+    assert(malloc_usable_size(small) >= 100);
+    std::memset(small, 0xff, malloc_usable_size(small));
+    void* empty_a = malloc(0);
+    void* empty_b = malloc(0);
+    assert(empty_a != nullptr && empty_b != nullptr && empty_a != empty_b);
+    free(empty_a);
+    free(empty_b);
+    free(small);
+    free(nullptr);
+    assert(malloc_usable_size(nullptr) == 0);
+
+    // calloc 清零复用的块，乘法溢出返回 ENOMEM
+    unsigned char* dirty = static_cast<unsigned char*>(malloc(8000));
+    std::memset(dirty, 0xab, 8000);
+    free(dirty);
+    unsigned char* zeroed = static_cast<unsigned char*>(calloc(1000, 8));
+    assert(zeroed != nullptr);
+    assert(std::all_of(zeroed, zeroed + 8000, [](unsigned char c) { return c == 0; }));
+    free(zeroed);
+    volatile std::size_t huge_count = SIZE_MAX / 2; // 运行时才知道会溢出
+    errno = 0;
+    assert(calloc(huge_count, 4) == nullptr && errno == ENOMEM);
+
+    // realloc 增长跨越大对象阈值时内容保持不变
+    unsigned char* grown = nullptr;
+    std::size_t size = 0;
+    for (std::size_t next = 1; next <= 2 * 1024 * 1024; next *= 3) {
+        grown = static_cast<unsigned char*>(realloc(grown, next));
+        assert(grown != nullptr);
+        for (std::size_t i = 0; i < size; ++i) {
+            assert(grown[i] == static_cast<unsigned char>(i * 7));
+        }
+        for (std::size_t i = size; i < next; ++i) {
+            grown[i] = static_cast<unsigned char>(i * 7);
+        }
+        size = next;
+    }
+    unsigned char* shrunk = static_cast<unsigned char*>(realloc(grown, 100));
+    assert(shrunk != nullptr && shrunk[99] == static_cast<unsigned char>(99 * 7));
+    assert(realloc(shrunk, 0) == nullptr);
+    errno = 0;
+    assert(reallocarray(nullptr, huge_count, 4) == nullptr && errno == ENOMEM);
+
+    // 对齐分配
+    void* aligned = nullptr;
+    assert(posix_memalign(&aligned, 4096, 300) == 0);
+    assert(is_aligned(aligned, 4096));
+    free(aligned);
+    assert(posix_memalign(&aligned, 24, 300) == EINVAL);
+    void* cache_line = aligned_alloc(64, 640);
+    assert(cache_line != nullptr && is_aligned(cache_line, 64));
+    free(cache_line);
+    errno = 0;
+    assert(aligned_alloc(48, 64) == nullptr && errno == EINVAL);
+    void* legacy = memalign(256, 10);
+    assert(legacy != nullptr && is_aligned(legacy, 256));
+    free(legacy);
+    void* page = valloc(10);
+    assert(page != nullptr && is_aligned(page, static_cast<std::size_t>(sysconf(_SC_PAGESIZE))));
+    free(page);
+
+    // 多线程分配，退出线程分配的块由主线程释放
+    std::vector<void*> handoffs[4];
+    pthread_t threads[4];
+    for (int i = 0; i < 4; ++i) {
+        assert(pthread_create(&threads[i], nullptr, thread_churn, &handoffs[i]) == 0);
+    }
+    for (int i = 0; i < 4; ++i) {
+        pthread_join(threads[i], nullptr);
+        for (void* ptr : handoffs[i]) {
+            free(ptr);
+        }
+    }
+
+    // fork 之后父子进程都能继续分配
+    pid_t child = fork();
+    assert(child >= 0);
+    if (child == 0) {
+        void* ptr = malloc(4096);
+        free(ptr);
+        _exit(ptr != nullptr ? 0 : 1);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    free(malloc(123));
+
+    std::cout << "Preloaded malloc checks passed!" << std::endl;
+    return 0;
+}
+
+// ---- 以下在测试进程中运行 ----
+
+void test_malloc_interface() {
+    std::cout << "Testing malloc interface under LD_PRELOAD..." << std::endl;
+    int status = run_command("LD_PRELOAD=" + g_library + " " + g_self + " --preloaded");
+    assert(status == 0);
+    std::cout << "Malloc interface test passed!" << std::endl;
+}
+
+void test_unmodified_sort() {
+    std::cout << "Testing unmodified sort(1) under LD_PRELOAD..." << std::endl;
+
+    char input_path[] = "/tmp/axontzz_sort_in_XXXXXX";
+    int fd = mkstemp(input_path);
+    assert(fd >= 0);
+    close(fd);
+    std::string output_path = std::string(input_path) + ".out";
+    std::string stats_path = std::string(input_path) + ".err";
+
+    std::mt19937 rng(7);
+    std::vector<std::string> lines;
+    {
+        std::ofstream input(input_path);
+        for (int i = 0; i < 50000; ++i) {
+            std::string line(1 + rng() % 120, 'a');
+            for (char& c : line) {
+                c = static_cast<char>('a' + rng() % 26);
+            }
+            input << line << '\n';
+            lines.push_back(line);
+        }
+    }
+    std::sort(lines.begin(), lines.end());
+
+    int status = run_command("LC_ALL=C AXONTZZ_STATS=1 LD_PRELOAD=" + g_library +
+                             " sort " + input_path + " > " + output_path + " 2> " + stats_path);
+    assert(status == 0);
+
+    std::stringstream expected;
+    for (const std::string& line : lines) {
+        expected << line << '\n';
+    }
+    assert(read_file(output_path) == expected.str());
+
+    // 退出时的计数报告证明分配确实经过了本库
+    std::string report = read_file(stats_path);
+    std::cout << report;
+    std::size_t allocations = 0;
+    assert(std::sscanf(report.c_str(), "axontzz: allocations=%zu", &allocations) == 1);
+    assert(allocations > 0);
+
+    std::remove(input_path);
+    std::remove(output_path.c_str());
+    std::remove(stats_path.c_str());
+    std::cout << "Sort test passed!" << std::endl;
+}
+
+void test_unmodified_python() {
+    std::cout << "Testing unmodified python3 under LD_PRELOAD..." << std::endl;
+    if (run_command("python3 -c pass > /dev/null 2>&1") != 0) {
+        std::cout << "python3 not available, skipped" << std::endl;
+        return;
+    }
+
+    const std::string script =
+        "python3 -c '"
+        "import threading, hashlib\n"
+        "d = {str(i): [i] * (i % 17) for i in range(200000)}\n"
+        "def work(n):\n"
+        "    blobs = [bytes(n * k % 5000) for k in range(5000)]\n"
+        "    d[n] = sum(len(b) for b in blobs)\n"
+        "ts = [threading.Thread(target=work, args=(n,)) for n in range(1, 5)]\n"
+        "[t.start() for t in ts]; [t.join() for t in ts]\n"
+        "print(hashlib.sha256(repr(sorted((str(k), str(v)) for k, v in d.items())).encode()).hexdigest())'";
+
+    char plain_path[] = "/tmp/axontzz_python_XXXXXX";
+    int fd = mkstemp(plain_path);
+    assert(fd >= 0);
+    close(fd);
+    std::string preloaded_path = std::string(plain_path) + ".preloaded";
+
+    assert(run_command(script + " > " + plain_path) == 0);
+    assert(run_command("LD_PRELOAD=" + g_library + " " + script + " > " + preloaded_path) == 0);
+    std::string plain = read_file(plain_path);
+    assert(plain.size() == 65);
+    assert(read_file(preloaded_path) == plain);
+
+    std::remove(plain_path);
+    std::remove(preloaded_path.c_str());
+    std::cout << "Python test passed!" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--preloaded") == 0) {
+        return preloaded_checks();
+    }
+
+    std::cout << "=== Malloc Preload Tests ===" << std::endl;
+
+    char self[4096];
+    ssize_t length = readlink("/proc/self/exe", self, sizeof(self) - 1);
+    assert(length > 0);
+    self[length] = '\0';
+    g_self = self;
+    g_library = g_self.substr(0, g_self.rfind('/')) + "/libaxontzz.so";
+    if (access(g_library.c_str(), R_OK) != 0) {
+        std::cerr << "Missing " << g_library << ", build it with make all" << std::endl;
+        return 1;
+    }
+
+    try {
+        test_malloc_interface();
+        test_unmodified_sort();
+        test_unmodified_python();
+
+        std::cout << "\n✓ All malloc preload tests passed!" << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Test failed with unknown exception" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,199 @@
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_resource.h"
+#include "axontzz/memory_source.h"
+#include "axontzz/slab_allocator.h"
+#include <iostream>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace memplumber;
+
+// 记录每次分配的大小，检查释放时传回的大小与之一致
+class SizeCheckingAllocator : public AllocatorInterface {
+public:
+    explicit SizeCheckingAllocator(AllocatorInterface& inner) : inner_(inner) {}
+
+    void* allocate(size_t size, size_t alignment = sizeof(void*)) override {
+        void* ptr = inner_.allocate(size, alignment);
+        if (ptr != nullptr) {
+            live_[ptr] = size;
+            max_alignment = std::max(max_alignment, alignment);
+        }
+        return ptr;
+    }
+
+    void deallocate(void* ptr, size_t size = 0) override {
+        auto it = live_.find(ptr);
+        assert(it != live_.end());
+        if (it->second != size) {
+            size_mismatches++;
+        }
+        live_.erase(it);
+        inner_.deallocate(ptr, size);
+    }
+
+    bool owns(void* ptr) const override { return inner_.owns(ptr); }
+    AllocatorStats get_stats() const override { return inner_.get_stats(); }
+    void reset_stats() override { inner_.reset_stats(); }
+    const char* get_name() const override { return "SizeCheckingAllocator"; }
+
+    size_t live_count() const { return live_.size(); }
+    size_t size_mismatches = 0;
+    size_t max_alignment = 0;
+
+private:
+    AllocatorInterface& inner_;
+    std::unordered_map<void*, size_t> live_; // 使用全局分配器，不经过被测资源
+};
+
+void test_polymorphic_resource() {
+    std::cout << "Testing AllocatorResource with pmr containers..." << std::endl;
+
+    MemorySource memory_source;
+    FreeListAllocator heap(memory_source, 64 * 1024);
+    SizeCheckingAllocator checker(heap);
+    AllocatorResource resource(checker);
+
+    {
+        std::pmr::vector<int> numbers(&resource);
+        for (int i = 0; i < 10000; ++i) {
+            numbers.push_back(i);
+        }
+        assert(numbers[9999] == 9999);
+        assert(heap.owns(numbers.data()));
+
+        std::pmr::unordered_map<int, std::pmr::string> names(&resource);
+        for (int i = 0; i < 2000; ++i) {
+            names.emplace(i, std::pmr::string("value-" + std::to_string(i) + std::string(40, 'x'),
+                                              &resource));
+        }
+        assert(names.at(1234).compare(0, 10, "value-1234") == 0);
+        assert(names.get_allocator().resource() == &resource);
+        for (int i = 0; i < 2000; i += 2) {
+            names.erase(i);
+        }
+        assert(names.size() == 1000);
+        assert(heap.validate_free_list());
+    }
+
+    // 容器析构后全部归还，且每次释放都带回了分配时的大小
+    assert(checker.live_count() == 0);
+    assert(checker.size_mismatches == 0);
+    assert(checker.max_alignment >= alignof(int));
+    assert(heap.get_stats().current_usage == 0);
+    assert(heap.get_stats().allocation_count > 0);
+
+    std::cout << "Polymorphic resource test passed!" << std::endl;
+}
+
+void test_typed_resource() {
+    std::cout << "Testing TypedAllocatorResource..." << std::endl;
+
+    MemorySource memory_source;
+    FreeListAllocator heap(memory_source, 64 * 1024);
+    TypedAllocatorResource<FreeListAllocator> resource(heap);
+
+    {
+        std::pmr::unordered_map<std::uint64_t, std::pmr::vector<double>> table(&resource);
+        for (std::uint64_t key = 0; key < 500; ++key) {
+            auto& values = table[key];
+            for (int i = 0; i < 20; ++i) {
+                values.push_back(static_cast<double>(key) * i);
+            }
+        }
+        assert(table[499][19] == 499.0 * 19);
+        assert(table[7].get_allocator().resource() == &resource);
+        assert(heap.get_stats().current_usage > 500 * 20 * sizeof(double));
+    }
+    assert(heap.get_stats().current_usage == 0);
+    assert(heap.validate_free_list());
+
+    // 过度对齐与零字节请求
+    void* aligned = resource.allocate(100, 256);
+    assert(reinterpret_cast<std::uintptr_t>(aligned) % 256 == 0);
+    void* empty = resource.allocate(0, 8);
+    assert(empty != nullptr && empty != aligned);
+    resource.deallocate(aligned, 100, 256);
+    resource.deallocate(empty, 0, 8);
+    assert(heap.get_stats().current_usage == 0);
+
+    std::cout << "Typed resource test passed!" << std::endl;
+}
+
+void test_resource_equality_and_failure() {
+    std::cout << "Testing resource equality and allocation failure..." << std::endl;
+
+    MemorySource memory_source;
+    FreeListAllocator heap_a(memory_source, 64 * 1024);
+    FreeListAllocator heap_b(memory_source, 64 * 1024);
+
+    AllocatorResource a1(heap_a);
+    AllocatorResource a2(heap_a);
+    AllocatorResource b(heap_b);
+    TypedAllocatorResource<FreeListAllocator> typed_a1(heap_a);
+    TypedAllocatorResource<FreeListAllocator> typed_a2(heap_a);
+
+    assert(a1 == a2);
+    assert(a1 != b);
+    assert(typed_a1 == typed_a2);
+    assert(typed_a1 != a1);
+
+    // 相等的资源之间可以交换内存：用 a2 释放 a1 分配的块
+    void* ptr = a1.allocate(128);
+    a2.deallocate(ptr, 128);
+    assert(heap_a.get_stats().current_usage == 0);
+
+    // 分配器失败时抛出 bad_alloc
+    SlabAllocator slab(memory_source, 32);
+    TypedAllocatorResource<SlabAllocator> slab_resource(slab);
+    void* object = slab_resource.allocate(24, 8);
+    slab_resource.deallocate(object, 24, 8);
+    bool threw = false;
+    try {
+        void* too_big = slab_resource.allocate(64, 8);
+        (void)too_big;
+    } catch (const std::bad_alloc&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // ThreadSafeAllocator 经多态接口接入
+    ThreadSafeAllocator<FreeListAllocator> locked(memory_source, 64 * 1024);
+    AllocatorResource locked_resource(locked);
+    {
+        std::pmr::vector<std::pmr::string> words(&locked_resource);
+        for (int i = 0; i < 100; ++i) {
+            words.emplace_back(std::string(64, static_cast<char>('a' + i % 26)));
+        }
+        assert(words[25][0] == 'z');
+    }
+    assert(locked.get_stats().current_usage == 0);
+
+    std::cout << "Equality and failure test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Memory Resource Tests ===" << std::endl;
+
+    try {
+        test_polymorphic_resource();
+        test_typed_resource();
+        test_resource_equality_and_failure();
+
+        std::cout << "\n✓ All memory resource tests passed!" << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Test failed with unknown exception" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -2,6 +2,8 @@
 #include "axontzz/memory_source.h"
 #include <iostream>
 #include <cassert>
+#include <random>
+#include <vector>
 
 using namespace memplumber;
 
@@ -72,6 +74,109 @@ void test_multiple_sizes() {
     std::cout << "Multiple sizes test completed!" << std::endl;
 }
 
+void test_boundary_tag_coalescing() {
+    std::cout << "Testing boundary-tag coalescing and fragmentation..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 256 * 1024);
+    
+    const size_t initial_largest = allocator.largest_free_block();
+    assert(allocator.free_block_count() == 1);
+    
+    // 随机分配/释放，每一步都检查边界标记与自由链表一致，且不存在相邻的自由块
+    std::mt19937 rng(12345);
+    std::uniform_int_distribution<size_t> size_dist(1, 700);
+    std::vector<void*> live;
+    std::vector<size_t> live_sizes;
+    for (int step = 0; step < 2000; ++step) {
+        if (live.empty() || rng() % 3 != 0) {
+            size_t size = size_dist(rng);
+            size_t alignment = (rng() % 8 == 0) ? 64 : sizeof(void*);
+            void* ptr = allocator.allocate(size, alignment);
+            assert(ptr != nullptr);
+            assert(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+            live.push_back(ptr);
+            live_sizes.push_back(size);
+        } else {
+            size_t index = rng() % live.size();
+            allocator.deallocate(live[index], live_sizes[index]);
+            live[index] = live.back();
+            live_sizes[index] = live_sizes.back();
+            live.pop_back();
+            live_sizes.pop_back();
+        }
+        assert(allocator.validate_free_list());
+    }
+    
+    // 逆序释放剩余块：每次释放都应立即与两侧邻居合并
+    while (!live.empty()) {
+        allocator.deallocate(live.back(), live_sizes.back());
+        live.pop_back();
+        live_sizes.pop_back();
+        assert(allocator.validate_free_list());
+    }
+    
+    // 全部释放后，首个区域应恢复为一整块，外部碎片为零
+    assert(allocator.get_stats().current_usage == 0);
+    assert(allocator.largest_free_block() >= initial_largest);
+    void* whole = allocator.allocate(initial_largest / 2);
+    assert(whole != nullptr);
+    allocator.deallocate(whole, initial_largest / 2);
+    
+    // 每个区域各剩一整块自由块（未扩容时只有一个）
+    assert(allocator.free_block_count() == allocator.region_count());
+    
+    std::cout << "Boundary-tag coalescing test passed!" << std::endl;
+}
+
+void test_arena_growth_coalescing() {
+    std::cout << "Testing heap growth inside an address space arena..." << std::endl;
+    
+    MemorySource memory_source(MemorySource::HugePagePolicy::None, 256 * 1024 * 1024);
+    {
+        FreeListAllocator allocator(memory_source, 64 * 1024, 0);
+        
+        // 远超初始区域的分配：堆原地增长，始终只有一个区域
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 200; ++i) {
+            void* ptr = allocator.allocate(3000 + (i % 7) * 1000);
+            assert(ptr != nullptr);
+            assert(memory_source.in_arena(ptr));
+            ptrs.push_back(ptr);
+        }
+        assert(allocator.region_count() == 1);
+        assert(allocator.validate_free_list());
+        
+        // 跨越原区域边界的分配：末尾的自由块与新提交的段合并后足够大
+        void* spanning = allocator.allocate(100 * 1024);
+        assert(spanning != nullptr);
+        assert(allocator.region_count() == 1);
+        assert(allocator.owns(spanning));
+        
+        for (void* ptr : ptrs) {
+            allocator.deallocate(ptr);
+        }
+        allocator.deallocate(spanning);
+        
+        // 全部释放后整个堆合并为一个自由块
+        assert(allocator.free_block_count() == 1);
+        assert(allocator.largest_free_block() + 64 > allocator.memory_usage().reserved);
+        assert(allocator.validate_free_list());
+        std::cout << "Heap grew to " << allocator.memory_usage().reserved
+                  << " bytes in one region" << std::endl;
+        
+        // 回收后提交边界回到起点
+        allocator.trim(0);
+        assert(memory_source.arena_frontier() == 0);
+        void* fresh = allocator.allocate(128);
+        assert(fresh != nullptr && memory_source.in_arena(fresh));
+        allocator.deallocate(fresh);
+    }
+    assert(memory_source.get_stats().current_usage == 0);
+    
+    std::cout << "Arena growth test passed!" << std::endl;
+}
+
 int main() {
     std::cout << "=== Memory Reuse Tests ===" << std::endl;
     
@@ -79,6 +184,10 @@ int main() {
         test_basic_memory_reuse();
         std::cout << std::endl;
         test_multiple_sizes();
+        std::cout << std::endl;
+        test_boundary_tag_coalescing();
+        std::cout << std::endl;
+        test_arena_growth_coalescing();
         
         std::cout << "\n✓ All memory reuse tests passed!" << std::endl;
         
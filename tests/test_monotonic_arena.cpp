@@ -0,0 +1,243 @@
+#include "axontzz/monotonic_arena.h"
+#include "axontzz/memory_source.h"
+#include <iostream>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+using namespace memplumber;
+
+static bool is_aligned(const void* ptr, size_t alignment) {
+    return reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+void test_bump_allocation() {
+    std::cout << "Testing bump allocation..." << std::endl;
+
+    MemorySource memory_source;
+    MonotonicArena arena(memory_source, 16 * 1024);
+    assert(std::strcmp(arena.get_name(), "MonotonicArena") == 0);
+    assert(arena.block_count() == 0 && arena.reserved_bytes() == 0);
+
+    // 连续分配紧挨着排列，没有对象头
+    char* a = static_cast<char*>(arena.allocate(24));
+    char* b = static_cast<char*>(arena.allocate(40));
+    assert(a != nullptr && b == a + 24);
+    std::memset(a, 0x11, 24);
+    std::memset(b, 0x22, 40);
+
+    // 对齐请求跳过填充
+    void* wide = arena.allocate(8, 256);
+    assert(wide != nullptr && is_aligned(wide, 256));
+    assert(arena.allocate(0) == nullptr);
+
+    assert(arena.owns(a) && arena.owns(wide));
+    assert(!arena.owns(nullptr));
+    int local = 0;
+    assert(!arena.owns(&local));
+
+    // 释放不回收任何东西
+    arena.deallocate(b, 40);
+    void* c = arena.allocate(40);
+    assert(c != b);
+    assert(a[23] == 0x11 && b[39] == 0x22);
+
+    auto stats = arena.get_stats();
+    assert(stats.allocation_count == 4);
+    assert(stats.current_usage == 24 + 40 + 8 + 40);
+    assert(arena.used_bytes() == stats.current_usage);
+    assert(arena.block_count() == 1);
+
+    std::cout << "Bump allocation test passed!" << std::endl;
+}
+
+void test_block_growth() {
+    std::cout << "Testing block growth..." << std::endl;
+
+    MemorySource memory_source;
+    MonotonicArena arena(memory_source, 8 * 1024, 64 * 1024);
+
+    // 填满若干块：块大小按几何级数增长，直到上限
+    size_t total = 0;
+    while (arena.block_count() < 6) {
+        void* ptr = arena.allocate(1000);
+        assert(ptr != nullptr && arena.owns(ptr));
+        std::memset(ptr, 0x5a, 1000);
+        total += 1000;
+    }
+    assert(arena.used_bytes() == total);
+    assert(arena.reserved_bytes() >= 8 * 1024 + 16 * 1024 + 32 * 1024 + 3 * 64 * 1024);
+    assert(arena.reserved_bytes() < 8 * 1024 + 16 * 1024 + 32 * 1024 + 4 * 64 * 1024);
+
+    // 超大请求单独占一个块，后续小对象仍能用原块剩余的空间
+    const size_t blocks = arena.block_count();
+    assert(arena.allocate(64) != nullptr);
+    char* huge = static_cast<char*>(arena.allocate(1024 * 1024));
+    assert(huge != nullptr && arena.owns(huge + 1024 * 1024 - 1));
+    std::memset(huge, 0x77, 1024 * 1024);
+    assert(arena.block_count() == blocks + 1);
+
+    std::cout << "Block growth test passed!" << std::endl;
+}
+
+void test_reset_keeps_blocks() {
+    std::cout << "Testing reset keeps blocks..." << std::endl;
+
+    MemorySource memory_source;
+    MonotonicArena arena(memory_source, 16 * 1024, 256 * 1024);
+
+    // 第一轮请求：映射所需的块
+    void* first = nullptr;
+    for (size_t i = 0; i < 2000; ++i) {
+        void* ptr = arena.allocate(16 + i % 200);
+        assert(ptr != nullptr);
+        if (first == nullptr) {
+            first = ptr;
+        }
+    }
+    const size_t blocks = arena.block_count();
+    const size_t reserved = arena.reserved_bytes();
+    const size_t mappings = memory_source.get_stats().allocation_count;
+    assert(blocks > 1);
+
+    // 之后的每一轮都复用同样的块，不再向OS申请
+    for (int round = 0; round < 10; ++round) {
+        arena.reset();
+        assert(arena.used_bytes() == 0 && arena.used_block_count() == 0);
+        void* again = nullptr;
+        for (size_t i = 0; i < 2000; ++i) {
+            void* ptr = arena.allocate(16 + i % 200);
+            assert(ptr != nullptr);
+            if (again == nullptr) {
+                again = ptr;
+            }
+        }
+        assert(again == first);
+        assert(arena.used_block_count() == blocks);
+    }
+    assert(arena.block_count() == blocks);
+    assert(arena.reserved_bytes() == reserved);
+    assert(memory_source.get_stats().allocation_count == mappings);
+
+    // release() 把块还给OS，之后仍可继续使用
+    const size_t usage = memory_source.get_stats().current_usage;
+    arena.release();
+    assert(arena.block_count() == 0 && arena.reserved_bytes() == 0);
+    assert(memory_source.get_stats().current_usage == usage - reserved);
+    assert(arena.allocate(100) != nullptr && arena.block_count() == 1);
+
+    std::cout << "Reset test passed!" << std::endl;
+}
+
+void test_checkpoint_rollback() {
+    std::cout << "Testing nested checkpoint and rollback..." << std::endl;
+
+    MemorySource memory_source;
+    MonotonicArena arena(memory_source, 8 * 1024);
+
+    // 检查点可以在第一个块映射之前设置
+    MonotonicArena::Checkpoint empty = arena.checkpoint();
+    char* base = static_cast<char*>(arena.allocate(100));
+    std::memset(base, 0x33, 100);
+
+    MonotonicArena::Checkpoint outer = arena.checkpoint();
+    char* x = static_cast<char*>(arena.allocate(200));
+    MonotonicArena::Checkpoint inner = arena.checkpoint();
+
+    // 内层跨越多个块
+    std::vector<void*> scratch;
+    for (int i = 0; i < 100; ++i) {
+        scratch.push_back(arena.allocate(500));
+    }
+    assert(arena.used_block_count() > 1);
+    const size_t blocks = arena.block_count();
+
+    // 回滚内层：游标回到 inner，后续分配紧接着 x
+    arena.rollback(inner);
+    assert(arena.used_bytes() == 300 && arena.used_block_count() == 1);
+    char* y = static_cast<char*>(arena.allocate(50));
+    assert(y == x + 200);
+
+    // 回滚外层：x 与 y 都被丢弃，base 不受影响
+    arena.rollback(outer);
+    assert(arena.allocate(200) == x);
+    assert(base[99] == 0x33);
+
+    // 再次填满：复用回滚时留下的块，不新增映射
+    for (int i = 0; i < 100; ++i) {
+        assert(arena.allocate(500) != nullptr);
+    }
+    assert(arena.block_count() == blocks);
+
+    // Scope 在析构时回滚，可以嵌套
+    const size_t before = arena.used_bytes();
+    {
+        MonotonicArena::Scope request(arena);
+        arena.allocate(1000);
+        {
+            MonotonicArena::Scope nested(arena);
+            arena.allocate(3000);
+            assert(arena.used_bytes() == before + 4000);
+        }
+        assert(arena.used_bytes() == before + 1000);
+    }
+    assert(arena.used_bytes() == before);
+
+    arena.rollback(empty);
+    assert(arena.used_bytes() == 0 && arena.allocate(100) == base);
+
+    std::cout << "Checkpoint test passed!" << std::endl;
+}
+
+void test_reallocate_last() {
+    std::cout << "Testing reallocate of the latest allocation..." << std::endl;
+
+    MemorySource memory_source;
+    MonotonicArena arena(memory_source, 16 * 1024);
+
+    // 最近一次分配在原地增长与缩小
+    char* buffer = static_cast<char*>(arena.allocate(64));
+    std::memset(buffer, 0x44, 64);
+    char* grown = static_cast<char*>(arena.reallocate(buffer, 64, 4096));
+    assert(grown == buffer && grown[63] == 0x44);
+    assert(arena.used_bytes() == 4096);
+    char* shrunk = static_cast<char*>(arena.reallocate(grown, 4096, 128));
+    assert(shrunk == buffer && arena.used_bytes() == 128);
+    assert(static_cast<char*>(arena.allocate(8)) == buffer + 128);
+
+    // 之前的分配：缩小保持原址，增长复制到新位置
+    assert(arena.reallocate(buffer, 128, 100) == buffer);
+    char* moved = static_cast<char*>(arena.reallocate(buffer, 128, 256));
+    assert(moved != buffer && moved[63] == 0x44);
+
+    // 放不下当前块时换块复制
+    char* large = static_cast<char*>(arena.reallocate(moved, 256, 64 * 1024));
+    assert(large != nullptr && large[63] == 0x44 && arena.owns(large));
+    assert(arena.reallocate(nullptr, 0, 32) != nullptr);
+
+    std::cout << "Reallocate test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== MonotonicArena Tests ===" << std::endl;
+
+    try {
+        test_bump_allocation();
+        test_block_growth();
+        test_reset_keeps_blocks();
+        test_checkpoint_rollback();
+        test_reallocate_last();
+
+        std::cout << "\n✓ All MonotonicArena tests passed!" << std::endl;
+
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Test failed with unknown exception" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
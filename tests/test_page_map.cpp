@@ -0,0 +1,107 @@
+#include "axontzz/page_map.h"
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+
+using namespace memplumber;
+
+void test_page_map_set_lookup_clear() {
+    std::cout << "Testing PageMap set/lookup/clear..." << std::endl;
+    
+    MemorySource memory_source;
+    PageMap page_map(memory_source);
+    int tag_a = 0;
+    int tag_b = 0;
+    
+    assert(page_map.lookup(&tag_a) == nullptr);
+    assert(page_map.memory_overhead() == 0);
+    
+    // 跨越叶子节点边界（一个叶子覆盖 16 MiB）的区间
+    char* base = reinterpret_cast<char*>(uintptr_t(0x7f0000000000) + (16u << 20) - 8192);
+    assert(page_map.set_range(base, 5 * 4096, &tag_a));
+    assert(page_map.lookup(base) == &tag_a);
+    assert(page_map.lookup(base + 4095) == &tag_a);
+    assert(page_map.lookup(base + 8192) == &tag_a);   // 下一个叶子的第一页
+    assert(page_map.lookup(base + 5 * 4096 - 1) == &tag_a);
+    assert(page_map.lookup(base + 5 * 4096) == nullptr);
+    assert(page_map.lookup(base - 1) == nullptr);
+    
+    // 根节点 + 中间节点 + 两个叶子
+    assert(page_map.node_count() == 4);
+    assert(page_map.memory_overhead() == 4 * 32 * 1024);
+    std::cout << "Page map overhead for 20 KiB range: " << page_map.memory_overhead() << " bytes" << std::endl;
+    
+    // 覆盖与清除
+    assert(page_map.set_range(base + 4096, 4096, &tag_b));
+    assert(page_map.lookup(base + 4096) == &tag_b);
+    page_map.clear_range(base, 2 * 4096);
+    assert(page_map.lookup(base) == nullptr);
+    assert(page_map.lookup(base + 4096) == nullptr);
+    assert(page_map.lookup(base + 8192) == &tag_a);
+    
+    // 超出 48 位地址空间的指针
+    void* high = reinterpret_cast<void*>(uintptr_t(1) << 50);
+    assert(page_map.lookup(high) == nullptr);
+    assert(!page_map.set_range(high, 4096, &tag_a));
+    
+    std::cout << "PageMap set/lookup/clear test passed!" << std::endl;
+}
+
+void test_allocator_owns_with_many_regions() {
+    std::cout << "Testing O(1) owns() across many regions..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 4096);
+    
+    // 每次分配都大于默认块，迫使堆扩展出新区域
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 64; ++i) {
+        void* ptr = allocator.allocate(8192);
+        assert(ptr != nullptr);
+        ptrs.push_back(ptr);
+    }
+    for (void* ptr : ptrs) {
+        assert(allocator.owns(ptr));
+        assert(allocator.owns(static_cast<char*>(ptr) + 8191));
+    }
+    int local = 0;
+    assert(!allocator.owns(&local));
+    
+    // 不属于本分配器的指针被拒绝，统计不变
+    allocator.deallocate(&local, sizeof(local));
+    assert(allocator.get_stats().deallocation_count == 0);
+    
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr, 8192);
+    }
+    assert(allocator.validate_free_list());
+    assert(allocator.get_stats().current_usage == 0);
+    
+    std::cout << "Page map overhead for " << ptrs.size() << "+ regions: "
+              << allocator.page_map_overhead() << " bytes" << std::endl;
+    assert(allocator.page_map_overhead() >= 3 * 32 * 1024);
+    
+    std::cout << "O(1) owns() test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== PageMap Tests ===" << std::endl;
+    
+    try {
+        test_page_map_set_lookup_clear();
+        test_allocator_owns_with_many_regions();
+        
+        std::cout << "\n✓ All PageMap tests passed!" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Test failed with unknown exception" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,222 @@
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include "axontzz/scavenger.h"
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace memplumber;
+
+// 声明全局API
+namespace memplumber {
+    namespace global {
+        std::size_t global_allocator_idle_bytes();
+        std::size_t trim_global_allocator(std::size_t retain);
+    }
+}
+
+void test_decommit_large_free_blocks() {
+    std::cout << "Testing decommit of large free blocks..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 4 * 1024 * 1024, 0); // 关闭大对象路径
+    
+    // 写满若干块，全部释放后合并成一个大块，中间的整页被退还
+    std::vector<void*> ptrs;
+    for (int i = 0; i < 8; ++i) {
+        void* ptr = allocator.allocate(256 * 1024);
+        assert(ptr != nullptr);
+        std::memset(ptr, 0x5A, 256 * 1024);
+        ptrs.push_back(ptr);
+    }
+    assert(allocator.memory_usage().decommitted == 0);
+    for (void* ptr : ptrs) {
+        allocator.deallocate(ptr);
+    }
+    
+    auto usage = allocator.memory_usage();
+    std::cout << "Reserved: " << usage.reserved << " bytes, committed: " << usage.committed
+              << " bytes" << std::endl;
+    assert(usage.decommitted > 3 * 1024 * 1024);
+    assert(usage.committed + usage.decommitted == usage.reserved);
+    assert(memory_source.get_stats().current_decommitted == usage.decommitted);
+    assert(memory_source.get_stats().committed() < memory_source.get_stats().current_usage);
+    assert(allocator.validate_free_list());
+    
+    // 再次使用该块：重新计为已提交，页面可正常读写
+    char* again = static_cast<char*>(allocator.allocate(512 * 1024));
+    assert(again != nullptr);
+    assert(allocator.memory_usage().decommitted == 0);
+    std::memset(again, 0x11, 512 * 1024);
+    assert(allocator.validate_free_list());
+    allocator.deallocate(again);
+    
+    // 阈值为 0 时不主动退还
+    allocator.set_decommit_threshold(0);
+    void* ptr = allocator.allocate(256 * 1024);
+    allocator.deallocate(ptr);
+    assert(allocator.memory_usage().decommitted == 0);
+    assert(allocator.validate_free_list());
+    
+    std::cout << "Decommit test passed!" << std::endl;
+}
+
+void test_trim_releases_regions() {
+    std::cout << "Testing trim of empty regions and cached spans..." << std::endl;
+    
+    MemorySource memory_source;
+    {
+        FreeListAllocator allocator(memory_source, 64 * 1024, 128 * 1024, 4);
+        allocator.set_decommit_threshold(0);
+        
+        // 每次分配占用一个新区域
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 16; ++i) {
+            ptrs.push_back(allocator.allocate(48 * 1024));
+        }
+        void* big = allocator.allocate(1024 * 1024);
+        allocator.deallocate(big);
+        assert(allocator.cached_span_count() == 1);
+        
+        // 保留一个存活分配，其余全部释放
+        for (size_t i = 1; i < ptrs.size(); ++i) {
+            allocator.deallocate(ptrs[i]);
+        }
+        const size_t reserved_before = allocator.memory_usage().reserved;
+        const size_t idle_before = allocator.idle_bytes();
+        std::cout << "Idle before trim: " << idle_before << " bytes" << std::endl;
+        
+        // 部分回收：最多保留 256 KiB 空闲
+        size_t released = allocator.trim(256 * 1024);
+        assert(released > 0);
+        assert(allocator.idle_bytes() <= 256 * 1024);
+        assert(allocator.cached_span_count() == 0);
+        assert(allocator.validate_free_list());
+        
+        // 完全回收：只剩存活分配所在的区域
+        allocator.trim(0);
+        assert(allocator.idle_bytes() == 0);
+        assert(allocator.memory_usage().reserved < reserved_before);
+        assert(allocator.memory_usage().committed + allocator.memory_usage().decommitted ==
+               allocator.memory_usage().reserved);
+        assert(allocator.owns(ptrs[0]));
+        assert(!allocator.owns(ptrs[1]));
+        assert(allocator.validate_free_list());
+        std::cout << "Reserved after trim: " << allocator.memory_usage().reserved << " bytes" << std::endl;
+        
+        // 回收后仍可正常分配
+        allocator.deallocate(ptrs[0]);
+        allocator.trim(0);
+        assert(allocator.memory_usage().reserved == 0);
+        assert(memory_source.get_stats().current_usage == allocator.page_map_overhead());
+        void* fresh = allocator.allocate(1000);
+        assert(fresh != nullptr);
+        assert(allocator.validate_free_list());
+        allocator.deallocate(fresh);
+    }
+    assert(memory_source.get_stats().current_usage == 0);
+    assert(memory_source.get_stats().current_decommitted == 0);
+    
+    std::cout << "Trim test passed!" << std::endl;
+}
+
+void test_background_scavenger() {
+    std::cout << "Testing background scavenger..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator heap(memory_source, 64 * 1024, 0);
+    std::mutex heap_mutex;
+    
+    Scavenger::Policy policy;
+    policy.interval = std::chrono::milliseconds(10);
+    policy.idle_threshold = 128 * 1024;
+    policy.retain = 0;
+    Scavenger scavenger(
+        [&] { std::lock_guard<std::mutex> lock(heap_mutex); return heap.idle_bytes(); },
+        [&](size_t retain) { std::lock_guard<std::mutex> lock(heap_mutex); return heap.trim(retain); },
+        policy);
+    
+    // 空闲内存低于阈值时不回收
+    scavenger.wake();
+    while (scavenger.passes() == 0) {
+        std::this_thread::yield();
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(heap_mutex);
+        std::vector<void*> ptrs;
+        for (int i = 0; i < 8; ++i) {
+            ptrs.push_back(heap.allocate(60 * 1024));
+        }
+        for (void* ptr : ptrs) {
+            heap.deallocate(ptr);
+        }
+        assert(heap.idle_bytes() > policy.idle_threshold);
+    }
+    
+    // 等待后台线程完成一次回收
+    for (int i = 0; i < 500 && scavenger.trims() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    assert(scavenger.trims() >= 1);
+    assert(scavenger.released_bytes() > 0);
+    scavenger.stop();
+    
+    {
+        std::lock_guard<std::mutex> lock(heap_mutex);
+        assert(heap.idle_bytes() == 0);
+        assert(heap.validate_free_list());
+    }
+    std::cout << "Scavenger released " << scavenger.released_bytes() << " bytes in "
+              << scavenger.trims() << " trim(s)" << std::endl;
+    
+    std::cout << "Background scavenger test passed!" << std::endl;
+}
+
+void test_global_trim() {
+    std::cout << "Testing trim of the global allocator..." << std::endl;
+    
+    std::vector<std::vector<char>*> buffers;
+    for (int i = 0; i < 64; ++i) {
+        buffers.push_back(new std::vector<char>(32 * 1024, 'x'));
+    }
+    for (auto* buffer : buffers) {
+        delete buffer;
+    }
+    
+    size_t idle = memplumber::global::global_allocator_idle_bytes();
+    size_t released = memplumber::global::trim_global_allocator(0);
+    std::cout << "Global idle: " << idle << " bytes, released: " << released << " bytes" << std::endl;
+    assert(memplumber::global::global_allocator_idle_bytes() == 0);
+    
+    // 回收后 new/delete 照常工作
+    std::vector<int> numbers(10000, 7);
+    assert(numbers[9999] == 7);
+    
+    std::cout << "Global trim test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Scavenger Tests ===" << std::endl;
+    
+    try {
+        test_decommit_large_free_blocks();
+        test_trim_releases_regions();
+        test_background_scavenger();
+        test_global_trim();
+        
+        std::cout << "\n✓ All scavenger tests passed!" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Test failed with unknown exception" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
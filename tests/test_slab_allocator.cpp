@@ -0,0 +1,290 @@
+#include "axontzz/slab_allocator.h"
+#include "axontzz/memory_source.h"
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace memplumber;
+
+void test_slab_geometry() {
+    std::cout << "Testing SlabAllocator geometry..." << std::endl;
+    
+    MemorySource memory_source;
+    SlabAllocator allocator(memory_source, 48, 16 * 1024);
+    
+    assert(std::strcmp(allocator.get_name(), "SlabAllocator") == 0);
+    assert(allocator.object_size() == 48);
+    assert(allocator.slot_size() == 48);
+    assert(allocator.slot_alignment() == 16);
+    assert(allocator.slab_size() == 16 * 1024);
+    assert(allocator.objects_per_slab() > 300);
+    
+    // 大对象会自动放大板块，保证每个板块能容纳多个对象
+    SlabAllocator big(memory_source, 10000, 4096);
+    assert(big.slab_size() >= 8 * 10000);
+    assert((big.slab_size() & (big.slab_size() - 1)) == 0);
+    
+    std::cout << "Slab geometry test passed!" << std::endl;
+}
+
+void test_slab_allocate_and_reuse() {
+    std::cout << "Testing slab allocation and reuse..." << std::endl;
+    
+    MemorySource memory_source;
+    SlabAllocator allocator(memory_source, 64, 4096);
+    
+    void* a = allocator.allocate(64);
+    void* b = allocator.allocate(40);
+    assert(a != nullptr && b != nullptr && a != b);
+    assert(reinterpret_cast<uintptr_t>(a) % 64 == 0);
+    assert(allocator.owns(a) && allocator.owns(b));
+    assert(!allocator.owns(nullptr));
+    int local = 0;
+    assert(!allocator.owns(&local));
+    
+    std::memset(a, 0xAB, 64);
+    std::memset(b, 0xCD, 64);
+    
+    // 释放后立即复用同一个槽位（LIFO）
+    allocator.deallocate(a, 64);
+    void* c = allocator.allocate(64);
+    assert(c == a);
+    
+    // 超出对象大小或对齐要求的请求失败
+    assert(allocator.allocate(65) == nullptr);
+    assert(allocator.allocate(8, 128) == nullptr);
+    assert(allocator.allocate(0) == nullptr);
+    
+    auto stats = allocator.get_stats();
+    assert(stats.allocation_count == 3);
+    assert(stats.deallocation_count == 1);
+    assert(stats.failed_allocations == 2);
+    assert(stats.current_usage == 2 * 64);
+    
+    allocator.deallocate(b);
+    allocator.deallocate(c);
+    assert(allocator.get_stats().current_usage == 0);
+    
+    // 释放其他分配器的对象：被忽略，两边的统计都不变
+    SlabAllocator other(memory_source, 64, 4096, 1);
+    void* foreign = other.allocate(64);
+    assert(foreign != nullptr && !allocator.owns(foreign));
+    const size_t deallocations = allocator.get_stats().deallocation_count;
+    allocator.deallocate(foreign, 64);
+    allocator.deallocate(&local, sizeof(local));
+    assert(allocator.get_stats().deallocation_count == deallocations);
+    assert(other.get_stats().current_usage == 64);
+    other.deallocate(foreign);
+    assert(other.get_stats().current_usage == 0);
+    
+    std::cout << "Slab allocation and reuse test passed!" << std::endl;
+}
+
+void test_slab_reallocate() {
+    std::cout << "Testing slab reallocate..." << std::endl;
+    
+    MemorySource memory_source;
+    SlabAllocator allocator(memory_source, 64, 4096);
+    
+    void* ptr = allocator.allocate(40);
+    std::memset(ptr, 0xCD, 40);
+    
+    // 默认 reallocate：在对象大小以内分配新槽位并复制，超出则失败且原对象不变
+    void* moved = allocator.reallocate(ptr, 40, 60);
+    assert(moved != nullptr && moved != ptr && static_cast<unsigned char*>(moved)[39] == 0xCD);
+    assert(allocator.reallocate(moved, 60, 100) == nullptr);
+    assert(static_cast<unsigned char*>(moved)[0] == 0xCD);
+    assert(allocator.get_stats().current_usage == 64);
+    
+    allocator.deallocate(moved);
+    assert(allocator.get_stats().current_usage == 0);
+    
+    std::cout << "Slab reallocate test passed!" << std::endl;
+}
+
+void test_slab_lists() {
+    std::cout << "Testing partial/full/empty slab lists..." << std::endl;
+    
+    MemorySource memory_source;
+    SlabAllocator allocator(memory_source, 128, 4096, 1);
+    const size_t per_slab = allocator.objects_per_slab();
+    
+    // 填满两个板块，再在第三个板块中分配一个对象
+    std::vector<void*> objects;
+    for (size_t i = 0; i < per_slab * 2 + 1; ++i) {
+        void* ptr = allocator.allocate(128);
+        assert(ptr != nullptr);
+        std::memset(ptr, static_cast<int>(i & 0xFF), 128);
+        objects.push_back(ptr);
+    }
+    assert(allocator.full_slab_count() == 2);
+    assert(allocator.partial_slab_count() == 1);
+    assert(allocator.empty_slab_count() == 0);
+    
+    // 数据互不覆盖
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(objects[i]);
+        assert(bytes[0] == (i & 0xFF) && bytes[127] == (i & 0xFF));
+    }
+    
+    // 从满板块释放一个对象 -> 变为部分占用
+    allocator.deallocate(objects[0]);
+    assert(allocator.full_slab_count() == 1);
+    assert(allocator.partial_slab_count() == 2);
+    
+    // 释放所有对象：只缓存 1 个空板块，其余归还给OS
+    size_t unmapped_before = memory_source.get_stats().deallocation_count;
+    for (size_t i = 1; i < objects.size(); ++i) {
+        allocator.deallocate(objects[i]);
+    }
+    assert(allocator.full_slab_count() == 0);
+    assert(allocator.partial_slab_count() == 0);
+    assert(allocator.empty_slab_count() == 1);
+    assert(memory_source.get_stats().deallocation_count == unmapped_before + 2);
+    
+    // 缓存的空板块会被优先复用，不再向OS申请
+    size_t mapped_before = memory_source.get_stats().allocation_count;
+    void* again = allocator.allocate(100);
+    assert(again != nullptr);
+    assert(memory_source.get_stats().allocation_count == mapped_before);
+    allocator.deallocate(again);
+    
+    allocator.release_empty_slabs();
+    assert(allocator.empty_slab_count() == 0);
+    assert(!allocator.owns(again));
+    
+    // 只剩页映射节点仍占用内存
+    assert(memory_source.get_stats().current_usage == allocator.page_map_overhead());
+    
+    std::cout << "Slab list test passed!" << std::endl;
+}
+
+void test_aligned_block_source() {
+    std::cout << "Testing aligned blocks from MemorySource..." << std::endl;
+    
+    MemorySource memory_source;
+    const size_t alignment = 256 * 1024;
+    void* ptr = memory_source.allocate_aligned_block(64 * 1024, alignment);
+    assert(ptr != nullptr);
+    assert(reinterpret_cast<uintptr_t>(ptr) % alignment == 0);
+    assert(memory_source.get_stats().current_usage == 64 * 1024);
+    std::memset(ptr, 0x5A, 64 * 1024);
+    memory_source.deallocate_block(ptr, 64 * 1024);
+    assert(memory_source.get_stats().current_usage == 0);
+    
+    std::cout << "Aligned block test passed!" << std::endl;
+}
+
+void test_remote_frees() {
+    std::cout << "Testing cross-thread frees through the remote-free queue..." << std::endl;
+    
+    MemorySource memory_source;
+    SlabAllocator allocator(memory_source, 64, 4096, 4);
+    assert(allocator.owner_thread() == std::this_thread::get_id());
+    const size_t per_slab = allocator.objects_per_slab();
+    
+    // 另一个线程释放：只进入队列，板块状态与统计都不变
+    std::vector<void*> objects;
+    for (size_t i = 0; i < per_slab * 2; ++i) {
+        objects.push_back(allocator.allocate(64));
+    }
+    assert(allocator.full_slab_count() == 2);
+    std::thread consumer([&] {
+        for (void* ptr : objects) {
+            allocator.deallocate(ptr, 64);
+        }
+    });
+    consumer.join();
+    assert(allocator.has_remote_frees());
+    assert(allocator.full_slab_count() == 2 && allocator.remote_free_count() == 0);
+    assert(allocator.get_stats().deallocation_count == 0);
+    
+    // 所有者的下一次分配批量归还整个队列，并复用刚释放的槽位
+    void* reused = allocator.allocate(64);
+    assert(!allocator.has_remote_frees() && allocator.remote_free_count() == per_slab * 2);
+    assert(allocator.get_stats().deallocation_count == per_slab * 2);
+    assert(allocator.full_slab_count() == 0 && allocator.partial_slab_count() == 1);
+    bool found = false;
+    for (void* ptr : objects) {
+        found = found || ptr == reused;
+    }
+    assert(found);
+    allocator.deallocate(reused);
+    
+    // 多个线程并发释放，所有者同时继续分配与释放自己的对象
+    const size_t kThreads = 4;
+    const size_t kPerThread = 2000;
+    std::vector<void*> shared;
+    for (size_t i = 0; i < kThreads * kPerThread; ++i) {
+        void* ptr = allocator.allocate(64);
+        std::memset(ptr, 0x3c, 64);
+        shared.push_back(ptr);
+    }
+    std::vector<std::thread> freers;
+    for (size_t t = 0; t < kThreads; ++t) {
+        freers.emplace_back([&, t] {
+            for (size_t i = t * kPerThread; i < (t + 1) * kPerThread; ++i) {
+                allocator.deallocate(shared[i], 64);
+            }
+        });
+    }
+    std::vector<void*> own;
+    for (int round = 0; round < 2000; ++round) {
+        own.push_back(allocator.allocate(64));
+        if (round % 3 == 0) {
+            allocator.deallocate(own.back());
+            own.pop_back();
+        }
+    }
+    for (std::thread& thread : freers) {
+        thread.join();
+    }
+    allocator.drain_remote_frees();
+    for (void* ptr : own) {
+        allocator.deallocate(ptr);
+    }
+    assert(allocator.remote_free_count() == per_slab * 2 + kThreads * kPerThread);
+    assert(allocator.full_slab_count() == 0 && allocator.partial_slab_count() == 0);
+    auto stats = allocator.get_stats();
+    assert(stats.allocation_count == stats.deallocation_count);
+    
+    // 交给另一个线程：它成为所有者，原线程的释放改走队列
+    void* handed = nullptr;
+    std::thread owner([&] {
+        allocator.set_owner_thread();
+        handed = allocator.allocate(64);
+    });
+    owner.join();
+    allocator.deallocate(handed);
+    assert(allocator.has_remote_frees());
+    allocator.set_owner_thread();
+    assert(allocator.drain_remote_frees() == 1);
+    
+    std::cout << "Remote free test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== SlabAllocator Tests ===" << std::endl;
+    
+    try {
+        test_slab_geometry();
+        test_slab_allocate_and_reuse();
+        test_slab_reallocate();
+        test_slab_lists();
+        test_aligned_block_source();
+        test_remote_frees();
+        
+        std::cout << "\n✓ All SlabAllocator tests passed!" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Test failed with unknown exception" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include "axontzz/trace.h"
+#include "axontzz/free_list_allocator.h"
+#include "axontzz/memory_source.h"
+#include <iostream>
+#include <cassert>
+#include <unistd.h>
+
+using namespace memplumber;
+
+void test_ring_record_and_snapshot() {
+    std::cout << "Testing trace ring record/snapshot..." << std::endl;
+    
+    trace::clear_ring();
+    trace::record(trace::EventType::Allocate, 0x1000, 64, 8);
+    trace::record(trace::EventType::Deallocate, 0x1000, 64, 96);
+    
+    static trace::Event events[trace::RING_CAPACITY];
+    size_t count = trace::snapshot(events, trace::RING_CAPACITY);
+    assert(count == 2);
+    assert(trace::recorded_events() == 2);
+    assert(events[0].type == trace::EventType::Allocate);
+    assert(events[0].args[0] == 0x1000 && events[0].args[1] == 64 && events[0].args[2] == 8);
+    assert(events[1].type == trace::EventType::Deallocate);
+    assert(events[1].sequence == events[0].sequence + 1);
+    assert(events[1].timestamp_ns >= events[0].timestamp_ns);
+    assert(events[0].thread != 0 && events[0].thread == events[1].thread);
+    
+    // 只取最新的一个事件
+    count = trace::snapshot(events, 1);
+    assert(count == 1);
+    assert(events[0].type == trace::EventType::Deallocate);
+    
+    std::cout << "Trace ring record/snapshot test passed!" << std::endl;
+}
+
+void test_ring_wraparound() {
+    std::cout << "Testing trace ring wraparound..." << std::endl;
+    
+    trace::clear_ring();
+    const size_t total = trace::RING_CAPACITY + 100;
+    for (size_t i = 0; i < total; ++i) {
+        trace::record(trace::EventType::ExpandHeap, i, 0, 0);
+    }
+    
+    static trace::Event events[trace::RING_CAPACITY];
+    size_t count = trace::snapshot(events, trace::RING_CAPACITY);
+    assert(count == trace::RING_CAPACITY);
+    assert(trace::recorded_events() == total);
+    
+    // 环形缓冲区只保留最新的 RING_CAPACITY 个事件，按时间顺序排列
+    assert(events[0].args[0] == 100);
+    assert(events[count - 1].args[0] == total - 1);
+    for (size_t i = 1; i < count; ++i) {
+        assert(events[i].sequence == events[i - 1].sequence + 1);
+    }
+    
+    trace::clear_ring();
+    assert(trace::snapshot(events, trace::RING_CAPACITY) == 0);
+    
+    std::cout << "Trace ring wraparound test passed!" << std::endl;
+}
+
+void test_allocator_events() {
+    std::cout << "Testing allocator trace events (ring "
+              << (MEMPLUMBER_TRACE_RING ? "enabled" : "disabled") << ")..." << std::endl;
+    
+    MemorySource memory_source;
+    FreeListAllocator allocator(memory_source, 4096);
+    
+    trace::clear_ring();
+    void* ptr = allocator.allocate(128);
+    assert(ptr != nullptr);
+    allocator.deallocate(ptr, 128);
+    
+    static trace::Event events[trace::RING_CAPACITY];
+    size_t count = trace::snapshot(events, trace::RING_CAPACITY);
+    if (MEMPLUMBER_TRACE_RING) {
+        // 分配与释放都应以二进制事件记录
+        bool saw_allocate = false;
+        bool saw_deallocate = false;
+        for (size_t i = 0; i < count; ++i) {
+            if (events[i].type == trace::EventType::Allocate &&
+                events[i].args[0] == reinterpret_cast<uintptr_t>(ptr)) {
+                saw_allocate = true;
+                assert(events[i].args[1] == 128);
+            }
+            if (events[i].type == trace::EventType::Deallocate &&
+                events[i].args[0] == reinterpret_cast<uintptr_t>(ptr)) {
+                saw_deallocate = true;
+            }
+        }
+        assert(saw_allocate && saw_deallocate);
+        trace::dump_ring(STDOUT_FILENO);
+    } else {
+        // 关闭时分配器不记录任何事件
+        assert(count == 0);
+    }
+    
+    std::cout << "Allocator trace events test passed!" << std::endl;
+}
+
+int main() {
+    std::cout << "=== Trace Tests ===" << std::endl;
+    
+    try {
+        test_ring_record_and_snapshot();
+        test_ring_wraparound();
+        test_allocator_events();
+        
+        std::cout << "\n✓ All trace tests passed!" << std::endl;
+        
+    } catch (const std::exception& e) {
+        std::cerr << "Test failed with exception: " << e.what() << std::endl;
+        return 1;
+    } catch (...) {
+        std::cerr << "Test failed with unknown exception" << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}